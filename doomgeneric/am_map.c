@@ -192,80 +192,78 @@ mline_t thintriangle_guy[] = {
 
 
 
-static int 	cheating = 0;
-static int 	grid = 0;
+static DG_STATE int 	cheating = 0;
+static DG_STATE int 	grid = 0;
 
 static int 	leveljuststarted = 1; 	// kluge until AM_LevelInit() is called
 
-boolean    	automapactive = false;
-static int 	finit_width = SCREENWIDTH;
-static int 	finit_height = SCREENHEIGHT - 32;
+DG_STATE boolean    	automapactive = false;
 
 // location of window on screen
-static int 	f_x;
-static int	f_y;
+static DG_STATE int 	f_x;
+static DG_STATE int	f_y;
 
 // size of window on screen
-static int 	f_w;
-static int	f_h;
+static DG_STATE int 	f_w;
+static DG_STATE int	f_h;
 
-static int 	lightlev; 		// used for funky strobing effect
-static byte*	fb; 			// pseudo-frame buffer
-static int 	amclock;
+static DG_STATE int 	lightlev; 		// used for funky strobing effect
+static DG_STATE byte*	fb; 			// pseudo-frame buffer
+static DG_STATE int 	amclock;
 
-static mpoint_t m_paninc; // how far the window pans each tic (map coords)
-static fixed_t 	mtof_zoommul; // how far the window zooms in each tic (map coords)
-static fixed_t 	ftom_zoommul; // how far the window zooms in each tic (fb coords)
+static DG_STATE mpoint_t m_paninc; // how far the window pans each tic (map coords)
+static DG_STATE fixed_t 	mtof_zoommul; // how far the window zooms in each tic (map coords)
+static DG_STATE fixed_t 	ftom_zoommul; // how far the window zooms in each tic (fb coords)
 
-static fixed_t 	m_x, m_y;   // LL x,y where the window is on the map (map coords)
-static fixed_t 	m_x2, m_y2; // UR x,y where the window is on the map (map coords)
+static DG_STATE fixed_t 	m_x, m_y;   // LL x,y where the window is on the map (map coords)
+static DG_STATE fixed_t 	m_x2, m_y2; // UR x,y where the window is on the map (map coords)
 
 //
 // width/height of window on map (map coords)
 //
-static fixed_t 	m_w;
-static fixed_t	m_h;
+static DG_STATE fixed_t 	m_w;
+static DG_STATE fixed_t	m_h;
 
 // based on level size
-static fixed_t 	min_x;
-static fixed_t	min_y; 
-static fixed_t 	max_x;
-static fixed_t  max_y;
+static DG_STATE fixed_t 	min_x;
+static DG_STATE fixed_t	min_y; 
+static DG_STATE fixed_t 	max_x;
+static DG_STATE fixed_t  max_y;
 
 static fixed_t 	max_w; // max_x-min_x,
-static fixed_t  max_h; // max_y-min_y
+static DG_STATE fixed_t  max_h; // max_y-min_y
 
 // based on player size
 static fixed_t 	min_w;
 static fixed_t  min_h;
 
 
-static fixed_t 	min_scale_mtof; // used to tell when to stop zooming out
-static fixed_t 	max_scale_mtof; // used to tell when to stop zooming in
+static DG_STATE fixed_t 	min_scale_mtof; // used to tell when to stop zooming out
+static DG_STATE fixed_t 	max_scale_mtof; // used to tell when to stop zooming in
 
 // old stuff for recovery later
-static fixed_t old_m_w, old_m_h;
-static fixed_t old_m_x, old_m_y;
+static DG_STATE fixed_t old_m_w, old_m_h;
+static DG_STATE fixed_t old_m_x, old_m_y;
 
 // old location used by the Follower routine
-static mpoint_t f_oldloc;
+static DG_STATE mpoint_t f_oldloc;
 
 // used by MTOF to scale from map-to-frame-buffer coords
-static fixed_t scale_mtof = (fixed_t)INITSCALEMTOF;
+static DG_STATE fixed_t scale_mtof = (fixed_t)INITSCALEMTOF;
 // used by FTOM to scale from frame-buffer-to-map coords (=1/scale_mtof)
-static fixed_t scale_ftom;
+static DG_STATE fixed_t scale_ftom;
 
-static player_t *plr; // the player represented by an arrow
+static DG_STATE player_t *plr; // the player represented by an arrow
 
-static patch_t *marknums[10]; // numbers used for marking by the automap
-static mpoint_t markpoints[AM_NUMMARKPOINTS]; // where the points are
-static int markpointnum = 0; // next point to be assigned
+static DG_STATE patch_t *marknums[10]; // numbers used for marking by the automap
+static DG_STATE mpoint_t markpoints[AM_NUMMARKPOINTS]; // where the points are
+static DG_STATE int markpointnum = 0; // next point to be assigned
 
-static int followplayer = 1; // specifies whether to follow the player around
+static DG_STATE int followplayer = 1; // specifies whether to follow the player around
 
-cheatseq_t cheat_amap = CHEAT("iddt", 0);
+DG_STATE cheatseq_t cheat_amap = CHEAT("iddt", 0);
 
-static boolean stopped = true;
+static DG_STATE boolean stopped = true;
 
 // Calculates the slope and slope according to the x-axis of a line
 // segment in map coordinates (with the upright y-axis n' all) so
@@ -424,7 +422,7 @@ void AM_changeWindowLoc(void)
 void AM_initVariables(void)
 {
     int pnum;
-    static event_t st_notify = { ev_keyup, AM_MSGENTERED, 0, 0 };
+    static DG_STATE event_t st_notify = { ev_keyup, AM_MSGENTERED, 0, 0 };
 
     automapactive = true;
     fb = I_VideoBuffer;
@@ -520,8 +518,8 @@ void AM_LevelInit(void)
     leveljuststarted = 0;
 
     f_x = f_y = 0;
-    f_w = finit_width;
-    f_h = finit_height;
+    f_w = SCREENWIDTH;
+    f_h = SCREENHEIGHT - SBARHEIGHT;
 
     AM_clearMarks();
 
@@ -540,7 +538,7 @@ void AM_LevelInit(void)
 //
 void AM_Stop (void)
 {
-    static event_t st_notify = { 0, ev_keyup, AM_MSGEXITED, 0 };
+    static DG_STATE event_t st_notify = { 0, ev_keyup, AM_MSGEXITED, 0 };
 
     AM_unloadPics();
     automapactive = false;
@@ -553,7 +551,7 @@ void AM_Stop (void)
 //
 void AM_Start (void)
 {
-    static int lastlevel = -1, lastepisode = -1;
+    static DG_STATE int lastlevel = -1, lastepisode = -1;
 
     if (!stopped) AM_Stop();
     stopped = false;
@@ -597,8 +595,8 @@ AM_Responder
 {
 
     int rc;
-    static int bigstate=0;
-    static char buffer[20];
+    static DG_STATE int bigstate=0;
+    static DG_STATE char buffer[20];
     int key;
 
     rc = false;
@@ -784,10 +782,10 @@ void AM_doFollowPlayer(void)
 //
 void AM_updateLightLev(void)
 {
-    static int nexttic = 0;
+    static DG_STATE int nexttic = 0;
     //static int litelevels[] = { 0, 3, 5, 6, 6, 7, 7, 7 };
     static int litelevels[] = { 0, 4, 7, 10, 12, 14, 15, 15 };
-    static int litelevelscnt = 0;
+    static DG_STATE int litelevelscnt = 0;
    
     // Change light level
     if (amclock>nexttic)
@@ -995,7 +993,7 @@ AM_drawFline
     register int ay;
     register int d;
     
-    static int fuck = 0;
+    static DG_STATE int fuck = 0;
 
     // For debugging only
     if (      fl->a.x < 0 || fl->a.x >= f_w
@@ -1063,7 +1061,7 @@ AM_drawMline
 ( mline_t*	ml,
   int		color )
 {
-    static fline_t fl;
+    static DG_STATE fline_t fl;
 
     if (AM_clipMline(ml, &fl))
 	AM_drawFline(&fl, color); // draws it on frame buffer using fb coords
@@ -1123,7 +1121,7 @@ void AM_drawGrid(int color)
 void AM_drawWalls(void)
 {
     int i;
-    static mline_t l;
+    static DG_STATE mline_t l;
 
     for (i=0;i<numlines;i++)
     {
@@ -1320,9 +1318,10 @@ void AM_drawMarks(void)
 	    //      h = SHORT(marknums[i]->height);
 	    w = 5; // because something's wrong with the wad, i guess
 	    h = 6; // because something's wrong with the wad, i guess
-	    fx = CXMTOF(markpoints[i].x);
-	    fy = CYMTOF(markpoints[i].y);
-	    if (fx >= f_x && fx <= f_w - w && fy >= f_y && fy <= f_h - h)
+	    fx = V_OrigX(CXMTOF(markpoints[i].x));
+	    fy = V_OrigY(CYMTOF(markpoints[i].y));
+	    if (fx >= V_OrigX(f_x) && fx <= V_OrigX(f_w) - w
+	     && fy >= V_OrigY(f_y) && fy <= V_OrigY(f_h) - h)
 		V_DrawPatch(fx, fy, marknums[i]);
 	}
     }
@@ -43,7 +43,7 @@ void AM_Drawer (void);
 void AM_Stop (void);
 
 
-extern cheatseq_t cheat_amap;
+extern DG_STATE cheatseq_t cheat_amap;
 
 
 #endif
@@ -24,9 +24,9 @@
 
 #define MAXEVENTS 64
 
-static event_t events[MAXEVENTS];
-static int eventhead;
-static int eventtail;
+static DG_STATE event_t events[MAXEVENTS];
+static DG_STATE int eventhead;
+static DG_STATE int eventtail;
 
 //
 // D_PostEvent
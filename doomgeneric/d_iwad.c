@@ -58,8 +58,8 @@ static const iwad_t iwads[] =
 #define MAX_IWAD_DIRS 128
 
 static boolean iwad_dirs_built = false;
-static char *iwad_dirs[MAX_IWAD_DIRS];
-static int num_iwad_dirs = 0;
+static DG_STATE char *iwad_dirs[MAX_IWAD_DIRS];
+static DG_STATE int num_iwad_dirs = 0;
 
 static void AddIWADDir(char *dir)
 {
@@ -57,24 +57,24 @@ typedef struct
 // from all players.
 //
 
-static ticcmd_set_t ticdata[BACKUPTICS];
+static DG_STATE ticcmd_set_t ticdata[BACKUPTICS];
 
 // The index of the next tic to be made (with a call to BuildTiccmd).
 
-static int maketic;
+static DG_STATE int maketic;
 
 // The number of complete tics received from the server so far.
 
-static int recvtic;
+static DG_STATE int recvtic;
 
 // The number of tics that have been run (using RunTic) so far.
 
-int gametic;
+DG_STATE int gametic;
 
 // When set to true, a single tic is run each time TryRunTics() is called.
 // This is used for -timedemo mode.
 
-boolean singletics = false;
+DG_STATE boolean singletics = false;
 
 // Index of the local player.
 
@@ -82,36 +82,36 @@ static int localplayer;
 
 // Used for original sync code.
 
-static int      skiptics = 0;
+static DG_STATE int      skiptics = 0;
 
 // Reduce the bandwidth needed by sampling game input less and transmitting
 // less.  If ticdup is 2, sample half normal, 3 = one third normal, etc.
 
-int		ticdup;
+DG_STATE int		ticdup;
 
 // Amount to offset the timer for game sync.
 
-fixed_t         offsetms;
+DG_STATE fixed_t         offsetms;
 
 // Use new client syncronisation code
 
-static boolean  new_sync = true;
+static DG_STATE boolean  new_sync = true;
 
 // Callback functions for loop code.
 
-static loop_interface_t *loop_interface = NULL;
+static DG_STATE loop_interface_t *loop_interface = NULL;
 
 // Current players in the multiplayer game.
 // This is distinct from playeringame[] used by the game code, which may
 // modify playeringame[] when playing back multiplayer demos.
 
-static boolean local_playeringame[NET_MAXPLAYERS];
+static DG_STATE boolean local_playeringame[NET_MAXPLAYERS];
 
 // Requested player class "sent" to the server on connect.
 // If we are only doing a single player game then this needs to be remembered
 // and saved in the game settings.
 
-static int player_class;
+static DG_STATE int player_class;
 
 
 // 35 fps clock adjusted by offsetms milliseconds
@@ -198,7 +198,7 @@ static boolean BuildNewTic(void)
 // Builds ticcmds for console player,
 // sends out a packet
 //
-int      lasttime;
+DG_STATE int      lasttime;
 
 void NetUpdate (void)
 {
@@ -584,9 +584,9 @@ static int GetLowTic(void)
     return lowtic;
 }
 
-static int frameon;
-static int frameskip[4];
-static int oldnettics;
+static DG_STATE int frameon;
+static DG_STATE int frameskip[4];
+static DG_STATE int oldnettics;
 
 static void OldNetSync(void)
 {
@@ -708,7 +708,7 @@ void TryRunTics (void)
     int	i;
     int	lowtic;
     int	entertic;
-    static int oldentertics;
+    static DG_STATE int oldentertics;
     int realtics;
     int	availabletics;
     int	counts;
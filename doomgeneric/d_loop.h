@@ -74,8 +74,8 @@ boolean D_InitNetGame(net_connect_data_t *connect_data);
 void D_StartNetGame(net_gamesettings_t *settings,
                     netgame_startup_callback_t callback);
 
-extern boolean singletics;
-extern int gametic, ticdup;
+extern DG_STATE boolean singletics;
+extern DG_STATE int gametic, ticdup;
 
 #endif
 
@@ -46,10 +46,12 @@
 #include "f_wipe.h"
 
 #include "m_argv.h"
+#include "m_bench.h"
 #include "m_config.h"
 #include "m_controls.h"
 #include "m_misc.h"
 #include "m_menu.h"
+#include "m_prof.h"
 #include "p_saveg.h"
 
 #include "i_endoom.h"
@@ -87,45 +89,45 @@ void D_DoomLoop (void);
 
 // Location where savegames are stored
 
-char *          savegamedir;
+DG_STATE char *          savegamedir;
 
 // location of IWAD and WAD files
 
-char *          iwadfile;
+DG_STATE char *          iwadfile;
 
 
-boolean		devparm;	// started game with -devparm
-boolean         nomonsters;	// checkparm of -nomonsters
-boolean         respawnparm;	// checkparm of -respawn
-boolean         fastparm;	// checkparm of -fast
+DG_STATE boolean		devparm;	// started game with -devparm
+DG_STATE boolean         nomonsters;	// checkparm of -nomonsters
+DG_STATE boolean         respawnparm;	// checkparm of -respawn
+DG_STATE boolean         fastparm;	// checkparm of -fast
 
 //extern int soundVolume;
 //extern  int	sfxVolume;
 //extern  int	musicVolume;
 
-extern  boolean	inhelpscreens;
+extern DG_STATE  boolean	inhelpscreens;
 
-skill_t		startskill;
-int             startepisode;
-int		startmap;
-boolean		autostart;
-int             startloadgame;
+DG_STATE skill_t		startskill;
+DG_STATE int             startepisode;
+DG_STATE int		startmap;
+DG_STATE boolean		autostart;
+DG_STATE int             startloadgame;
 
-boolean		advancedemo;
+DG_STATE boolean		advancedemo;
 
 // Store demo, do not accept any inputs
-boolean         storedemo;
+DG_STATE boolean         storedemo;
 
 // "BFG Edition" version of doom2.wad does not include TITLEPIC.
-boolean         bfgedition;
+DG_STATE boolean         bfgedition;
 
 // If true, the main game loop has started.
-boolean         main_loop_started = false;
+DG_STATE boolean         main_loop_started = false;
 
-char		wadfile[1024];		// primary wad file
-char		mapdir[1024];           // directory of development maps
+DG_STATE char		wadfile[1024];		// primary wad file
+DG_STATE char		mapdir[1024];           // directory of development maps
 
-int             show_endoom = 1;
+DG_STATE int             show_endoom = 1;
 
 
 void D_ConnectNetGame(void);
@@ -161,19 +163,19 @@ void D_ProcessEvents (void)
 //
 
 // wipegamestate can be set to -1 to force a wipe on the next draw
-gamestate_t     wipegamestate = GS_DEMOSCREEN;
-extern  boolean setsizeneeded;
-extern  int             showMessages;
+DG_STATE gamestate_t     wipegamestate = GS_DEMOSCREEN;
+extern DG_STATE  boolean setsizeneeded;
+extern DG_STATE  int             showMessages;
 void R_ExecuteSetViewSize (void);
 
 void D_Display (void)
 {
-    static  boolean		viewactivestate = false;
-    static  boolean		menuactivestate = false;
-    static  boolean		inhelpscreensstate = false;
-    static  boolean		fullscreen = false;
-    static  gamestate_t		oldgamestate = -1;
-    static  int			borderdrawcount;
+    static DG_STATE  boolean		viewactivestate = false;
+    static DG_STATE  boolean		menuactivestate = false;
+    static DG_STATE  boolean		inhelpscreensstate = false;
+    static DG_STATE  boolean		fullscreen = false;
+    static DG_STATE  gamestate_t		oldgamestate = -1;
+    static DG_STATE  int			borderdrawcount;
     int				nowtime;
     int				tics;
     int				wipestart;
@@ -215,12 +217,12 @@ void D_Display (void)
 			break;
 		if (automapactive)
 			AM_Drawer ();
-		if (wipe || (viewheight != 200 && fullscreen) )
+		if (wipe || (viewheight != SCREENHEIGHT && fullscreen) )
 			redrawsbar = true;
 		if (inhelpscreensstate && !inhelpscreens)
 			redrawsbar = true;              // just put away the help screen
-		ST_Drawer (viewheight == 200, redrawsbar );
-		fullscreen = viewheight == 200;
+		ST_Drawer (viewheight == SCREENHEIGHT, redrawsbar );
+		fullscreen = viewheight == SCREENHEIGHT;
 		break;
 
       case GS_INTERMISSION:
@@ -241,7 +243,11 @@ void D_Display (void)
     
     // draw the view directly
     if (gamestate == GS_LEVEL && !automapactive && gametic)
+    {
+    	M_BenchBegin (bench_render);
     	R_RenderPlayerView (&players[displayplayer]);
+    	M_BenchEnd (bench_render);
+    }
 
     if (gamestate == GS_LEVEL && gametic)
     	HU_Drawer ();
@@ -258,7 +264,7 @@ void D_Display (void)
     }
 
     // see if the border needs to be updated to the screen
-    if (gamestate == GS_LEVEL && !automapactive && scaledviewwidth != 320)
+    if (gamestate == GS_LEVEL && !automapactive && scaledviewwidth != SCREENWIDTH)
     {
 		if (menuactive || menuactivestate || !viewactivestate)
 			borderdrawcount = 3;
@@ -287,8 +293,8 @@ void D_Display (void)
 		if (automapactive)
 			y = 4;
 		else
-			y = viewwindowy+4;
-		V_DrawPatchDirect(viewwindowx + (scaledviewwidth - 68) / 2, y,
+			y = V_OrigY(viewwindowy)+4;
+		V_DrawPatchDirect(V_OrigX(viewwindowx) + (V_OrigX(scaledviewwidth) - 68) / 2, y,
 							  W_CacheLumpName (DEH_String("M_PAUSE"), PU_CACHE));
     }
 
@@ -301,7 +307,9 @@ void D_Display (void)
     // normal update
     if (!wipe)
     {
+	M_BenchBegin (bench_finishupdate);
 	I_FinishUpdate ();              // page flip or blit buffer
+	M_BenchEnd (bench_finishupdate);
 	return;
     }
     
@@ -324,7 +332,9 @@ void D_Display (void)
 			       , 0, 0, SCREENWIDTH, SCREENHEIGHT, tics);
 	I_UpdateNoBlit ();
 	M_Drawer ();                            // menu is drawn even on top of wipes
+	M_BenchBegin (bench_finishupdate);
 	I_FinishUpdate ();                      // page flip or blit buffer
+	M_BenchEnd (bench_finishupdate);
     } while (!done);
 }
 
@@ -404,6 +414,9 @@ boolean D_GrabMouseCallback(void)
 
 void doomgeneric_Tick()
 {
+    M_BenchBegin (bench_frame);
+    PROF_BEGIN (prof_frame);
+
     // frame syncronous IO operations
     I_StartFrame ();
 
@@ -414,8 +427,13 @@ void doomgeneric_Tick()
     // Update display, next frame, with current state.
     if (screenvisible)
     {
+        M_BenchBegin (bench_display);
         D_Display ();
+        M_BenchEnd (bench_display);
     }
+
+    PROF_END (prof_frame);
+    M_BenchEnd (bench_frame);
 }
 
 //
@@ -463,9 +481,9 @@ void D_DoomLoop (void)
 //
 //  DEMO LOOP
 //
-int             demosequence;
-int             pagetic;
-char                    *pagename;
+DG_STATE int             demosequence;
+DG_STATE int             pagetic;
+DG_STATE char                    *pagename;
 
 
 //
@@ -863,7 +881,7 @@ void D_SetGameDescription(void)
 }
 
 //      print title for every printed line
-char            title[128];
+DG_STATE char            title[128];
 
 static boolean D_AddFile(char *filename)
 {
@@ -1157,6 +1175,41 @@ static void LoadIwadDeh(void)
 }
 #endif
 
+//
+// Load a demo given on the command line.  lumpname receives the name
+// of the lump to play, which must hold at least 9 characters.
+//
+static void D_AddDemoFile(char *name, char *lumpname)
+{
+    char file[256];
+
+    // With Vanilla you have to specify the file without extension,
+    // but make that optional.
+    if (M_StringEndsWith(name, ".lmp"))
+    {
+        M_StringCopy(file, name, sizeof(file));
+    }
+    else
+    {
+        DEH_snprintf(file, sizeof(file), "%s.lmp", name);
+    }
+
+    if (D_AddFile(file))
+    {
+        M_StringCopy(lumpname, lumpinfo[numlumps - 1].name, 9);
+    }
+    else
+    {
+        // If file failed to load, still continue trying to play
+        // the demo in the same way as Vanilla Doom.  This makes
+        // tricks like "-playdemo demo1" possible.
+
+        M_StringCopy(lumpname, name, 9);
+    }
+
+    printf("Playing demo %s.\n", file);
+}
+
 //
 // D_DoomMain
 //
@@ -1175,9 +1228,25 @@ void D_DoomMain (void)
 
     I_PrintBanner(PACKAGE_STRING);
 
+    // The zone is sized for the screen.
+    I_InitScreenSize ();
+
     DEH_printf("Z_Init: Init zone memory allocation daemon. \n");
     Z_Init ();
 
+    //!
+    // @category obscure
+    //
+    // Draw random spans with the SSE2 and the scalar span drawers,
+    // print how many came out differently, and exit.  The exit
+    // status is non-zero if any did.
+    //
+
+    if (M_CheckParm("-spantest") > 0)
+    {
+        exit(R_TestSpans() > 0);
+    }
+
 #ifdef FEATURE_MULTIPLAYER
     //!
     // @category net
@@ -1333,8 +1402,8 @@ void D_DoomMain (void)
     if ( (p=M_CheckParm ("-turbo")) )
     {
 	int     scale = 200;
-	extern int forwardmove[2];
-	extern int sidemove[2];
+	extern DG_STATE int forwardmove[2];
+	extern DG_STATE int sidemove[2];
 	
 	if (p<myargc-1)
 	    scale = atoi (myargv[p+1]);
@@ -1482,32 +1551,30 @@ void D_DoomMain (void)
 
     if (p)
     {
-        // With Vanilla you have to specify the file without extension,
-        // but make that optional.
-        if (M_StringEndsWith(myargv[p + 1], ".lmp"))
-        {
-            M_StringCopy(file, myargv[p + 1], sizeof(file));
-        }
-        else
-        {
-            DEH_snprintf(file, sizeof(file), "%s.lmp", myargv[p+1]);
-        }
+        D_AddDemoFile(myargv[p + 1], demolumpname);
+    }
 
-        if (D_AddFile(file))
-        {
-            M_StringCopy(demolumpname, lumpinfo[numlumps - 1].name,
-                         sizeof(demolumpname));
-        }
-        else
-        {
-            // If file failed to load, still continue trying to play
-            // the demo in the same way as Vanilla Doom.  This makes
-            // tricks like "-playdemo demo1" possible.
+    M_BenchInit();
+    M_ProfInit();
 
-            M_StringCopy(demolumpname, myargv[p + 1], sizeof(demolumpname));
-        }
+    //!
+    // @arg <demo> [<demo> ...]
+    // @category demo
+    //
+    // Benchmark: play back each of the given demos like -timedemo,
+    // -benchreps times each, and write frame timings as JSON to
+    // stdout or to the file given with -benchout.
+    //
 
-        printf("Playing demo %s.\n", file);
+    p = M_CheckParm("-benchmark");
+
+    if (p)
+    {
+        while (++p != myargc && myargv[p][0] != '-')
+        {
+            D_AddDemoFile(myargv[p], demolumpname);
+            M_BenchAddDemo(demolumpname);
+        }
     }
 
     I_AtExit((atexit_func_t) G_CheckDemoStatus, true);
@@ -1826,6 +1893,12 @@ void D_DoomMain (void)
         return;
     }
 
+    if (M_BenchStart())
+    {
+		D_DoomLoop ();
+        return;
+    }
+
     if (startloadgame >= 0)
     {
         M_StringCopy(file, P_SaveGameFile(startloadgame), sizeof(file));
@@ -38,13 +38,13 @@
 
 #include "d_loop.h"
 
-ticcmd_t *netcmds;
+DG_STATE ticcmd_t *netcmds;
 
 // Called when a player leaves the game
 
 static void PlayerQuitGame(player_t *player)
 {
-    static char exitmsg[80];
+    static DG_STATE char exitmsg[80];
     unsigned int player_num;
 
     player_num = player - players;
@@ -70,7 +70,7 @@ static void PlayerQuitGame(player_t *player)
 
 static void RunTic(ticcmd_t *cmds, boolean *ingame)
 {
-    extern boolean advancedemo;
+    extern DG_STATE boolean advancedemo;
     unsigned int i;
 
     // Check for player quits.
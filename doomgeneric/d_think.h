@@ -60,6 +60,9 @@ typedef struct thinker_s
     struct thinker_s*	prev;
     struct thinker_s*	next;
     think_t		function;
+
+    // The pool it came from, see P_AllocThinker.
+    struct thinkerpool_s*	pool;
     
 } thinker_t;
 
@@ -1,10 +1,15 @@
 #include <stdio.h>
 
+#ifdef DOOMGENERIC_MULTI_INSTANCE
+#include <pthread.h>
+#endif
+
 #include "m_argv.h"
+#include "i_system.h"
 
 #include "doomgeneric.h"
 
-pixel_t* DG_ScreenBuffer = NULL;
+DG_STATE pixel_t* DG_ScreenBuffer = NULL;
 
 void M_FindResponseFile(void);
 void D_DoomMain (void);
@@ -25,3 +30,85 @@ void doomgeneric_Create(int argc, char **argv)
 	D_DoomMain ();
 }
 
+
+void doomgeneric_RunFrames(int n)
+{
+	while (n-- > 0)
+	{
+		doomgeneric_Tick();
+	}
+}
+
+#ifdef DOOMGENERIC_MULTI_INSTANCE
+
+struct doomgeneric_context_s
+{
+	pthread_t thread;
+	void *user;
+	pixel_t *screen_buffer;
+};
+
+static DG_STATE doomgeneric_context_t *current_context = NULL;
+
+// Engine startup prints its progress to stdout and creates the config
+// and savegame directories, so instances are brought up one at a time.
+
+static pthread_mutex_t create_lock = PTHREAD_MUTEX_INITIALIZER;
+
+doomgeneric_context_t *doomgeneric_CreateContext(int argc, char **argv,
+                                                 void *user)
+{
+	doomgeneric_context_t *ctx;
+
+	if (current_context != NULL)
+	{
+		I_Error("doomgeneric_CreateContext: thread already owns an instance");
+	}
+
+	ctx = malloc(sizeof(*ctx));
+
+	if (ctx == NULL)
+	{
+		I_Error("doomgeneric_CreateContext: out of memory");
+	}
+
+	ctx->thread = pthread_self();
+	ctx->user = user;
+	current_context = ctx;
+
+	pthread_mutex_lock(&create_lock);
+	doomgeneric_Create(argc, argv);
+	pthread_mutex_unlock(&create_lock);
+
+	ctx->screen_buffer = DG_ScreenBuffer;
+
+	return ctx;
+}
+
+void doomgeneric_TickContext(doomgeneric_context_t *ctx)
+{
+	if (ctx != current_context)
+	{
+		I_Error("doomgeneric_TickContext: instance ticked from a thread "
+		        "that does not own it");
+	}
+
+	doomgeneric_Tick();
+}
+
+doomgeneric_context_t *doomgeneric_CurrentContext(void)
+{
+	return current_context;
+}
+
+void *doomgeneric_GetUserData(doomgeneric_context_t *ctx)
+{
+	return ctx->user;
+}
+
+pixel_t *doomgeneric_GetScreenBuffer(doomgeneric_context_t *ctx)
+{
+	return ctx->screen_buffer;
+}
+
+#endif  // DOOMGENERIC_MULTI_INSTANCE
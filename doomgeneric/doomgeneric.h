@@ -13,6 +13,12 @@
 #endif  // DOOMGENERIC_RESY
 
 
+// DG_STATE, the per-instance storage class.  Platform code that keeps
+// its own per-instance state can use it as well.
+
+#include "doomtype.h"
+
+
 #ifdef CMAP256
 
 typedef uint8_t pixel_t;
@@ -24,7 +30,7 @@ typedef uint32_t pixel_t;
 #endif  // CMAP256
 
 
-extern pixel_t* DG_ScreenBuffer;
+extern DG_STATE pixel_t* DG_ScreenBuffer;
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +39,33 @@ extern "C" {
 void doomgeneric_Create(int argc, char **argv);
 void doomgeneric_Tick();
 
+#ifdef DOOMGENERIC_MULTI_INSTANCE
+
+// Multi-instance build.  All engine state is thread-local, so each
+// thread can host one independent engine instance: create the context
+// on the thread that will run it and only tick it from that thread.
+// Instances live until their thread exits.
+
+typedef struct doomgeneric_context_s doomgeneric_context_t;
+
+doomgeneric_context_t *doomgeneric_CreateContext(int argc, char **argv,
+                                                 void *user);
+void doomgeneric_TickContext(doomgeneric_context_t *ctx);
+
+// Context of the instance owned by the calling thread (NULL if none),
+// so that DG_* callbacks can find their own instance.
+doomgeneric_context_t *doomgeneric_CurrentContext(void);
+
+void *doomgeneric_GetUserData(doomgeneric_context_t *ctx);
+pixel_t *doomgeneric_GetScreenBuffer(doomgeneric_context_t *ctx);
+
+#endif  // DOOMGENERIC_MULTI_INSTANCE
+
+// Run n iterations of doomgeneric_Tick() back to back.  Intended for
+// backends with a virtual clock (see doomgeneric_headless.c) where
+// frames are pumped as fast as they can be rendered.
+void doomgeneric_RunFrames(int n);
+
 
 //Implement below functions for your platform
 void DG_Init();
@@ -0,0 +1,197 @@
+//doomgeneric for headless, display-less hosts
+//
+// Renders into DG_ScreenBuffer only: there is no window, DG_SleepMs
+// never sleeps and DG_GetTicksMs reports a virtual clock.  The clock
+// advances by exactly one tic per drawn frame (plus whatever the engine
+// asks to sleep), so the game runs one tic per frame as fast as the
+// host can render, independent of wall-clock time.
+//
+// In a multi-instance build (make -f Makefile.headless MULTI=1),
+// "-instances n" runs n independent engines on n threads.
+
+#include "doomkeys.h"
+#include "m_argv.h"
+#include "doomgeneric.h"
+#include "i_system.h"
+#include "i_timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef DOOMGENERIC_MULTI_INSTANCE
+#include <pthread.h>
+#endif
+
+// Number of frames presented so far.
+
+static DG_STATE uint64_t s_FrameCount = 0;
+
+// Milliseconds the engine has asked to sleep; added on top of the
+// per-frame clock so that busy-wait loops (e.g. TryRunTics) terminate.
+
+static DG_STATE uint64_t s_SleptMs = 0;
+
+void DG_Init()
+{
+    s_FrameCount = 0;
+    s_SleptMs = 0;
+}
+
+void DG_DrawFrame()
+{
+    ++s_FrameCount;
+}
+
+void DG_SleepMs(uint32_t ms)
+{
+    s_SleptMs += ms;
+}
+
+uint32_t DG_GetTicksMs()
+{
+    // Round the frame clock up so that I_GetTime() sees exactly one new
+    // tic for every frame drawn.
+
+    return (uint32_t) ((s_FrameCount * 1000 + TICRATE - 1) / TICRATE
+                       + s_SleptMs);
+}
+
+int DG_GetKey(int* pressed, unsigned char* doomKey)
+{
+    return 0;
+}
+
+void DG_SetWindowTitle(const char * title)
+{
+}
+
+#ifdef DOOMGENERIC_MULTI_INSTANCE
+
+typedef struct
+{
+    int argc;
+    char **argv;
+    int index;
+    int frames;
+} instance_args_t;
+
+static void *RunInstance(void *arg)
+{
+    instance_args_t *args = arg;
+    doomgeneric_context_t *ctx;
+    int i;
+
+    ctx = doomgeneric_CreateContext(args->argc, args->argv, args);
+
+    for (i = 0; i < args->frames; ++i)
+    {
+        doomgeneric_TickContext(ctx);
+    }
+
+    printf("DG_Headless: instance %d rendered %d frames\n",
+           args->index, args->frames);
+
+    return NULL;
+}
+
+// Run n instances on their own threads, each for the given number of
+// frames.
+
+static void RunInstances(int argc, char **argv, int n, int frames)
+{
+    instance_args_t *args;
+    pthread_t *threads;
+    int i;
+
+    args = calloc(n, sizeof(*args));
+    threads = calloc(n, sizeof(*threads));
+
+    for (i = 0; i < n; ++i)
+    {
+        args[i].argc = argc;
+        args[i].argv = argv;
+        args[i].index = i;
+        args[i].frames = frames;
+        pthread_create(&threads[i], NULL, RunInstance, &args[i]);
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(args);
+}
+
+#endif  // DOOMGENERIC_MULTI_INSTANCE
+
+int main(int argc, char **argv)
+{
+    int p;
+    int frames;
+
+#ifdef DOOMGENERIC_MULTI_INSTANCE
+    int instances;
+
+    myargc = argc;
+    myargv = argv;
+
+    //!
+    // @arg <n>
+    //
+    // Headless multi-instance build: run n independent engines, one per
+    // thread.  Requires -frames.
+    //
+
+    p = M_CheckParmWithArgs("-instances", 1);
+
+    if (p > 0)
+    {
+        instances = atoi(myargv[p + 1]);
+        p = M_CheckParmWithArgs("-frames", 1);
+
+        if (p <= 0)
+        {
+            fprintf(stderr, "-instances requires -frames\n");
+            return 1;
+        }
+
+        frames = atoi(myargv[p + 1]);
+
+        RunInstances(argc, argv, instances, frames);
+
+        return 0;
+    }
+#endif
+
+    doomgeneric_Create(argc, argv);
+
+    //!
+    // @arg <n>
+    //
+    // Headless backend: render n frames and then quit.  Without this
+    // the engine runs until it exits by itself.
+    //
+
+    p = M_CheckParmWithArgs("-frames", 1);
+
+    if (p > 0)
+    {
+        frames = atoi(myargv[p + 1]);
+
+        doomgeneric_RunFrames(frames);
+
+        printf("DG_Headless: rendered %d frames\n", frames);
+
+        I_Quit();
+        exit(0);
+    }
+
+    while(1)
+    {
+        doomgeneric_Tick();
+    }
+
+    return 0;
+}
@@ -4,6 +4,8 @@
 
 #include <stdio.h>
 
+// Keeps rpcndr.h, and its own boolean type, out.
+#define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
 static BITMAPINFO s_Bmi = { sizeof(BITMAPINFOHEADER), DOOMGENERIC_RESX, -DOOMGENERIC_RESY, 1, 32 };
@@ -22,13 +22,13 @@
 
 
 // Game Mode - identify IWAD as shareware, retail etc.
-GameMode_t gamemode = indetermined;
-GameMission_t	gamemission = doom;
-GameVersion_t   gameversion = exe_final2;
-char *gamedescription;
+DG_STATE GameMode_t gamemode = indetermined;
+DG_STATE GameMission_t	gamemission = doom;
+DG_STATE GameVersion_t   gameversion = exe_final2;
+DG_STATE char *gamedescription;
 
 // Set if homebrew PWAD stuff has been added.
-boolean	modifiedgame;
+DG_STATE boolean	modifiedgame;
 
 
 
@@ -37,6 +37,34 @@
 #endif
 
 
+// Storage class for mutable engine state.  In a multi-instance build
+// (DOOMGENERIC_MULTI_INSTANCE) it makes that state thread-local, so that
+// every thread can host its own independent engine instance.
+
+#ifndef DG_STATE
+#ifndef DOOMGENERIC_MULTI_INSTANCE
+#define DG_STATE
+#elif defined(_MSC_VER)
+#define DG_STATE __declspec(thread)
+#else
+#define DG_STATE __thread
+#endif
+#endif
+
+// Storage class for scratch state that every thread needs its own copy
+// of, even within one instance: the worker threads of i_thread.h each
+// set their own column and span drawer parameters, for example.
+
+#ifndef DG_THREAD_LOCAL
+#if !defined(HAVE_PTHREADS) && !defined(DOOMGENERIC_MULTI_INSTANCE)
+#define DG_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define DG_THREAD_LOCAL __declspec(thread)
+#else
+#define DG_THREAD_LOCAL __thread
+#endif
+#endif
+
 //
 // The packed attribute forces structures to be packed into the minimum 
 // space necessary.  If this is not done, the compiler may align structure
@@ -24,9 +24,9 @@
  *  public data                                                        *
  *---------------------------------------------------------------------*/
 
-boolean net_client_connected = false;
+DG_STATE boolean net_client_connected = false;
 
-boolean drone = false;
+DG_STATE boolean drone = false;
 
 /*---------------------------------------------------------------------*
  *  private data                                                       *
@@ -50,9 +50,9 @@ typedef enum
 //#include "f_finale.h"
 
 // Stage of animation:
-finalestage_t finalestage;
+DG_STATE finalestage_t finalestage;
 
-unsigned int finalecount;
+DG_STATE unsigned int finalecount;
 
 #define	TEXTSPEED	3
 #define	TEXTWAIT	250
@@ -94,8 +94,8 @@ static textscreen_t textscreens[] =
     { pack_plut, 1, 31, "RROCK19",   P6TEXT},
 };
 
-char*	finaletext;
-char*	finaleflat;
+DG_STATE char*	finaletext;
+DG_STATE char*	finaleflat;
 
 void	F_StartCast (void);
 void	F_CastTicker (void);
@@ -221,7 +221,7 @@ void F_Ticker (void)
 //
 
 #include "hu_stuff.h"
-extern	patch_t *hu_font[HU_FONTSIZE];
+extern DG_STATE	patch_t *hu_font[HU_FONTSIZE];
 
 
 void F_TextWrite (void)
@@ -229,7 +229,7 @@ void F_TextWrite (void)
     byte*	src;
     byte*	dest;
     
-    int		x,y,w;
+    int		w;
     signed int	count;
     char*	ch;
     int		c;
@@ -240,21 +240,9 @@ void F_TextWrite (void)
     src = W_CacheLumpName ( finaleflat , PU_CACHE);
     dest = I_VideoBuffer;
 	
-    for (y=0 ; y<SCREENHEIGHT ; y++)
-    {
-	for (x=0 ; x<SCREENWIDTH/64 ; x++)
-	{
-	    memcpy (dest, src+((y&63)<<6), 64);
-	    dest += 64;
-	}
-	if (SCREENWIDTH&63)
-	{
-	    memcpy (dest, src+((y&63)<<6), SCREENWIDTH&63);
-	    dest += (SCREENWIDTH&63);
-	}
-    }
+    V_FillFlat (src, dest, SCREENHEIGHT);
 
-    V_MarkRect (0, 0, SCREENWIDTH, SCREENHEIGHT);
+    V_MarkRect (0, 0, ORIGWIDTH, ORIGHEIGHT);
     
     // draw some of the text onto the screen
     cx = 10;
@@ -284,7 +272,7 @@ void F_TextWrite (void)
 	}
 		
 	w = SHORT (hu_font[c]->width);
-	if (cx+w > SCREENWIDTH)
+	if (cx+w > ORIGWIDTH)
 	    break;
 	V_DrawPatch(cx, cy, hu_font[c]);
 	cx+=w;
@@ -325,13 +313,13 @@ castinfo_t	castorder[] = {
     {NULL,0}
 };
 
-int		castnum;
-int		casttics;
-state_t*	caststate;
-boolean		castdeath;
-int		castframes;
-int		castonmelee;
-boolean		castattacking;
+DG_STATE int		castnum;
+DG_STATE int		casttics;
+DG_STATE state_t*	caststate;
+DG_STATE boolean		castdeath;
+DG_STATE int		castframes;
+DG_STATE int		castonmelee;
+DG_STATE boolean		castattacking;
 
 
 //
@@ -574,29 +562,7 @@ F_DrawPatchCol
   patch_t*	patch,
   int		col )
 {
-    column_t*	column;
-    byte*	source;
-    byte*	dest;
-    byte*	desttop;
-    int		count;
-	
-    column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
-    desttop = I_VideoBuffer + x;
-
-    // step through the posts in a column
-    while (column->topdelta != 0xff )
-    {
-	source = (byte *)column + 3;
-	dest = desttop + column->topdelta*SCREENWIDTH;
-	count = column->length;
-		
-	while (count--)
-	{
-	    *dest = *source++;
-	    dest += SCREENWIDTH;
-	}
-	column = (column_t *)(  (byte *)column + column->length + 4 );
-    }
+    V_DrawPatchColumn (x, 0, patch, col);
 }
 
 
@@ -611,12 +577,12 @@ void F_BunnyScroll (void)
     patch_t*	p2;
     char	name[10];
     int		stage;
-    static int	laststage;
+    static DG_STATE int	laststage;
 		
     p1 = W_CacheLumpName (DEH_String("PFUB2"), PU_LEVEL);
     p2 = W_CacheLumpName (DEH_String("PFUB1"), PU_LEVEL);
 
-    V_MarkRect (0, 0, SCREENWIDTH, SCREENHEIGHT);
+    V_MarkRect (0, 0, ORIGWIDTH, ORIGHEIGHT);
 	
     scrolled = (320 - ((signed int) finalecount-230)/2);
     if (scrolled > 320)
@@ -624,7 +590,7 @@ void F_BunnyScroll (void)
     if (scrolled < 0)
 	scrolled = 0;
 		
-    for ( x=0 ; x<SCREENWIDTH ; x++)
+    for ( x=0 ; x<ORIGWIDTH ; x++)
     {
 	if (x+scrolled < 320)
 	    F_DrawPatchCol (x, p1, x+scrolled);
@@ -636,8 +602,8 @@ void F_BunnyScroll (void)
 	return;
     if (finalecount < 1180)
     {
-        V_DrawPatch((SCREENWIDTH - 13 * 8) / 2,
-                    (SCREENHEIGHT - 8 * 8) / 2, 
+        V_DrawPatch((ORIGWIDTH - 13 * 8) / 2,
+                    (ORIGHEIGHT - 8 * 8) / 2, 
                     W_CacheLumpName(DEH_String("END0"), PU_CACHE));
 	laststage = 0;
 	return;
@@ -653,8 +619,8 @@ void F_BunnyScroll (void)
     }
 	
     DEH_snprintf(name, 10, "END%i", stage);
-    V_DrawPatch((SCREENWIDTH - 13 * 8) / 2, 
-                (SCREENHEIGHT - 8 * 8) / 2, 
+    V_DrawPatch((ORIGWIDTH - 13 * 8) / 2, 
+                (ORIGHEIGHT - 8 * 8) / 2, 
                 W_CacheLumpName (name,PU_CACHE));
 }
 
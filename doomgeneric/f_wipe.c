@@ -18,6 +18,8 @@
 
 #include <string.h>
 
+#include "doomgeneric.h"
+
 #include "z_zone.h"
 #include "i_video.h"
 #include "v_video.h"
@@ -32,34 +34,16 @@
 //
 
 // when zero, stop the wipe
-static boolean	go = 0;
-
-static byte*	wipe_scr_start;
-static byte*	wipe_scr_end;
-static byte*	wipe_scr;
-
-
-void
-wipe_shittyColMajorXform
-( short*	array,
-  int		width,
-  int		height )
-{
-    int		x;
-    int		y;
-    short*	dest;
-
-    dest = (short*) Z_Malloc(width*height*2, PU_STATIC, 0);
+static DG_STATE boolean	go = 0;
 
-    for(y=0;y<height;y++)
-	for(x=0;x<width;x++)
-	    dest[x*height+y] = array[y*width+x];
+static DG_STATE byte*	wipe_scr_start;
+static DG_STATE byte*	wipe_scr_end;
+static DG_STATE byte*	wipe_scr;
 
-    memcpy(array, dest, width*height*2);
+// Bytes per pixel of the screens: with -truecolor the wipe runs on
+//  pixels, in DG_ScreenBuffer, rather than on palette indices.
+static DG_STATE int	wipe_pixelsize = 1;
 
-    Z_Free(dest);
-
-}
 
 int
 wipe_initColorXForm
@@ -67,7 +51,7 @@ wipe_initColorXForm
   int	height,
   int	ticks )
 {
-    memcpy(wipe_scr, wipe_scr_start, width*height);
+    memcpy(wipe_scr, wipe_scr_start, width*height*wipe_pixelsize);
     return 0;
 }
 
@@ -86,7 +70,8 @@ wipe_doColorXForm
     w = wipe_scr;
     e = wipe_scr_end;
     
-    while (w!=wipe_scr+width*height)
+    // On pixels this fades each color channel on its own.
+    while (w!=wipe_scr+width*height*wipe_pixelsize)
     {
 	if (*w != *e)
 	{
@@ -127,7 +112,14 @@ wipe_exitColorXForm
 }
 
 
-static int*	y;
+// The melt runs in the coordinates of the original 320x200 screen,
+//  in columns two pixels wide, whatever the size of the real one.
+#define MELTCOLUMNS	(ORIGWIDTH/2)
+
+static DG_STATE int*	y;
+
+// Screen row each screen column has melted down to.
+static DG_STATE int*	meltrow;
 
 int
 wipe_initMelt
@@ -138,18 +130,15 @@ wipe_initMelt
     int i, r;
     
     // copy start screen to main screen
-    memcpy(wipe_scr, wipe_scr_start, width*height);
-    
-    // makes this wipe faster (in theory)
-    // to have stuff in column-major format
-    wipe_shittyColMajorXform((short*)wipe_scr_start, width/2, height);
-    wipe_shittyColMajorXform((short*)wipe_scr_end, width/2, height);
+    memcpy(wipe_scr, wipe_scr_start, width*height*wipe_pixelsize);
     
     // setup initial column positions
     // (y<0 => not ready to scroll yet)
-    y = (int *) Z_Malloc(width*sizeof(int), PU_STATIC, 0);
+    // One per pixel of the original screen, though only the first
+    //  MELTCOLUMNS are used, to take as many random numbers.
+    y = (int *) Z_Malloc(ORIGWIDTH*sizeof(int), PU_STATIC, 0);
     y[0] = -(M_Random()%16);
-    for (i=1;i<width;i++)
+    for (i=1;i<ORIGWIDTH;i++)
     {
 	r = (M_Random()%3) - 1;
 	y[i] = y[i-1] + r;
@@ -157,6 +146,8 @@ wipe_initMelt
 	else if (y[i] == -16) y[i] = -15;
     }
 
+    meltrow = (int *) Z_Malloc(width*sizeof(int), PU_STATIC, 0);
+
     return 0;
 }
 
@@ -167,50 +158,74 @@ wipe_doMelt
   int	ticks )
 {
     int		i;
-    int		j;
+    int		x;
+    int		row;
     int		dy;
-    int		idx;
     
-    short*	s;
-    short*	d;
+    byte*	d;
     boolean	done = true;
 
-    width/=2;
-
     while (ticks--)
     {
-	for (i=0;i<width;i++)
+	for (i=0;i<MELTCOLUMNS;i++)
 	{
 	    if (y[i]<0)
 	    {
 		y[i]++; done = false;
 	    }
-	    else if (y[i] < height)
+	    else if (y[i] < ORIGHEIGHT)
 	    {
 		dy = (y[i] < 16) ? y[i]+1 : 8;
-		if (y[i]+dy >= height) dy = height - y[i];
-		s = &((short *)wipe_scr_end)[i*height+y[i]];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=dy;j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
+		if (y[i]+dy >= ORIGHEIGHT) dy = ORIGHEIGHT - y[i];
 		y[i] += dy;
-		s = &((short *)wipe_scr_start)[i*height];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=height-y[i];j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
 		done = false;
 	    }
 	}
     }
 
+    for (x=0;x<width;x++)
+    {
+	i = x * MELTCOLUMNS / width;
+	meltrow[x] = y[i] > 0 ? V_ScreenY(y[i]) : 0;
+    }
+
+    // Above its melt row, each column shows the end screen, and
+    //  below it the start screen, pushed down.
+#ifndef CMAP256
+    if (wipe_pixelsize != 1)
+    {
+	pixel_t*	pd = (pixel_t *) wipe_scr;
+	pixel_t*	ps = (pixel_t *) wipe_scr_start;
+	pixel_t*	pe = (pixel_t *) wipe_scr_end;
+
+	for (row=0;row<height;row++)
+	{
+	    for (x=0;x<width;x++)
+	    {
+		if (row < meltrow[x])
+		    *pd++ = pe[row*width+x];
+		else
+		    *pd++ = ps[(row-meltrow[x])*width+x];
+	    }
+	}
+
+	return done;
+    }
+#endif
+
+    d = wipe_scr;
+
+    for (row=0;row<height;row++)
+    {
+	for (x=0;x<width;x++)
+	{
+	    if (row < meltrow[x])
+		*d++ = wipe_scr_end[row*width+x];
+	    else
+		*d++ = wipe_scr_start[(row-meltrow[x])*width+x];
+	}
+    }
+
     return done;
 
 }
@@ -222,6 +237,7 @@ wipe_exitMelt
   int	ticks )
 {
     Z_Free(y);
+    Z_Free(meltrow);
     Z_Free(wipe_scr_start);
     Z_Free(wipe_scr_end);
     return 0;
@@ -234,6 +250,20 @@ wipe_StartScreen
   int	width,
   int	height )
 {
+#ifndef CMAP256
+    // The last frame is only complete in DG_ScreenBuffer.
+    if (truecolor)
+    {
+	wipe_pixelsize = sizeof(pixel_t);
+	wipe_scr_start = Z_Malloc(SCREENWIDTH * SCREENHEIGHT * wipe_pixelsize,
+				  PU_STATIC, NULL);
+	memcpy(wipe_scr_start, DG_ScreenBuffer,
+	       SCREENWIDTH * SCREENHEIGHT * wipe_pixelsize);
+	return 0;
+    }
+#endif
+
+    wipe_pixelsize = 1;
     wipe_scr_start = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
     I_ReadScreen(wipe_scr_start);
     return 0;
@@ -246,6 +276,16 @@ wipe_EndScreen
   int	width,
   int	height )
 {
+#ifndef CMAP256
+    if (wipe_pixelsize != 1)
+    {
+	wipe_scr_end = Z_Malloc(SCREENWIDTH * SCREENHEIGHT * wipe_pixelsize,
+				PU_STATIC, NULL);
+	I_ReadScreenPixels((pixel_t *) wipe_scr_end);
+	return 0;
+    }
+#endif
+
     wipe_scr_end = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
     I_ReadScreen(wipe_scr_end);
     V_DrawBlock(x, y, width, height, wipe_scr_start); // restore start scr.
@@ -274,11 +314,19 @@ wipe_ScreenWipe
 	go = 1;
 	// wipe_scr = (byte *) Z_Malloc(width*height, PU_STATIC, 0); // DEBUG
 	wipe_scr = I_VideoBuffer;
+#ifndef CMAP256
+	if (wipe_pixelsize != 1)
+	    wipe_scr = (byte *) DG_ScreenBuffer;
+#endif
 	(*wipes[wipeno*3])(width, height, ticks);
     }
 
     // do a piece of wipe-in
     V_MarkRect(0, 0, width, height);
+#ifndef CMAP256
+    if (wipe_pixelsize != 1)
+	I_MarkTrueColor(x, y, width, height);
+#endif
     rc = (*wipes[wipeno*3+1])(width, height, ticks);
     //  V_DrawBlock(x, y, 0, width, height, wipe_scr); // DEBUG
 
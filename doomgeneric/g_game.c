@@ -31,6 +31,7 @@
 #include "z_zone.h"
 #include "f_finale.h"
 #include "m_argv.h"
+#include "m_bench.h"
 #include "m_controls.h"
 #include "m_misc.h"
 #include "m_menu.h"
@@ -91,86 +92,75 @@ void	G_DoSaveGame (void);
  
 // Gamestate the last time G_Ticker was called.
 
-gamestate_t     oldgamestate; 
+DG_STATE gamestate_t     oldgamestate; 
  
-gameaction_t    gameaction; 
-gamestate_t     gamestate; 
-skill_t         gameskill; 
-boolean		respawnmonsters;
-int             gameepisode; 
-int             gamemap; 
+DG_STATE gameaction_t    gameaction; 
+DG_STATE gamestate_t     gamestate; 
+DG_STATE skill_t         gameskill; 
+DG_STATE boolean		respawnmonsters;
+DG_STATE int             gameepisode; 
+DG_STATE int             gamemap; 
 
 // If non-zero, exit the level after this number of minutes.
 
-int             timelimit;
+DG_STATE int             timelimit;
 
-boolean         paused; 
-boolean         sendpause;             	// send a pause event next tic 
-boolean         sendsave;             	// send a save event next tic 
-boolean         usergame;               // ok to save / end game 
+DG_STATE boolean         paused; 
+DG_STATE boolean         sendpause;             	// send a pause event next tic 
+DG_STATE boolean         sendsave;             	// send a save event next tic 
+DG_STATE boolean         usergame;               // ok to save / end game 
  
-boolean         timingdemo;             // if true, exit with report on completion 
-boolean         nodrawers;              // for comparative timing purposes 
-int             starttime;          	// for comparative timing purposes  	 
+DG_STATE boolean         timingdemo;             // if true, exit with report on completion 
+DG_STATE boolean         nodrawers;              // for comparative timing purposes 
+DG_STATE int             starttime;          	// for comparative timing purposes  	 
  
-boolean         viewactive; 
+DG_STATE boolean         viewactive; 
  
-int             deathmatch;           	// only if started as net death 
-boolean         netgame;                // only true if packets are broadcast 
-boolean         playeringame[MAXPLAYERS]; 
-player_t        players[MAXPLAYERS]; 
+DG_STATE int             deathmatch;           	// only if started as net death 
+DG_STATE boolean         netgame;                // only true if packets are broadcast 
+DG_STATE boolean         playeringame[MAXPLAYERS]; 
+DG_STATE player_t        players[MAXPLAYERS]; 
 
-boolean         turbodetected[MAXPLAYERS];
+DG_STATE boolean         turbodetected[MAXPLAYERS];
  
-int             consoleplayer;          // player taking events and displaying 
-int             displayplayer;          // view being displayed 
-int             levelstarttic;          // gametic at level start 
-int             totalkills, totalitems, totalsecret;    // for intermission 
+DG_STATE int             consoleplayer;          // player taking events and displaying 
+DG_STATE int             displayplayer;          // view being displayed 
+DG_STATE int             levelstarttic;          // gametic at level start 
+DG_STATE int             totalkills, totalitems, totalsecret;    // for intermission 
  
-char           *demoname;
-boolean         demorecording; 
-boolean         longtics;               // cph's doom 1.91 longtics hack
-boolean         lowres_turn;            // low resolution turning for longtics
-boolean         demoplayback; 
-boolean		netdemo; 
-byte*		demobuffer;
-byte*		demo_p;
-byte*		demoend; 
-boolean         singledemo;            	// quit after playing a demo from cmdline 
+DG_STATE char           *demoname;
+DG_STATE boolean         demorecording; 
+DG_STATE boolean         longtics;               // cph's doom 1.91 longtics hack
+DG_STATE boolean         lowres_turn;            // low resolution turning for longtics
+DG_STATE boolean         demoplayback; 
+DG_STATE boolean		netdemo; 
+DG_STATE byte*		demobuffer;
+DG_STATE byte*		demo_p;
+DG_STATE byte*		demoend; 
+DG_STATE boolean         singledemo;            	// quit after playing a demo from cmdline 
  
-boolean         precache = true;        // if true, load all graphics at start 
+DG_STATE boolean         precache = true;        // if true, load all graphics at start 
 
-boolean         testcontrols = false;    // Invoked by setup to test controls
-int             testcontrols_mousespeed;
+DG_STATE boolean         testcontrols = false;    // Invoked by setup to test controls
+DG_STATE int             testcontrols_mousespeed;
  
 
  
-wbstartstruct_t wminfo;               	// parms for world map / intermission 
+DG_STATE wbstartstruct_t wminfo;               	// parms for world map / intermission 
  
-byte		consistancy[MAXPLAYERS][BACKUPTICS]; 
+DG_STATE byte		consistancy[MAXPLAYERS][BACKUPTICS]; 
  
 #define MAXPLMOVE		(forwardmove[1]) 
  
 #define TURBOTHRESHOLD	0x32
 
-fixed_t         forwardmove[2] = {0x19, 0x32}; 
-fixed_t         sidemove[2] = {0x18, 0x28}; 
-fixed_t         angleturn[3] = {640, 1280, 320};    // + slow turn 
-
-static int *weapon_keys[] = {
-    &key_weapon1,
-    &key_weapon2,
-    &key_weapon3,
-    &key_weapon4,
-    &key_weapon5,
-    &key_weapon6,
-    &key_weapon7,
-    &key_weapon8
-};
+DG_STATE fixed_t         forwardmove[2] = {0x19, 0x32}; 
+DG_STATE fixed_t         sidemove[2] = {0x18, 0x28}; 
+DG_STATE fixed_t         angleturn[3] = {640, 1280, 320};    // + slow turn 
 
 // Set to -1 or +1 to switch to the previous or next weapon.
 
-static int next_weapon = 0;
+static DG_STATE int next_weapon = 0;
 
 // Used for prev/next weapon keys.
 
@@ -195,40 +185,40 @@ static const struct
 #define NUMKEYS		256 
 #define MAX_JOY_BUTTONS 20
 
-static boolean  gamekeydown[NUMKEYS]; 
-static int      turnheld;		// for accelerative turning 
+static DG_STATE boolean  gamekeydown[NUMKEYS]; 
+static DG_STATE int      turnheld;		// for accelerative turning 
  
-static boolean  mousearray[MAX_MOUSE_BUTTONS + 1];
-static boolean *mousebuttons = &mousearray[1];  // allow [-1]
+static DG_STATE boolean  mousearray[MAX_MOUSE_BUTTONS + 1];
+#define mousebuttons (&mousearray[1])  // allow [-1]
 
 // mouse values are used once 
-int             mousex;
-int             mousey;         
+DG_STATE int             mousex;
+DG_STATE int             mousey;         
 
-static int      dclicktime;
-static boolean  dclickstate;
-static int      dclicks; 
-static int      dclicktime2;
-static boolean  dclickstate2;
-static int      dclicks2;
+static DG_STATE int      dclicktime;
+static DG_STATE boolean  dclickstate;
+static DG_STATE int      dclicks; 
+static DG_STATE int      dclicktime2;
+static DG_STATE boolean  dclickstate2;
+static DG_STATE int      dclicks2;
 
 // joystick values are repeated 
-static int      joyxmove;
-static int      joyymove;
-static int      joystrafemove;
-static boolean  joyarray[MAX_JOY_BUTTONS + 1]; 
-static boolean *joybuttons = &joyarray[1];		// allow [-1] 
+static DG_STATE int      joyxmove;
+static DG_STATE int      joyymove;
+static DG_STATE int      joystrafemove;
+static DG_STATE boolean  joyarray[MAX_JOY_BUTTONS + 1]; 
+#define joybuttons (&joyarray[1])		// allow [-1] 
  
-static int      savegameslot; 
-static char     savedescription[32]; 
+static DG_STATE int      savegameslot; 
+static DG_STATE char     savedescription[32]; 
  
 #define	BODYQUESIZE	32
 
-mobj_t*		bodyque[BODYQUESIZE]; 
-int		bodyqueslot; 
+DG_STATE mobj_t*		bodyque[BODYQUESIZE]; 
+DG_STATE int		bodyqueslot; 
  
-int             vanilla_savegame_limit = 1;
-int             vanilla_demo_limit = 1;
+DG_STATE int             vanilla_savegame_limit = 1;
+DG_STATE int             vanilla_demo_limit = 1;
  
 int G_CmdChecksum (ticcmd_t* cmd) 
 { 
@@ -453,6 +443,20 @@ void G_BuildTiccmd (ticcmd_t* cmd, int maketic)
     }
     else
     {
+        // The key bindings are per-instance state, so this table
+        // cannot be static.
+
+        int *weapon_keys[] = {
+            &key_weapon1,
+            &key_weapon2,
+            &key_weapon3,
+            &key_weapon4,
+            &key_weapon5,
+            &key_weapon6,
+            &key_weapon7,
+            &key_weapon8
+        };
+
         // Check weapon keys.
 
         for (i=0; i<arrlen(weapon_keys); ++i)
@@ -579,7 +583,7 @@ void G_BuildTiccmd (ticcmd_t* cmd, int maketic)
 
     if (lowres_turn)
     {
-        static signed short carry = 0;
+        static DG_STATE signed short carry = 0;
         signed short desired_angleturn;
 
         desired_angleturn = cmd->angleturn + carry;
@@ -935,7 +939,7 @@ void G_Ticker (void)
              && ((gametic >> 5) % MAXPLAYERS) == i
              && turbodetected[i])
             {
-                static char turbomessage[80];
+                static DG_STATE char turbomessage[80];
                 extern char *player_names[4];
                 M_snprintf(turbomessage, sizeof(turbomessage),
                            "%s is turbo!", player_names[i]);
@@ -1005,7 +1009,9 @@ void G_Ticker (void)
     switch (gamestate) 
     { 
       case GS_LEVEL: 
+	M_BenchBegin (bench_ticker);
 	P_Ticker (); 
+	M_BenchEnd (bench_ticker);
 	ST_Ticker (); 
 	AM_Ticker (); 
 	HU_Ticker ();            
@@ -1322,8 +1328,8 @@ int cpars[32] =
 //
 // G_DoCompleted 
 //
-boolean		secretexit; 
-extern char*	pagename; 
+DG_STATE boolean		secretexit; 
+extern DG_STATE char*	pagename; 
  
 void G_ExitLevel (void) 
 { 
@@ -1531,10 +1537,10 @@ void G_DoWorldDone (void)
 // G_InitFromSavegame
 // Can be called by the startup code or the menu task. 
 //
-extern boolean setsizeneeded;
+extern DG_STATE boolean setsizeneeded;
 void R_ExecuteSetViewSize (void);
 
-char	savename[256];
+DG_STATE char	savename[256];
 
 void G_LoadGame (char* name) 
 { 
@@ -1690,9 +1696,9 @@ void G_DoSaveGame (void)
 // Can be called by the startup code or the menu task,
 // consoleplayer, displayplayer, playeringame[] should be set. 
 //
-skill_t	d_skill; 
-int     d_episode; 
-int     d_map; 
+DG_STATE skill_t	d_skill; 
+DG_STATE int     d_episode; 
+DG_STATE int     d_map; 
  
 void
 G_DeferedInitNew
@@ -2102,7 +2108,7 @@ void G_BeginRecording (void)
 // G_PlayDemo 
 //
 
-char*	defdemoname; 
+DG_STATE char*	defdemoname; 
  
 void G_DeferedPlayDemo (char* name) 
 { 
@@ -2114,7 +2120,7 @@ void G_DeferedPlayDemo (char* name)
 
 static char *DemoVersionDescription(int version)
 {
-    static char resultbuf[16];
+    static DG_STATE char resultbuf[16];
 
     switch (version)
     {
@@ -2209,6 +2215,7 @@ void G_DoPlayDemo (void)
     G_InitNew (skill, episode, map); 
     precache = true; 
     starttime = I_GetTime (); 
+    M_BenchDemoStarted ();
 
     usergame = false; 
     demoplayback = true; 
@@ -2249,7 +2256,7 @@ boolean G_CheckDemoStatus (void)
 { 
     int             endtime; 
 	 
-    if (timingdemo) 
+    if (timingdemo && !benchmarking) 
     { 
         float fps;
         int realtics;
@@ -2279,7 +2286,13 @@ boolean G_CheckDemoStatus (void)
 	nomonsters = false;
 	consoleplayer = 0;
         
-        if (singledemo) 
+        if (timingdemo)
+        {
+            // Benchmark: start the next run, or report and quit.
+            timingdemo = false;
+            M_BenchDemoFinished ();
+        }
+        else if (singledemo) 
             I_Quit (); 
         else 
             D_AdvanceDemo (); 
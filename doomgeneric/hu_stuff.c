@@ -61,7 +61,7 @@
 
 
 
-char *chat_macros[10] =
+DG_STATE char *chat_macros[10] =
 {
     HUSTR_CHATMACRO0,
     HUSTR_CHATMACRO1,
@@ -83,26 +83,26 @@ char*	player_names[] =
     HUSTR_PLRRED
 };
 
-char			chat_char; // remove later.
-static player_t*	plr;
-patch_t*		hu_font[HU_FONTSIZE];
-static hu_textline_t	w_title;
-boolean			chat_on;
-static hu_itext_t	w_chat;
-static boolean		always_off = false;
-static char		chat_dest[MAXPLAYERS];
-static hu_itext_t w_inputbuffer[MAXPLAYERS];
+DG_STATE char			chat_char; // remove later.
+static DG_STATE player_t*	plr;
+DG_STATE patch_t*		hu_font[HU_FONTSIZE];
+static DG_STATE hu_textline_t	w_title;
+DG_STATE boolean			chat_on;
+static DG_STATE hu_itext_t	w_chat;
+static DG_STATE boolean		always_off = false;
+static DG_STATE char		chat_dest[MAXPLAYERS];
+static DG_STATE hu_itext_t w_inputbuffer[MAXPLAYERS];
 
-static boolean		message_on;
-boolean			message_dontfuckwithme;
-static boolean		message_nottobefuckedwith;
+static DG_STATE boolean		message_on;
+DG_STATE boolean			message_dontfuckwithme;
+static DG_STATE boolean		message_nottobefuckedwith;
 
-static hu_stext_t	w_message;
-static int		message_counter;
+static DG_STATE hu_stext_t	w_message;
+static DG_STATE int		message_counter;
 
-extern int		showMessages;
+extern DG_STATE int		showMessages;
 
-static boolean		headsupactive = false;
+static DG_STATE boolean		headsupactive = false;
 
 //
 // Builtin map names.
@@ -474,9 +474,9 @@ void HU_Ticker(void)
 
 #define QUEUESIZE		128
 
-static char	chatchars[QUEUESIZE];
-static int	head = 0;
-static int	tail = 0;
+static DG_STATE char	chatchars[QUEUESIZE];
+static DG_STATE int	head = 0;
+static DG_STATE int	tail = 0;
 
 
 void HU_queueChatChar(char c)
@@ -512,15 +512,15 @@ char HU_dequeueChatChar(void)
 boolean HU_Responder(event_t *ev)
 {
 
-    static char		lastmessage[HU_MAXLINELENGTH+1];
+    static DG_STATE char		lastmessage[HU_MAXLINELENGTH+1];
     char*		macromessage;
     boolean		eatkey = false;
-    static boolean	altdown = false;
+    static DG_STATE boolean	altdown = false;
     unsigned char 	c;
     int			i;
     int			numplayers;
     
-    static int		num_nobrainers = 0;
+    static DG_STATE int		num_nobrainers = 0;
 
     numplayers = 0;
     for (i=0 ; i<MAXPLAYERS ; i++)
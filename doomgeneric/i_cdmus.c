@@ -33,7 +33,7 @@ static char *startup_error = NULL;
 static const char *cd_name = NULL;
 #endif
 
-int cd_Error;
+DG_STATE int cd_Error;
 
 int I_CDMusInit(void)
 {
@@ -41,11 +41,11 @@
 
 #include "doomgeneric.h"
 
-int vanilla_keyboard_mapping = 1;
+DG_STATE int vanilla_keyboard_mapping = 1;
 
 // Is the shift key currently down?
 
-static int shiftdown = 0;
+static DG_STATE int shiftdown = 0;
 
 // Lookup table for mapping AT keycodes to their doom keycode
 static const char at_to_doom[] =
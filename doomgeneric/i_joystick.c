@@ -45,32 +45,32 @@ static SDL_Joystick *joystick = NULL;
 
 // Standard default.cfg Joystick enable/disable
 
-static int usejoystick = 0;
+static DG_STATE int usejoystick = 0;
 
 // Joystick to use, as an SDL joystick index:
 
-static int joystick_index = -1;
+static DG_STATE int joystick_index = -1;
 
 // Which joystick axis to use for horizontal movement, and whether to
 // invert the direction:
 
-static int joystick_x_axis = 0;
-static int joystick_x_invert = 0;
+static DG_STATE int joystick_x_axis = 0;
+static DG_STATE int joystick_x_invert = 0;
 
 // Which joystick axis to use for vertical movement, and whether to
 // invert the direction:
 
-static int joystick_y_axis = 1;
-static int joystick_y_invert = 0;
+static DG_STATE int joystick_y_axis = 1;
+static DG_STATE int joystick_y_invert = 0;
 
 // Which joystick axis to use for strafing?
 
-static int joystick_strafe_axis = -1;
-static int joystick_strafe_invert = 0;
+static DG_STATE int joystick_strafe_axis = -1;
+static DG_STATE int joystick_strafe_invert = 0;
 
 // Virtual to physical button joystick button mapping. By default this
 // is a straight mapping.
-static int joystick_physical_buttons[NUM_VIRTUAL_BUTTONS] = {
+static DG_STATE int joystick_physical_buttons[NUM_VIRTUAL_BUTTONS] = {
     0, 1, 2, 3, 4, 5, 6, 7, 8, 9
 };
 
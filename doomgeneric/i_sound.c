@@ -36,38 +36,38 @@
 
 // Sound sample rate to use for digital output (Hz)
 
-int snd_samplerate = 44100;
+DG_STATE int snd_samplerate = 44100;
 
 // Maximum number of bytes to dedicate to allocated sound effects.
 // (Default: 64MB)
 
-int snd_cachesize = 64 * 1024 * 1024;
+DG_STATE int snd_cachesize = 64 * 1024 * 1024;
 
 // Config variable that controls the sound buffer size.
 // We default to 28ms (1000 / 35fps = 1 buffer per tic).
 
-int snd_maxslicetime_ms = 28;
+DG_STATE int snd_maxslicetime_ms = 28;
 
 // External command to invoke to play back music.
 
-char *snd_musiccmd = "";
+DG_STATE char *snd_musiccmd = "";
 
 // Low-level sound and music modules we are using
 
-static sound_module_t *sound_module = NULL;
+static DG_STATE sound_module_t *sound_module = NULL;
 static music_module_t *music_module = NULL;
 
-int snd_musicdevice = SNDDEVICE_SB;
-int snd_sfxdevice = SNDDEVICE_SB;
+DG_STATE int snd_musicdevice = SNDDEVICE_SB;
+DG_STATE int snd_sfxdevice = SNDDEVICE_SB;
 
 // DOS-specific options: These are unused but should be maintained
 // so that the config file can be shared between chocolate
 // doom and doom.exe
 
-static int snd_sbport = 0;
-static int snd_sbirq = 0;
-static int snd_sbdma = 0;
-static int snd_mport = 0;
+static DG_STATE int snd_sbport = 0;
+static DG_STATE int snd_sbirq = 0;
+static DG_STATE int snd_sbdma = 0;
+static DG_STATE int snd_mport = 0;
 
 // Compiled-in sound modules:
 
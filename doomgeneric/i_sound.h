@@ -225,12 +225,12 @@ void I_PlaySong(void *handle, boolean looping);
 void I_StopSong(void);
 boolean I_MusicIsPlaying(void);
 
-extern int snd_sfxdevice;
-extern int snd_musicdevice;
-extern int snd_samplerate;
-extern int snd_cachesize;
-extern int snd_maxslicetime_ms;
-extern char *snd_musiccmd;
+extern DG_STATE int snd_sfxdevice;
+extern DG_STATE int snd_musicdevice;
+extern DG_STATE int snd_samplerate;
+extern DG_STATE int snd_cachesize;
+extern DG_STATE int snd_maxslicetime_ms;
+extern DG_STATE char *snd_musiccmd;
 
 void I_BindSoundVariables(void);
 
@@ -68,7 +68,7 @@ struct atexit_listentry_s
     atexit_listentry_t *next;
 };
 
-static atexit_listentry_t *exit_funcs = NULL;
+static DG_STATE atexit_listentry_t *exit_funcs = NULL;
 
 void I_AtExit(atexit_func_t func, boolean run_on_error)
 {
@@ -134,6 +134,7 @@ byte *I_ZoneBase (int *size)
 {
     byte *zonemem;
     int min_ram, default_ram;
+    int extra_ram;
     int p;
 
     //!
@@ -153,6 +154,16 @@ byte *I_ZoneBase (int *size)
     {
         default_ram = DEFAULT_RAM;
         min_ram = MIN_RAM;
+
+        // Make room for the screen-sized buffers (the screen, the
+        // status bar and view border backgrounds and the two wipe
+        // screens) if the screen is bigger than the original.
+
+        extra_ram = 5 * (SCREENWIDTH * SCREENHEIGHT - ORIGWIDTH * ORIGHEIGHT);
+        extra_ram = (extra_ram + 1024 * 1024 - 1) / (1024 * 1024);
+
+        default_ram += extra_ram;
+        min_ram += extra_ram;
     }
 
     zonemem = AutoAllocMemory(size, default_ram, min_ram);
@@ -355,7 +366,7 @@ static int ZenityErrorBox(char *message)
 // I_Error
 //
 
-static boolean already_quitting = false;
+static DG_STATE boolean already_quitting = false;
 
 void I_Error (char *error, ...)
 {
@@ -502,13 +513,13 @@ static const unsigned char mem_dump_win98[DOS_MEM_DUMP_SIZE] = {
   0x9E, 0x0F, 0xC9, 0x00, 0x65, 0x04, 0x70, 0x00, 0x16, 0x00};
 static const unsigned char mem_dump_dosbox[DOS_MEM_DUMP_SIZE] = {
   0x00, 0x00, 0x00, 0xF1, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00};
-static unsigned char mem_dump_custom[DOS_MEM_DUMP_SIZE];
+static DG_STATE unsigned char mem_dump_custom[DOS_MEM_DUMP_SIZE];
 
-static const unsigned char *dos_mem_dump = mem_dump_dos622;
+static DG_STATE const unsigned char *dos_mem_dump = mem_dump_dos622;
 
 boolean I_GetMemoryValue(unsigned int offset, void *value, int size)
 {
-    static boolean firsttime = true;
+    static DG_STATE boolean firsttime = true;
 
     if (firsttime)
     {
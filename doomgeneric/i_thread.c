@@ -0,0 +1,180 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker threads.
+//
+
+#include <stdio.h>
+
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "doomtype.h"
+#include "i_thread.h"
+
+#define MAXWORKERS 64
+
+#if defined(HAVE_PTHREADS) && !defined(DOOMGENERIC_MULTI_INSTANCE)
+
+static pthread_t workers[MAXWORKERS];
+static int num_workers = 0;
+
+// Protects everything below.
+
+static pthread_mutex_t work_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Signalled when a new batch of tasks is posted, and when the last
+// task of a batch finishes.
+
+static pthread_cond_t work_posted = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+
+static workertask_t work_task;
+static void *work_data;
+static int work_next;
+static int work_count;
+static int work_pending;
+
+static void *WorkerThread(void *arg)
+{
+    workertask_t task;
+    void *data;
+    int i;
+
+    pthread_mutex_lock(&work_lock);
+
+    for (;;)
+    {
+        while (work_next >= work_count)
+        {
+            pthread_cond_wait(&work_posted, &work_lock);
+        }
+
+        task = work_task;
+        data = work_data;
+        i = work_next++;
+
+        pthread_mutex_unlock(&work_lock);
+
+        task(data, i);
+
+        pthread_mutex_lock(&work_lock);
+
+        --work_pending;
+
+        if (work_pending == 0)
+        {
+            pthread_cond_signal(&work_done);
+        }
+    }
+
+    return NULL;
+}
+
+int I_StartWorkers(int count)
+{
+    if (count > MAXWORKERS)
+    {
+        count = MAXWORKERS;
+    }
+
+    while (num_workers < count)
+    {
+        if (pthread_create(&workers[num_workers], NULL,
+                           WorkerThread, NULL) != 0)
+        {
+            printf("I_StartWorkers: only started %i of %i threads\n",
+                   num_workers, count);
+            break;
+        }
+
+        ++num_workers;
+    }
+
+    return num_workers;
+}
+
+int I_NumWorkers(void)
+{
+    return num_workers;
+}
+
+void I_RunWorkers(workertask_t task, void *data, int num_tasks)
+{
+    int i;
+
+    if (num_workers == 0)
+    {
+        for (i = 0; i < num_tasks; ++i)
+        {
+            task(data, i);
+        }
+
+        return;
+    }
+
+    pthread_mutex_lock(&work_lock);
+
+    work_task = task;
+    work_data = data;
+    work_next = 0;
+    work_count = num_tasks;
+    work_pending = num_tasks;
+
+    pthread_cond_broadcast(&work_posted);
+
+    while (work_pending > 0)
+    {
+        pthread_cond_wait(&work_done, &work_lock);
+    }
+
+    pthread_mutex_unlock(&work_lock);
+}
+
+#else
+
+// Without thread support, or in a multi-instance build: there, the
+// engine state is thread-local (see DG_STATE), so a worker thread
+// could not see the instance it would be working for.  Each instance
+// already has a thread of its own.
+
+int I_StartWorkers(int count)
+{
+    if (count > 0)
+    {
+        printf("I_StartWorkers: worker threads are not supported "
+               "in this build\n");
+    }
+
+    return 0;
+}
+
+int I_NumWorkers(void)
+{
+    return 0;
+}
+
+void I_RunWorkers(workertask_t task, void *data, int num_tasks)
+{
+    int i;
+
+    for (i = 0; i < num_tasks; ++i)
+    {
+        task(data, i);
+    }
+}
+
+#endif
+
@@ -0,0 +1,45 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker threads, for splitting work across several cores.
+//      Only available when built with HAVE_PTHREADS; otherwise
+//      everything runs on the calling thread.
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+// A task run on a worker thread: called with the data pointer passed
+// to I_RunWorkers and the index of the task.
+
+typedef void (*workertask_t)(void *data, int task);
+
+// Start count worker threads.  Returns the number of workers that are
+// now running, which is 0 if threads are not supported.
+
+int I_StartWorkers(int count);
+
+// Number of worker threads running.
+
+int I_NumWorkers(void);
+
+// Run task(data, i) for every i in 0..num_tasks-1 on the worker
+// threads, and wait for all of them to finish.  Without workers,
+// the tasks are run on the calling thread.
+
+void I_RunWorkers(workertask_t task, void *data, int num_tasks);
+
+#endif
+
@@ -20,6 +20,8 @@
 #ifndef __I_TIMER__
 #define __I_TIMER__
 
+#include "doomtype.h"
+
 #define TICRATE 35
 
 // Called by D_DoomLoop,
@@ -29,6 +31,12 @@ int I_GetTime (void);
 // returns current time in ms
 int I_GetTimeMS (void);
 
+// Monotonic wall-clock time in nanoseconds, for measuring how long
+// things take.  Unlike I_GetTime this is never driven by the
+// platform's (possibly virtual) DG_GetTicksMs clock, except on
+// systems without a high-resolution clock.
+uint64_t I_GetTimeNS (void);
+
 // Pause for a specified number of ms
 void I_Sleep(int ms);
 
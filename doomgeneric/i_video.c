@@ -31,7 +31,9 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 #include "d_event.h"
 #include "d_main.h"
 #include "i_video.h"
+#include "i_swap.h"
 #include "i_system.h"
+#include "m_bbox.h"
 #include "z_zone.h"
 
 #include "tables.h"
@@ -48,6 +50,12 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 
 #include <sys/types.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 //#define CMAP256
 
 struct FB_BitField
@@ -72,19 +80,19 @@ struct FB_ScreenInfo
 	struct FB_BitField transp;	/* transparency			*/
 };
 
-static struct FB_ScreenInfo s_Fb;
-int fb_scaling = 1;
-int usemouse = 0;
+static DG_STATE struct FB_ScreenInfo s_Fb;
+DG_STATE int fb_scaling = 1;
+DG_STATE int usemouse = 0;
 
 
 #ifdef CMAP256
 
-boolean palette_changed;
-struct color colors[256];
+DG_STATE boolean palette_changed;
+DG_STATE struct color colors[256];
 
 #else  // CMAP256
 
-static struct color colors[256];
+static DG_STATE struct color colors[256];
 
 
 #endif  // CMAP256
@@ -94,16 +102,21 @@ void I_GetEvent(void);
 
 // The screen buffer; this is modified to draw things to the screen
 
-byte *I_VideoBuffer = NULL;
+DG_STATE byte *I_VideoBuffer = NULL;
+
+// Size of I_VideoBuffer
+
+DG_STATE int screenwidth;
+DG_STATE int screenheight;
 
 // If true, game is running as a screensaver
 
-boolean screensaver_mode = false;
+DG_STATE boolean screensaver_mode = false;
 
 // Flag indicating whether the screen is currently visible:
 // when the screen isnt visible, don't render the screen
 
-boolean screenvisible;
+DG_STATE boolean screenvisible;
 
 // Mouse acceleration
 //
@@ -114,12 +127,12 @@ boolean screenvisible;
 // the values exceed the value of mouse_threshold, they are multiplied
 // by mouse_acceleration to increase the speed.
 
-float mouse_acceleration = 2.0;
-int mouse_threshold = 10;
+DG_STATE float mouse_acceleration = 2.0;
+DG_STATE int mouse_threshold = 10;
 
 // Gamma correction level to use
 
-int usegamma = 0;
+DG_STATE int usegamma = 0;
 
 typedef struct
 {
@@ -153,32 +166,71 @@ void cmap_to_rgb565(uint16_t * out, uint8_t * in, int in_pixels)
     }
 }
 
-void cmap_to_fb(uint8_t *out, uint8_t *in, int in_pixels)
+// Palette converted to the framebuffer's pixel format by
+// I_SetPalette, so that converting a pixel is one table lookup.
+
+DG_STATE uint32_t fb_palette[256];
+
+#ifndef CMAP256
+
+// Colormaps given to I_SetColormaps, and the same colormaps with each
+// entry looked up in fb_palette.
+
+static DG_STATE const byte *fb_colormap_source;
+static DG_STATE int fb_colormap_count;
+DG_STATE uint32_t *fb_colormaps;
+
+static void I_BuildFbColormaps(void)
 {
-    int i, k;
+    const byte *in = fb_colormap_source;
+    uint32_t *out = fb_colormaps;
+    int i;
+
+    if (out == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < fb_colormap_count * 256; i++)
+    {
+        out[i] = fb_palette[in[i]];
+    }
+}
+
+void I_SetColormaps(const byte *colormaps, int num)
+{
+    fb_colormap_source = colormaps;
+    fb_colormap_count = num;
+    fb_colormaps = Z_Malloc(num * 256 * sizeof(*fb_colormaps),
+                            PU_STATIC, NULL);
+
+    I_BuildFbColormaps();
+}
+
+static void I_BuildFbPalette(void)
+{
+    int i;
     struct color c;
+    uint16_t p;
     uint32_t pix;
 
-    for (i = 0; i < in_pixels; i++)
+    for (i = 0; i < 256; i++)
     {
-        c = colors[*in];  // R:8 G:8 B:8
+        c = colors[i];  // R:8 G:8 B:8
 
         if (s_Fb.bits_per_pixel == 16)
         {
             // RGB565 packing
-            uint16_t p = ((c.r & 0xF8) << 8) |
-                         ((c.g & 0xFC) << 3) |
-                         (c.b >> 3);
+            p = ((c.r & 0xF8) << 8) |
+                ((c.g & 0xFC) << 3) |
+                (c.b >> 3);
 
 #ifdef SYS_BIG_ENDIAN
-            p = swapeLE16(p); // can't use SHORT() because this needs to stay unsigned
+            p = swapLE16(p); // can't use SHORT() because this needs to stay unsigned
 #endif
-            for (k = 0; k < fb_scaling; k++) {
-                *(uint16_t *)out = p;
-                out += 2;
-            }
+            fb_palette[i] = p;
         }
-        else if (s_Fb.bits_per_pixel == 32)
+        else
         {
             // Assuming RGBA8888
             pix = (c.r << s_Fb.red.offset) |
@@ -188,23 +240,386 @@ void cmap_to_fb(uint8_t *out, uint8_t *in, int in_pixels)
 #ifdef SYS_BIG_ENDIAN
             pix = swapLE32(pix);
 #endif
-            for (k = 0; k < fb_scaling; k++) {
-                *(uint32_t *)out = pix;
-                out += 4;
+            fb_palette[i] = pix;
+        }
+    }
+
+    I_BuildFbColormaps();
+}
+
+#endif  // CMAP256
+
+// Convert a line of 8-bit pixels to 32 bits per pixel, each
+// repeated fb_scaling times.  The common scales of 1 and 2 write
+// four or eight pixels at a time where SSE2 or AVX2 is available.
+
+static void cmap_to_fb32(uint32_t *out, const uint8_t *in, int in_pixels)
+{
+    const uint32_t *pal = fb_palette;
+    uint32_t pix;
+    int i, k;
+
+    i = 0;
+
+    if (fb_scaling == 1)
+    {
+#if defined(__AVX2__)
+        for (; i + 8 <= in_pixels; i += 8)
+        {
+            __m256i index = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *) (in + i)));
+
+            _mm256_storeu_si256((__m256i *) (out + i),
+                                _mm256_i32gather_epi32((const int *) pal,
+                                                       index, 4));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= in_pixels; i += 4)
+        {
+            _mm_storeu_si128((__m128i *) (out + i),
+                             _mm_setr_epi32(pal[in[i]], pal[in[i + 1]],
+                                            pal[in[i + 2]], pal[in[i + 3]]));
+        }
+#endif
+        for (; i < in_pixels; i++)
+        {
+            out[i] = pal[in[i]];
+        }
+    }
+    else if (fb_scaling == 2)
+    {
+#if defined(__AVX2__)
+        for (; i + 8 <= in_pixels; i += 8)
+        {
+            __m256i index = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *) (in + i)));
+            __m256i v = _mm256_i32gather_epi32((const int *) pal, index, 4);
+            __m256i lo = _mm256_unpacklo_epi32(v, v);
+            __m256i hi = _mm256_unpackhi_epi32(v, v);
+
+            _mm256_storeu_si256((__m256i *) (out + i * 2),
+                                _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i *) (out + i * 2 + 8),
+                                _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= in_pixels; i += 4)
+        {
+            __m128i v = _mm_setr_epi32(pal[in[i]], pal[in[i + 1]],
+                                       pal[in[i + 2]], pal[in[i + 3]]);
+
+            _mm_storeu_si128((__m128i *) (out + i * 2),
+                             _mm_unpacklo_epi32(v, v));
+            _mm_storeu_si128((__m128i *) (out + i * 2 + 4),
+                             _mm_unpackhi_epi32(v, v));
+        }
+#endif
+        for (; i < in_pixels; i++)
+        {
+            out[i * 2] = out[i * 2 + 1] = pal[in[i]];
+        }
+    }
+    else
+    {
+        for (; i < in_pixels; i++)
+        {
+            pix = pal[in[i]];
+
+            for (k = 0; k < fb_scaling; k++)
+            {
+                *out++ = pix;
             }
         }
-        else {
-            // no clue how to convert this
-            I_Error("No idea how to convert %d bpp pixels", s_Fb.bits_per_pixel);
+    }
+}
+
+// Same for 16 bits per pixel, eight pixels at a time.
+
+static void cmap_to_fb16(uint16_t *out, const uint8_t *in, int in_pixels)
+{
+    const uint32_t *pal = fb_palette;
+    uint16_t p;
+    int i, k;
+
+    i = 0;
+
+    if (fb_scaling == 1)
+    {
+#if defined(__SSE2__)
+        for (; i + 8 <= in_pixels; i += 8)
+        {
+            _mm_storeu_si128((__m128i *) (out + i),
+                             _mm_setr_epi16(pal[in[i]], pal[in[i + 1]],
+                                            pal[in[i + 2]], pal[in[i + 3]],
+                                            pal[in[i + 4]], pal[in[i + 5]],
+                                            pal[in[i + 6]], pal[in[i + 7]]));
+        }
+#endif
+        for (; i < in_pixels; i++)
+        {
+            out[i] = pal[in[i]];
+        }
+    }
+    else if (fb_scaling == 2)
+    {
+#if defined(__SSE2__)
+        for (; i + 8 <= in_pixels; i += 8)
+        {
+            __m128i v = _mm_setr_epi16(pal[in[i]], pal[in[i + 1]],
+                                       pal[in[i + 2]], pal[in[i + 3]],
+                                       pal[in[i + 4]], pal[in[i + 5]],
+                                       pal[in[i + 6]], pal[in[i + 7]]);
+
+            _mm_storeu_si128((__m128i *) (out + i * 2),
+                             _mm_unpacklo_epi16(v, v));
+            _mm_storeu_si128((__m128i *) (out + i * 2 + 8),
+                             _mm_unpackhi_epi16(v, v));
         }
+#endif
+        for (; i < in_pixels; i++)
+        {
+            out[i * 2] = out[i * 2 + 1] = pal[in[i]];
+        }
+    }
+    else
+    {
+        for (; i < in_pixels; i++)
+        {
+            p = pal[in[i]];
 
-        in++;
+            for (k = 0; k < fb_scaling; k++)
+            {
+                *out++ = p;
+            }
+        }
+    }
+}
+
+#ifndef CMAP256
+
+// With -truecolor, parts of the screen are drawn straight into
+// DG_ScreenBuffer: I_MarkTrueColor adds them to truecolorbox, and
+// I_FinishUpdate leaves them alone.
+
+DG_STATE boolean truecolor;
+DG_STATE int truecolorbox[4];
+
+void I_MarkTrueColor(int x, int y, int width, int height)
+{
+    M_AddToBox(truecolorbox, x, y);
+    M_AddToBox(truecolorbox, x + width - 1, y + height - 1);
+}
+
+void I_ReadScreenPixels(uint32_t *scr)
+{
+    cmap_to_fb32(scr, I_VideoBuffer, SCREENWIDTH * SCREENHEIGHT);
+}
+
+// Converts the screen around truecolorbox.  Truecolor needs the
+// screen to fill the framebuffer unscaled, see I_InitTrueColor.
+
+static void I_FinishTrueColor(void)
+{
+    byte *line_in;
+    uint32_t *line_out;
+    int left, right;
+    int y;
+
+    line_in = I_VideoBuffer;
+    line_out = DG_ScreenBuffer;
+
+    left = truecolorbox[BOXLEFT];
+    right = truecolorbox[BOXRIGHT] + 1;
+
+    for (y = 0; y < SCREENHEIGHT; y++)
+    {
+        if (y < truecolorbox[BOXBOTTOM] || y > truecolorbox[BOXTOP])
+        {
+            cmap_to_fb32(line_out, line_in, SCREENWIDTH);
+        }
+        else
+        {
+            cmap_to_fb32(line_out, line_in, left);
+            cmap_to_fb32(line_out + right, line_in + right,
+                         SCREENWIDTH - right);
+        }
+
+        line_in += SCREENWIDTH;
+        line_out += SCREENWIDTH;
+    }
+
+    M_ClearBox(truecolorbox);
+}
+
+static void I_InitTrueColor(void)
+{
+    //!
+    // @category video
+    //
+    // Draw the 3D view, and the menus and messages over it, straight
+    // into the framebuffer in truecolor, instead of converting them
+    // from palette indices.  Needs 32-bit pixels and a screen as big
+    // as the framebuffer; -columnmajor turns it off.
+    //
+
+    if (!M_CheckParm("-truecolor"))
+    {
+        return;
+    }
+
+    if (s_Fb.bits_per_pixel != 32 || fb_scaling != 1
+     || s_Fb.xres != SCREENWIDTH || s_Fb.yres != SCREENHEIGHT)
+    {
+        printf("I_InitTrueColor: -truecolor needs a 32-bit framebuffer "
+               "the size of the screen\n");
+        return;
+    }
+
+    truecolor = true;
+    M_ClearBox(truecolorbox);
+}
+
+#endif  // CMAP256
+
+void cmap_to_fb(uint8_t *out, uint8_t *in, int in_pixels)
+{
+    if (s_Fb.bits_per_pixel == 32)
+    {
+        cmap_to_fb32((uint32_t *) out, in, in_pixels);
+    }
+    else if (s_Fb.bits_per_pixel == 16)
+    {
+        cmap_to_fb16((uint16_t *) out, in, in_pixels);
+    }
+    else
+    {
+        // no clue how to convert this
+        I_Error("No idea how to convert %d bpp pixels", s_Fb.bits_per_pixel);
     }
 }
 
+#ifdef CMAP256
+
+// Copy a line of 8-bit pixels, each repeated fb_scaling times.
+
+static void I_ScaleLine8(uint8_t *out, const uint8_t *in, int in_pixels)
+{
+    int i, k;
+
+    i = 0;
+
+    if (fb_scaling == 1)
+    {
+        memcpy(out, in, in_pixels);
+        return;
+    }
+
+#if defined(__SSE2__)
+    if (fb_scaling == 2)
+    {
+        for (; i + 16 <= in_pixels; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *) (in + i));
+
+            _mm_storeu_si128((__m128i *) (out + i * 2),
+                             _mm_unpacklo_epi8(v, v));
+            _mm_storeu_si128((__m128i *) (out + i * 2 + 16),
+                             _mm_unpackhi_epi8(v, v));
+        }
+    }
+    else if (fb_scaling == 4)
+    {
+        for (; i + 16 <= in_pixels; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *) (in + i));
+            __m128i lo = _mm_unpacklo_epi8(v, v);
+            __m128i hi = _mm_unpackhi_epi8(v, v);
+
+            _mm_storeu_si128((__m128i *) (out + i * 4),
+                             _mm_unpacklo_epi16(lo, lo));
+            _mm_storeu_si128((__m128i *) (out + i * 4 + 16),
+                             _mm_unpackhi_epi16(lo, lo));
+            _mm_storeu_si128((__m128i *) (out + i * 4 + 32),
+                             _mm_unpacklo_epi16(hi, hi));
+            _mm_storeu_si128((__m128i *) (out + i * 4 + 48),
+                             _mm_unpackhi_epi16(hi, hi));
+        }
+    }
+#endif
+
+    for (; i < in_pixels; i++)
+    {
+        for (k = 0; k < fb_scaling; k++)
+        {
+            out[i * fb_scaling + k] = in[i];
+        }
+    }
+}
+
+#endif  // CMAP256
+
+//
+// I_InitScreenSize
+// The game draws at the size of the framebuffer, unless told to draw
+// at a fraction of it with -scaling and scale that up.
+//
+void I_InitScreenSize (void)
+{
+    int i;
+
+    //!
+    // @arg <n>
+    //
+    // Draw the screen at 1/n of the framebuffer size, and scale it up
+    // n times.
+    //
+
+    i = M_CheckParmWithArgs("-scaling", 1);
+
+    if (i > 0)
+    {
+        fb_scaling = atoi(myargv[i + 1]);
+
+        if (fb_scaling < 1)
+        {
+            fb_scaling = 1;
+        }
+    }
+    else
+    {
+        fb_scaling = 1;
+    }
+
+    screenwidth = DOOMGENERIC_RESX / fb_scaling;
+    screenheight = DOOMGENERIC_RESY / fb_scaling;
+
+    if (screenwidth > MAXWIDTH)
+    {
+        screenwidth = MAXWIDTH;
+    }
+
+    if (screenheight > MAXHEIGHT)
+    {
+        screenheight = MAXHEIGHT;
+    }
+
+    // Low detail mode draws two columns at a time.
+
+    screenwidth &= ~1;
+
+    if (screenwidth < ORIGWIDTH || screenheight < ORIGHEIGHT)
+    {
+        I_Error("I_InitScreenSize: %ix%i is smaller than %ix%i",
+                screenwidth, screenheight, ORIGWIDTH, ORIGHEIGHT);
+    }
+
+    printf("I_InitScreenSize: %ix%i, scaling factor %i\n",
+           screenwidth, screenheight, fb_scaling);
+}
+
 void I_InitGraphics (void)
 {
-    int i, gfxmodeparm;
+    int gfxmodeparm;
     char *mode;
 
 	memset(&s_Fb, 0, sizeof(struct FB_ScreenInfo));
@@ -262,6 +677,9 @@ void I_InitGraphics (void)
 		I_Error("Unknown gfxmode value: %s\n", mode);
 
 
+    I_BuildFbPalette();
+    I_InitTrueColor();
+
 #endif  // CMAP256
 
     printf("I_InitGraphics: framebuffer: x_res: %d, y_res: %d, x_virtual: %d, y_virtual: %d, bpp: %d\n",
@@ -273,19 +691,6 @@ void I_InitGraphics (void)
     printf("I_InitGraphics: DOOM screen size: w x h: %d x %d\n", SCREENWIDTH, SCREENHEIGHT);
 
 
-    i = M_CheckParmWithArgs("-scaling", 1);
-    if (i > 0) {
-        i = atoi(myargv[i + 1]);
-        fb_scaling = i;
-        printf("I_InitGraphics: Scaling factor: %d\n", fb_scaling);
-    } else {
-        fb_scaling = s_Fb.xres / SCREENWIDTH;
-        if (s_Fb.yres / SCREENHEIGHT < fb_scaling)
-            fb_scaling = s_Fb.yres / SCREENHEIGHT;
-        printf("I_InitGraphics: Auto-scaling factor: %d\n", fb_scaling);
-    }
-
-
     /* Allocate screen to draw to */
 	I_VideoBuffer = (byte*)Z_Malloc (SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);  // For DOOM to draw on
 
@@ -322,7 +727,17 @@ void I_FinishUpdate (void)
 {
     int y;
     int x_offset, y_offset, x_offset_end;
-    unsigned char *line_in, *line_out;
+    int line_len;
+    unsigned char *line_in, *line_out, *line_first;
+
+#ifndef CMAP256
+    if (truecolor)
+    {
+        I_FinishTrueColor();
+        DG_DrawFrame();
+        return;
+    }
+#endif
 
     /* Offsets in case FB is bigger than DOOM */
     /* 600 = s_Fb heigt, 200 screenheight */
@@ -337,31 +752,28 @@ void I_FinishUpdate (void)
     line_in  = (unsigned char *) I_VideoBuffer;
     line_out = (unsigned char *) DG_ScreenBuffer;
 
+    line_len = SCREENWIDTH * fb_scaling * (s_Fb.bits_per_pixel/8);
+
     y = SCREENHEIGHT;
 
     while (y--)
     {
         int i;
-        for (i = 0; i < fb_scaling; i++) {
-            line_out += x_offset;
+
+        // Convert the line once, then copy it for the other rows.
+        line_out += x_offset;
+        line_first = line_out;
 #ifdef CMAP256
-            if (fb_scaling == 1) {
-                memcpy(line_out, line_in, SCREENWIDTH); /* fb_width is bigger than Doom SCREENWIDTH... */
-            } else {
-                int j;
-
-                for (j = 0; j < SCREENWIDTH; j++) {
-                    int k;
-                    for (k = 0; k < fb_scaling; k++) {
-                        line_out[j * fb_scaling + k] = line_in[j];
-                    }
-                }
-            }
+        I_ScaleLine8(line_out, line_in, SCREENWIDTH);
 #else
-            //cmap_to_rgb565((void*)line_out, (void*)line_in, SCREENWIDTH);
-            cmap_to_fb((void*)line_out, (void*)line_in, SCREENWIDTH);
+        cmap_to_fb(line_out, line_in, SCREENWIDTH);
 #endif
-            line_out += (SCREENWIDTH * fb_scaling * (s_Fb.bits_per_pixel/8)) + x_offset_end;
+        line_out += line_len + x_offset_end;
+
+        for (i = 1; i < fb_scaling; i++) {
+            line_out += x_offset;
+            memcpy(line_out, line_first, line_len);
+            line_out += line_len + x_offset_end;
         }
         line_in += SCREENWIDTH;
     }
@@ -416,6 +828,10 @@ void I_SetPalette (byte* palette)
 
     palette_changed = true;
 
+#else  // CMAP256
+
+    I_BuildFbPalette();
+
 #endif  // CMAP256
 }
 
@@ -22,10 +22,22 @@
 
 #include "doomtype.h"
 
-// Screen width and height.
+// Screen size the game's graphics were drawn for.  The menus, status
+// bar and other 2D screens are laid out in these coordinates, and
+// v_video.c scales them up to the real screen.
 
-#define SCREENWIDTH  320
-#define SCREENHEIGHT 200
+#define ORIGWIDTH  320
+#define ORIGHEIGHT 200
+
+// Largest screen the renderer has room for.
+
+#define MAXWIDTH  2560
+#define MAXHEIGHT 1600
+
+// Screen width and height, chosen at startup by I_InitScreenSize.
+
+#define SCREENWIDTH  screenwidth
+#define SCREENHEIGHT screenheight
 
 // Screen width used for "squash" scale functions
 
@@ -91,6 +103,10 @@ typedef struct
 
 typedef boolean (*grabmouse_callback_t)(void);
 
+// Called by D_DoomMain before anything is allocated,
+// picks the size of the screen the game draws to.
+void I_InitScreenSize (void);
+
 // Called by D_DoomMain,
 // determines the hardware configuration
 // and sets up the video mode
@@ -147,14 +163,17 @@ struct color {
 
 
 extern char *video_driver;
-extern boolean screenvisible;
+extern DG_STATE boolean screenvisible;
+
+extern DG_STATE float mouse_acceleration;
+extern DG_STATE int mouse_threshold;
+extern DG_STATE int vanilla_keyboard_mapping;
+extern DG_STATE boolean screensaver_mode;
+extern DG_STATE int usegamma;
+extern DG_STATE byte *I_VideoBuffer;
 
-extern float mouse_acceleration;
-extern int mouse_threshold;
-extern int vanilla_keyboard_mapping;
-extern boolean screensaver_mode;
-extern int usegamma;
-extern byte *I_VideoBuffer;
+extern DG_STATE int screenwidth;
+extern DG_STATE int screenheight;
 
 extern int screen_width;
 extern int screen_height;
@@ -167,8 +186,34 @@ extern int diskicon_readbytes;
 
 #ifdef CMAP256
 
-extern boolean palette_changed;
-extern struct color colors[256];
+extern DG_STATE boolean palette_changed;
+extern DG_STATE struct color colors[256];
+
+#else  // CMAP256
+
+// Colormaps resolved to the framebuffer's pixel format (RGB565 values
+// in the low 16 bits with -gfxmode rgb565), so that a colormapped
+// pixel can be written to DG_ScreenBuffer without going through the
+// palette: fb_colormaps[i] is the pixel for palette index colormaps[i].
+// Rebuilt whenever the palette changes.
+
+void I_SetColormaps(const byte *colormaps, int num);
+
+extern DG_STATE uint32_t *fb_colormaps;
+extern DG_STATE uint32_t fb_palette[256];
+
+// With -truecolor, the parts of the screen marked with I_MarkTrueColor
+// since the last I_FinishUpdate are already in DG_ScreenBuffer, and
+// are not converted from I_VideoBuffer.
+
+extern DG_STATE boolean truecolor;
+extern DG_STATE int truecolorbox[4];
+
+void I_MarkTrueColor(int x, int y, int width, int height);
+
+// Converts the whole of I_VideoBuffer to pixels.
+
+void I_ReadScreenPixels(uint32_t *scr);
 
 #endif  // CMAP256
 
@@ -25,8 +25,8 @@
 //
 // MISC
 //
-extern  int	myargc;
-extern  char**	myargv;
+extern DG_STATE  int	myargc;
+extern DG_STATE  char**	myargv;
 
 // Returns the position of the given parameter
 // in the arg list (0 if not found).
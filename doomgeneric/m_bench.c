@@ -0,0 +1,444 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Demo benchmark.
+//
+//      Each demo is played back -benchreps times in timedemo mode
+//      (one tic per frame, no waiting).  For every frame the time
+//      spent in each benchsection_t is recorded; the frame that
+//      loads the level and the one in which the demo ends are left
+//      out.  When the last run finishes, per-demo statistics are
+//      written as JSON and the game quits.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomstat.h"
+#include "g_game.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "i_video.h"
+#include "m_argv.h"
+#include "m_misc.h"
+
+#include "m_bench.h"
+
+#define MAXBENCHDEMOS 32
+
+// Time spent in each section during one frame, in nanoseconds.
+
+typedef struct
+{
+    uint64_t ns[NUMBENCHSECTIONS];
+} benchframe_t;
+
+typedef struct
+{
+    int frames;
+    int tics;
+    uint64_t ns;
+} benchrun_t;
+
+typedef struct
+{
+    char name[9];
+    benchframe_t *frames;
+    int numframes;
+    int maxframes;
+    benchrun_t *runs;
+} benchdemo_t;
+
+static const char *section_names[NUMBENCHSECTIONS] =
+{
+    "frame",
+    "P_Ticker",
+    "D_Display",
+    "R_RenderPlayerView",
+    "I_FinishUpdate",
+};
+
+DG_STATE boolean benchmarking = false;
+
+static DG_STATE benchdemo_t bench_demos[MAXBENCHDEMOS];
+static DG_STATE int num_bench_demos = 0;
+static DG_STATE int bench_reps = 1;
+static DG_STATE char *bench_output = NULL;
+
+// Demo and repetition currently being played.
+
+static DG_STATE int current_demo;
+static DG_STATE int current_rep;
+
+// Set between M_BenchDemoStarted and M_BenchDemoFinished.
+
+static DG_STATE boolean run_active = false;
+static DG_STATE uint64_t run_start;
+static DG_STATE int run_starttic;
+static DG_STATE int run_frames;
+
+// The frame being timed.  frame_valid is cleared for frames that did
+// not run entirely inside a run.
+
+static DG_STATE boolean frame_valid = false;
+static DG_STATE uint64_t section_start[NUMBENCHSECTIONS];
+static DG_STATE benchframe_t frame_times;
+
+void M_BenchInit(void)
+{
+    int p;
+
+    //!
+    // @arg <n>
+    // @category demo
+    //
+    // With -benchmark, play each demo n times.  The default is 1.
+    //
+
+    p = M_CheckParmWithArgs("-benchreps", 1);
+
+    if (p > 0)
+    {
+        bench_reps = atoi(myargv[p + 1]);
+
+        if (bench_reps < 1)
+        {
+            I_Error("M_BenchInit: invalid -benchreps %s", myargv[p + 1]);
+        }
+    }
+
+    //!
+    // @arg <filename>
+    // @category demo
+    //
+    // With -benchmark, write the JSON report to the given file instead
+    // of to stdout.
+    //
+
+    p = M_CheckParmWithArgs("-benchout", 1);
+
+    if (p > 0)
+    {
+        bench_output = myargv[p + 1];
+    }
+}
+
+void M_BenchAddDemo(char *lumpname)
+{
+    benchdemo_t *demo;
+
+    if (num_bench_demos >= MAXBENCHDEMOS)
+    {
+        I_Error("M_BenchAddDemo: more than %i demos", MAXBENCHDEMOS);
+    }
+
+    demo = &bench_demos[num_bench_demos];
+    M_StringCopy(demo->name, lumpname, sizeof(demo->name));
+    demo->frames = NULL;
+    demo->numframes = 0;
+    demo->maxframes = 0;
+    demo->runs = calloc(bench_reps, sizeof(benchrun_t));
+
+    if (demo->runs == NULL)
+    {
+        I_Error("M_BenchAddDemo: out of memory");
+    }
+
+    ++num_bench_demos;
+}
+
+boolean M_BenchStart(void)
+{
+    if (num_bench_demos == 0)
+    {
+        return false;
+    }
+
+    benchmarking = true;
+    current_demo = 0;
+    current_rep = 0;
+
+    G_TimeDemo(bench_demos[0].name);
+
+    return true;
+}
+
+void M_BenchDemoStarted(void)
+{
+    if (!benchmarking)
+    {
+        return;
+    }
+
+    run_active = true;
+    run_frames = 0;
+    run_starttic = gametic;
+    run_start = I_GetTimeNS();
+}
+
+//
+// Statistics
+//
+
+static int CompareTimes(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array.
+
+static uint64_t Percentile(uint64_t *sorted, int n, int pct)
+{
+    int rank;
+
+    rank = (pct * n + 99) / 100;
+
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    return sorted[rank - 1];
+}
+
+static double NSToMS(uint64_t ns)
+{
+    return ns / 1000000.0;
+}
+
+static void WriteSectionStats(FILE *out, benchdemo_t *demo,
+                              benchsection_t section, uint64_t *times)
+{
+    uint64_t total;
+    int n;
+    int i;
+
+    n = demo->numframes;
+    total = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+        times[i] = demo->frames[i].ns[section];
+        total += times[i];
+    }
+
+    qsort(times, n, sizeof(*times), CompareTimes);
+
+    fprintf(out, "        \"%s\": { \"total_ms\": %.3f, \"mean_ms\": %.4f, "
+                 "\"median_ms\": %.4f, \"p95_ms\": %.4f, "
+                 "\"p99_ms\": %.4f, \"max_ms\": %.4f }",
+            section_names[section], NSToMS(total), NSToMS(total) / n,
+            NSToMS(Percentile(times, n, 50)),
+            NSToMS(Percentile(times, n, 95)),
+            NSToMS(Percentile(times, n, 99)),
+            NSToMS(times[n - 1]));
+}
+
+static void WriteDemo(FILE *out, benchdemo_t *demo)
+{
+    uint64_t *times;
+    uint64_t total_ns;
+    int total_frames;
+    int total_tics;
+    int i;
+
+    total_ns = 0;
+    total_frames = 0;
+    total_tics = 0;
+
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"demo\": \"%s\",\n", demo->name);
+    fprintf(out, "      \"runs\": [\n");
+
+    for (i = 0; i < bench_reps; ++i)
+    {
+        benchrun_t *run = &demo->runs[i];
+
+        fprintf(out, "        { \"frames\": %i, \"tics\": %i, "
+                     "\"seconds\": %.6f, \"fps\": %.3f }%s\n",
+                run->frames, run->tics, run->ns / 1e9,
+                run->ns > 0 ? run->frames * 1e9 / run->ns : 0.0,
+                i + 1 < bench_reps ? "," : "");
+
+        total_ns += run->ns;
+        total_frames += run->frames;
+        total_tics += run->tics;
+    }
+
+    fprintf(out, "      ],\n");
+    fprintf(out, "      \"frames\": %i,\n", total_frames);
+    fprintf(out, "      \"tics\": %i,\n", total_tics);
+    fprintf(out, "      \"seconds\": %.6f,\n", total_ns / 1e9);
+    fprintf(out, "      \"fps\": %.3f,\n",
+            total_ns > 0 ? total_frames * 1e9 / total_ns : 0.0);
+    fprintf(out, "      \"sections\": {");
+
+    if (demo->numframes > 0)
+    {
+        times = malloc(demo->numframes * sizeof(*times));
+
+        if (times == NULL)
+        {
+            I_Error("M_BenchDemoFinished: out of memory");
+        }
+
+        for (i = 0; i < NUMBENCHSECTIONS; ++i)
+        {
+            fprintf(out, "%s\n", i > 0 ? "," : "");
+            WriteSectionStats(out, demo, i, times);
+        }
+
+        free(times);
+        fprintf(out, "\n      ");
+    }
+
+    fprintf(out, "}\n");
+    fprintf(out, "    }");
+}
+
+static void WriteReport(void)
+{
+    FILE *out;
+    int i;
+
+    if (bench_output != NULL)
+    {
+        out = fopen(bench_output, "w");
+
+        if (out == NULL)
+        {
+            I_Error("M_BenchDemoFinished: unable to open %s", bench_output);
+        }
+    }
+    else
+    {
+        out = stdout;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"width\": %i,\n", SCREENWIDTH);
+    fprintf(out, "  \"height\": %i,\n", SCREENHEIGHT);
+    fprintf(out, "  \"repetitions\": %i,\n", bench_reps);
+    fprintf(out, "  \"demos\": [\n");
+
+    for (i = 0; i < num_bench_demos; ++i)
+    {
+        WriteDemo(out, &bench_demos[i]);
+        fprintf(out, "%s\n", i + 1 < num_bench_demos ? "," : "");
+    }
+
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    else
+    {
+        fflush(out);
+    }
+}
+
+void M_BenchDemoFinished(void)
+{
+    benchrun_t *run;
+
+    if (!run_active)
+    {
+        return;
+    }
+
+    run_active = false;
+
+    run = &bench_demos[current_demo].runs[current_rep];
+    run->frames = run_frames;
+    run->tics = gametic - run_starttic;
+    run->ns = I_GetTimeNS() - run_start;
+
+    ++current_rep;
+
+    if (current_rep >= bench_reps)
+    {
+        current_rep = 0;
+        ++current_demo;
+    }
+
+    if (current_demo < num_bench_demos)
+    {
+        G_TimeDemo(bench_demos[current_demo].name);
+        return;
+    }
+
+    WriteReport();
+    I_Quit();
+}
+
+//
+// Frame timing
+//
+
+static void AddFrame(benchdemo_t *demo)
+{
+    if (demo->numframes >= demo->maxframes)
+    {
+        demo->maxframes = demo->maxframes ? demo->maxframes * 2 : 4096;
+        demo->frames = realloc(demo->frames,
+                               demo->maxframes * sizeof(benchframe_t));
+
+        if (demo->frames == NULL)
+        {
+            I_Error("M_BenchEnd: out of memory");
+        }
+    }
+
+    demo->frames[demo->numframes++] = frame_times;
+}
+
+void M_BenchBegin(benchsection_t section)
+{
+    if (!benchmarking)
+    {
+        return;
+    }
+
+    if (section == bench_frame)
+    {
+        memset(&frame_times, 0, sizeof(frame_times));
+        frame_valid = run_active;
+    }
+
+    section_start[section] = I_GetTimeNS();
+}
+
+void M_BenchEnd(benchsection_t section)
+{
+    if (!benchmarking)
+    {
+        return;
+    }
+
+    frame_times.ns[section] += I_GetTimeNS() - section_start[section];
+
+    if (section == bench_frame && frame_valid && run_active)
+    {
+        AddFrame(&bench_demos[current_demo]);
+        ++run_frames;
+    }
+}
+
@@ -0,0 +1,70 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Demo benchmark: times a list of demos like -timedemo and
+//      reports per-frame statistics as JSON.
+//
+
+
+#ifndef __M_BENCH__
+#define __M_BENCH__
+
+#include "doomtype.h"
+
+// Parts of a frame that are timed separately.  Sections may nest:
+// the renderer and the blit both run inside D_Display, and all of
+// them inside bench_frame.
+
+typedef enum
+{
+    bench_frame,                // one whole doomgeneric_Tick
+    bench_ticker,               // P_Ticker
+    bench_display,              // D_Display
+    bench_render,               // R_RenderPlayerView
+    bench_finishupdate,         // I_FinishUpdate
+
+    NUMBENCHSECTIONS
+} benchsection_t;
+
+// True while a benchmark is running.
+
+extern DG_STATE boolean benchmarking;
+
+// Read -benchreps and -benchout.
+
+void M_BenchInit(void);
+
+// Add a demo lump to the list of demos to benchmark.
+
+void M_BenchAddDemo(char *lumpname);
+
+// Start the first benchmark run.  Returns false if no demos were
+// added, in which case there is nothing to do.
+
+boolean M_BenchStart(void);
+
+// Called by G_DoPlayDemo once the level is loaded, and by
+// G_CheckDemoStatus when the demo ends.  The latter starts the next
+// run, or writes the report and quits after the last one.
+
+void M_BenchDemoStarted(void);
+void M_BenchDemoFinished(void);
+
+// Time a section of the current frame.
+
+void M_BenchBegin(benchsection_t section);
+void M_BenchEnd(benchsection_t section);
+
+#endif
+
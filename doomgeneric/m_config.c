@@ -42,12 +42,12 @@
 // Location where all configuration data is stored - 
 // default.cfg, savegames, etc.
 
-char *configdir;
+DG_STATE char *configdir;
 
 // Default filenames for configuration files.
 
-static char *default_main_config;
-static char *default_extra_config;
+static DG_STATE char *default_main_config;
+static DG_STATE char *default_extra_config;
 
 typedef enum 
 {
@@ -108,7 +108,7 @@ typedef struct
 
 //! @begin_config_file default
 
-static default_t	doom_defaults_list[] =
+static DG_STATE default_t	doom_defaults_list[] =
 {
     //!
     // Mouse sensitivity.  This value is used to multiply input mouse
@@ -672,16 +672,20 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(comport),
 };
 
-static default_collection_t doom_defaults =
+// The lists are per-instance state, and an initializer cannot take the
+// address of that, so M_SetConfigFilenames points the collections at
+// them.
+
+static DG_STATE default_collection_t doom_defaults =
 {
-    doom_defaults_list,
+    NULL,
     arrlen(doom_defaults_list),
     NULL,
 };
 
 //! @begin_config_file extended
 
-static default_t extra_defaults_list[] =
+static DG_STATE default_t extra_defaults_list[] =
 {
     //!
     // @game heretic hexen strife
@@ -1551,9 +1555,9 @@ static default_t extra_defaults_list[] =
     CONFIG_VARIABLE_KEY(key_multi_msgplayer8),
 };
 
-static default_collection_t extra_defaults =
+static DG_STATE default_collection_t extra_defaults =
 {
-    extra_defaults_list,
+    NULL,
     arrlen(extra_defaults_list),
     NULL,
 };
@@ -1831,10 +1835,15 @@ static void LoadDefaultCollection(default_collection_t *collection)
 #endif
 }
 
-// Set the default filenames to use for configuration files.
+// Set the default filenames to use for configuration files.  This is
+// called before any variable is bound, so it also points the default
+// collections at their lists.
 
 void M_SetConfigFilenames(char *main_config, char *extra_config)
 {
+    doom_defaults.defaults = doom_defaults_list;
+    extra_defaults.defaults = extra_defaults_list;
+
     default_main_config = main_config;
     default_extra_config = extra_config;
 }
@@ -26,47 +26,47 @@
 // Keyboard controls
 //
 
-int key_right = KEY_RIGHTARROW;
-int key_left = KEY_LEFTARROW;
-int key_up = KEY_UPARROW;
-int key_down = KEY_DOWNARROW; 
-int key_strafeleft = KEY_STRAFE_L;
-int key_straferight = KEY_STRAFE_R;
-int key_fire = KEY_FIRE;
-int key_use = KEY_USE;
-int key_strafe = KEY_RALT;
-int key_speed = KEY_RSHIFT; 
+DG_STATE int key_right = KEY_RIGHTARROW;
+DG_STATE int key_left = KEY_LEFTARROW;
+DG_STATE int key_up = KEY_UPARROW;
+DG_STATE int key_down = KEY_DOWNARROW; 
+DG_STATE int key_strafeleft = KEY_STRAFE_L;
+DG_STATE int key_straferight = KEY_STRAFE_R;
+DG_STATE int key_fire = KEY_FIRE;
+DG_STATE int key_use = KEY_USE;
+DG_STATE int key_strafe = KEY_RALT;
+DG_STATE int key_speed = KEY_RSHIFT; 
 
 // 
 // Heretic keyboard controls
 //
  
-int key_flyup = KEY_PGUP;
-int key_flydown = KEY_INS;
-int key_flycenter = KEY_HOME;
+DG_STATE int key_flyup = KEY_PGUP;
+DG_STATE int key_flydown = KEY_INS;
+DG_STATE int key_flycenter = KEY_HOME;
 
-int key_lookup = KEY_PGDN;
-int key_lookdown = KEY_DEL;
-int key_lookcenter = KEY_END;
+DG_STATE int key_lookup = KEY_PGDN;
+DG_STATE int key_lookdown = KEY_DEL;
+DG_STATE int key_lookcenter = KEY_END;
 
-int key_invleft = '[';
-int key_invright = ']';
-int key_useartifact = KEY_ENTER;
+DG_STATE int key_invleft = '[';
+DG_STATE int key_invright = ']';
+DG_STATE int key_useartifact = KEY_ENTER;
 
 //
 // Hexen key controls
 //
 
-int key_jump = '/';
+DG_STATE int key_jump = '/';
 
-int key_arti_all             = KEY_BACKSPACE;
-int key_arti_health          = '\\';
-int key_arti_poisonbag       = '0';
-int key_arti_blastradius     = '9';
-int key_arti_teleport        = '8';
-int key_arti_teleportother   = '7';
-int key_arti_egg             = '6';
-int key_arti_invulnerability = '5';
+DG_STATE int key_arti_all             = KEY_BACKSPACE;
+DG_STATE int key_arti_health          = '\\';
+DG_STATE int key_arti_poisonbag       = '0';
+DG_STATE int key_arti_blastradius     = '9';
+DG_STATE int key_arti_teleport        = '8';
+DG_STATE int key_arti_teleportother   = '7';
+DG_STATE int key_arti_egg             = '6';
+DG_STATE int key_arti_invulnerability = '5';
 
 //
 // Strife key controls
@@ -77,125 +77,125 @@ int key_arti_invulnerability = '5';
 // Note: Strife also uses key_invleft, key_invright, key_jump, key_lookup, and
 // key_lookdown, but with different default values.
 
-int key_usehealth = 'h';
-int key_invquery  = 'q';
-int key_mission   = 'w';
-int key_invpop    = 'z';
-int key_invkey    = 'k';
-int key_invhome   = KEY_HOME;
-int key_invend    = KEY_END;
-int key_invuse    = KEY_ENTER;
-int key_invdrop   = KEY_BACKSPACE;
+DG_STATE int key_usehealth = 'h';
+DG_STATE int key_invquery  = 'q';
+DG_STATE int key_mission   = 'w';
+DG_STATE int key_invpop    = 'z';
+DG_STATE int key_invkey    = 'k';
+DG_STATE int key_invhome   = KEY_HOME;
+DG_STATE int key_invend    = KEY_END;
+DG_STATE int key_invuse    = KEY_ENTER;
+DG_STATE int key_invdrop   = KEY_BACKSPACE;
 
 
 //
 // Mouse controls
 //
 
-int mousebfire = 0;
-int mousebstrafe = 1;
-int mousebforward = 2;
+DG_STATE int mousebfire = 0;
+DG_STATE int mousebstrafe = 1;
+DG_STATE int mousebforward = 2;
 
-int mousebjump = -1;
+DG_STATE int mousebjump = -1;
 
-int mousebstrafeleft = -1;
-int mousebstraferight = -1;
-int mousebbackward = -1;
-int mousebuse = -1;
+DG_STATE int mousebstrafeleft = -1;
+DG_STATE int mousebstraferight = -1;
+DG_STATE int mousebbackward = -1;
+DG_STATE int mousebuse = -1;
 
-int mousebprevweapon = -1;
-int mousebnextweapon = -1;
+DG_STATE int mousebprevweapon = -1;
+DG_STATE int mousebnextweapon = -1;
 
 
-int key_message_refresh = KEY_ENTER;
-int key_pause = KEY_PAUSE;
-int key_demo_quit = 'q';
-int key_spy = KEY_F12;
+DG_STATE int key_message_refresh = KEY_ENTER;
+DG_STATE int key_pause = KEY_PAUSE;
+DG_STATE int key_demo_quit = 'q';
+DG_STATE int key_spy = KEY_F12;
 
 // Multiplayer chat keys:
 
-int key_multi_msg = 't';
-int key_multi_msgplayer[8];
+DG_STATE int key_multi_msg = 't';
+DG_STATE int key_multi_msgplayer[8];
 
 // Weapon selection keys:
 
-int key_weapon1 = '1';
-int key_weapon2 = '2';
-int key_weapon3 = '3';
-int key_weapon4 = '4';
-int key_weapon5 = '5';
-int key_weapon6 = '6';
-int key_weapon7 = '7';
-int key_weapon8 = '8';
-int key_prevweapon = 0;
-int key_nextweapon = 0;
+DG_STATE int key_weapon1 = '1';
+DG_STATE int key_weapon2 = '2';
+DG_STATE int key_weapon3 = '3';
+DG_STATE int key_weapon4 = '4';
+DG_STATE int key_weapon5 = '5';
+DG_STATE int key_weapon6 = '6';
+DG_STATE int key_weapon7 = '7';
+DG_STATE int key_weapon8 = '8';
+DG_STATE int key_prevweapon = 0;
+DG_STATE int key_nextweapon = 0;
 
 // Map control keys:
 
-int key_map_north     = KEY_UPARROW;
-int key_map_south     = KEY_DOWNARROW;
-int key_map_east      = KEY_RIGHTARROW;
-int key_map_west      = KEY_LEFTARROW;
-int key_map_zoomin    = '=';
-int key_map_zoomout   = '-';
-int key_map_toggle    = KEY_TAB;
-int key_map_maxzoom   = '0';
-int key_map_follow    = 'f';
-int key_map_grid      = 'g';
-int key_map_mark      = 'm';
-int key_map_clearmark = 'c';
+DG_STATE int key_map_north     = KEY_UPARROW;
+DG_STATE int key_map_south     = KEY_DOWNARROW;
+DG_STATE int key_map_east      = KEY_RIGHTARROW;
+DG_STATE int key_map_west      = KEY_LEFTARROW;
+DG_STATE int key_map_zoomin    = '=';
+DG_STATE int key_map_zoomout   = '-';
+DG_STATE int key_map_toggle    = KEY_TAB;
+DG_STATE int key_map_maxzoom   = '0';
+DG_STATE int key_map_follow    = 'f';
+DG_STATE int key_map_grid      = 'g';
+DG_STATE int key_map_mark      = 'm';
+DG_STATE int key_map_clearmark = 'c';
 
 // menu keys:
 
-int key_menu_activate  = KEY_ESCAPE;
-int key_menu_up        = KEY_UPARROW;
-int key_menu_down      = KEY_DOWNARROW;
-int key_menu_left      = KEY_LEFTARROW;
-int key_menu_right     = KEY_RIGHTARROW;
-int key_menu_back      = KEY_BACKSPACE;
-int key_menu_forward   = KEY_ENTER;
-int key_menu_confirm   = 'y';
-int key_menu_abort     = 'n';
-
-int key_menu_help      = KEY_F1;
-int key_menu_save      = KEY_F2;
-int key_menu_load      = KEY_F3;
-int key_menu_volume    = KEY_F4;
-int key_menu_detail    = KEY_F5;
-int key_menu_qsave     = KEY_F6;
-int key_menu_endgame   = KEY_F7;
-int key_menu_messages  = KEY_F8;
-int key_menu_qload     = KEY_F9;
-int key_menu_quit      = KEY_F10;
-int key_menu_gamma     = KEY_F11;
-
-int key_menu_incscreen = KEY_EQUALS;
-int key_menu_decscreen = KEY_MINUS;
-int key_menu_screenshot = 0;
+DG_STATE int key_menu_activate  = KEY_ESCAPE;
+DG_STATE int key_menu_up        = KEY_UPARROW;
+DG_STATE int key_menu_down      = KEY_DOWNARROW;
+DG_STATE int key_menu_left      = KEY_LEFTARROW;
+DG_STATE int key_menu_right     = KEY_RIGHTARROW;
+DG_STATE int key_menu_back      = KEY_BACKSPACE;
+DG_STATE int key_menu_forward   = KEY_ENTER;
+DG_STATE int key_menu_confirm   = 'y';
+DG_STATE int key_menu_abort     = 'n';
+
+DG_STATE int key_menu_help      = KEY_F1;
+DG_STATE int key_menu_save      = KEY_F2;
+DG_STATE int key_menu_load      = KEY_F3;
+DG_STATE int key_menu_volume    = KEY_F4;
+DG_STATE int key_menu_detail    = KEY_F5;
+DG_STATE int key_menu_qsave     = KEY_F6;
+DG_STATE int key_menu_endgame   = KEY_F7;
+DG_STATE int key_menu_messages  = KEY_F8;
+DG_STATE int key_menu_qload     = KEY_F9;
+DG_STATE int key_menu_quit      = KEY_F10;
+DG_STATE int key_menu_gamma     = KEY_F11;
+
+DG_STATE int key_menu_incscreen = KEY_EQUALS;
+DG_STATE int key_menu_decscreen = KEY_MINUS;
+DG_STATE int key_menu_screenshot = 0;
 
 //
 // Joystick controls
 //
 
-int joybfire = 0;
-int joybstrafe = 1;
-int joybuse = 3;
-int joybspeed = 2;
+DG_STATE int joybfire = 0;
+DG_STATE int joybstrafe = 1;
+DG_STATE int joybuse = 3;
+DG_STATE int joybspeed = 2;
 
-int joybstrafeleft = -1;
-int joybstraferight = -1;
+DG_STATE int joybstrafeleft = -1;
+DG_STATE int joybstraferight = -1;
 
-int joybjump = -1;
+DG_STATE int joybjump = -1;
 
-int joybprevweapon = -1;
-int joybnextweapon = -1;
+DG_STATE int joybprevweapon = -1;
+DG_STATE int joybnextweapon = -1;
 
-int joybmenu = -1;
+DG_STATE int joybmenu = -1;
 
 // Control whether if a mouse button is double clicked, it acts like 
 // "use" has been pressed
 
-int dclick_use = 1;
+DG_STATE int dclick_use = 1;
  
 // 
 // Bind all of the common controls used by Doom and all other games.
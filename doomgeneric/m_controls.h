@@ -16,142 +16,144 @@
 
 #ifndef __M_CONTROLS_H__
 #define __M_CONTROLS_H__
+
+#include "doomtype.h"
  
-extern int key_right;
-extern int key_left;
-
-extern int key_up;
-extern int key_down;
-extern int key_strafeleft;
-extern int key_straferight;
-extern int key_fire;
-extern int key_use;
-extern int key_strafe;
-extern int key_speed;
-
-extern int key_jump;
+extern DG_STATE int key_right;
+extern DG_STATE int key_left;
+
+extern DG_STATE int key_up;
+extern DG_STATE int key_down;
+extern DG_STATE int key_strafeleft;
+extern DG_STATE int key_straferight;
+extern DG_STATE int key_fire;
+extern DG_STATE int key_use;
+extern DG_STATE int key_strafe;
+extern DG_STATE int key_speed;
+
+extern DG_STATE int key_jump;
  
-extern int key_flyup;
-extern int key_flydown;
-extern int key_flycenter;
-extern int key_lookup;
-extern int key_lookdown;
-extern int key_lookcenter;
-extern int key_invleft;
-extern int key_invright;
-extern int key_useartifact;
+extern DG_STATE int key_flyup;
+extern DG_STATE int key_flydown;
+extern DG_STATE int key_flycenter;
+extern DG_STATE int key_lookup;
+extern DG_STATE int key_lookdown;
+extern DG_STATE int key_lookcenter;
+extern DG_STATE int key_invleft;
+extern DG_STATE int key_invright;
+extern DG_STATE int key_useartifact;
 
 // villsa [STRIFE] strife keys
-extern int key_usehealth;
-extern int key_invquery;
-extern int key_mission;
-extern int key_invpop;
-extern int key_invkey;
-extern int key_invhome;
-extern int key_invend;
-extern int key_invuse;
-extern int key_invdrop;
-
-extern int key_message_refresh;
-extern int key_pause;
-
-extern int key_multi_msg;
-extern int key_multi_msgplayer[8];
-
-extern int key_weapon1;
-extern int key_weapon2;
-extern int key_weapon3;
-extern int key_weapon4;
-extern int key_weapon5;
-extern int key_weapon6;
-extern int key_weapon7;
-extern int key_weapon8;
-
-extern int key_arti_all;
-extern int key_arti_health;
-extern int key_arti_poisonbag;
-extern int key_arti_blastradius;
-extern int key_arti_teleport;
-extern int key_arti_teleportother;
-extern int key_arti_egg;
-extern int key_arti_invulnerability;
-
-extern int key_demo_quit;
-extern int key_spy;
-extern int key_prevweapon;
-extern int key_nextweapon;
-
-extern int key_map_north;
-extern int key_map_south;
-extern int key_map_east;
-extern int key_map_west;
-extern int key_map_zoomin;
-extern int key_map_zoomout;
-extern int key_map_toggle;
-extern int key_map_maxzoom;
-extern int key_map_follow;
-extern int key_map_grid;
-extern int key_map_mark;
-extern int key_map_clearmark;
+extern DG_STATE int key_usehealth;
+extern DG_STATE int key_invquery;
+extern DG_STATE int key_mission;
+extern DG_STATE int key_invpop;
+extern DG_STATE int key_invkey;
+extern DG_STATE int key_invhome;
+extern DG_STATE int key_invend;
+extern DG_STATE int key_invuse;
+extern DG_STATE int key_invdrop;
+
+extern DG_STATE int key_message_refresh;
+extern DG_STATE int key_pause;
+
+extern DG_STATE int key_multi_msg;
+extern DG_STATE int key_multi_msgplayer[8];
+
+extern DG_STATE int key_weapon1;
+extern DG_STATE int key_weapon2;
+extern DG_STATE int key_weapon3;
+extern DG_STATE int key_weapon4;
+extern DG_STATE int key_weapon5;
+extern DG_STATE int key_weapon6;
+extern DG_STATE int key_weapon7;
+extern DG_STATE int key_weapon8;
+
+extern DG_STATE int key_arti_all;
+extern DG_STATE int key_arti_health;
+extern DG_STATE int key_arti_poisonbag;
+extern DG_STATE int key_arti_blastradius;
+extern DG_STATE int key_arti_teleport;
+extern DG_STATE int key_arti_teleportother;
+extern DG_STATE int key_arti_egg;
+extern DG_STATE int key_arti_invulnerability;
+
+extern DG_STATE int key_demo_quit;
+extern DG_STATE int key_spy;
+extern DG_STATE int key_prevweapon;
+extern DG_STATE int key_nextweapon;
+
+extern DG_STATE int key_map_north;
+extern DG_STATE int key_map_south;
+extern DG_STATE int key_map_east;
+extern DG_STATE int key_map_west;
+extern DG_STATE int key_map_zoomin;
+extern DG_STATE int key_map_zoomout;
+extern DG_STATE int key_map_toggle;
+extern DG_STATE int key_map_maxzoom;
+extern DG_STATE int key_map_follow;
+extern DG_STATE int key_map_grid;
+extern DG_STATE int key_map_mark;
+extern DG_STATE int key_map_clearmark;
 
 // menu keys:
 
-extern int key_menu_activate;
-extern int key_menu_up;
-extern int key_menu_down;
-extern int key_menu_left;
-extern int key_menu_right;
-extern int key_menu_back;
-extern int key_menu_forward;
-extern int key_menu_confirm;
-extern int key_menu_abort;
-
-extern int key_menu_help;
-extern int key_menu_save;
-extern int key_menu_load;
-extern int key_menu_volume;
-extern int key_menu_detail;
-extern int key_menu_qsave;
-extern int key_menu_endgame;
-extern int key_menu_messages;
-extern int key_menu_qload;
-extern int key_menu_quit;
-extern int key_menu_gamma;
-
-extern int key_menu_incscreen;
-extern int key_menu_decscreen;
-extern int key_menu_screenshot;
-
-extern int mousebfire;
-extern int mousebstrafe;
-extern int mousebforward;
-
-extern int mousebjump;
-
-extern int mousebstrafeleft;
-extern int mousebstraferight;
-extern int mousebbackward;
-extern int mousebuse;
-
-extern int mousebprevweapon;
-extern int mousebnextweapon;
-
-extern int joybfire;
-extern int joybstrafe;
-extern int joybuse;
-extern int joybspeed;
-
-extern int joybjump;
-
-extern int joybstrafeleft;
-extern int joybstraferight;
-
-extern int joybprevweapon;
-extern int joybnextweapon;
-
-extern int joybmenu;
-
-extern int dclick_use;
+extern DG_STATE int key_menu_activate;
+extern DG_STATE int key_menu_up;
+extern DG_STATE int key_menu_down;
+extern DG_STATE int key_menu_left;
+extern DG_STATE int key_menu_right;
+extern DG_STATE int key_menu_back;
+extern DG_STATE int key_menu_forward;
+extern DG_STATE int key_menu_confirm;
+extern DG_STATE int key_menu_abort;
+
+extern DG_STATE int key_menu_help;
+extern DG_STATE int key_menu_save;
+extern DG_STATE int key_menu_load;
+extern DG_STATE int key_menu_volume;
+extern DG_STATE int key_menu_detail;
+extern DG_STATE int key_menu_qsave;
+extern DG_STATE int key_menu_endgame;
+extern DG_STATE int key_menu_messages;
+extern DG_STATE int key_menu_qload;
+extern DG_STATE int key_menu_quit;
+extern DG_STATE int key_menu_gamma;
+
+extern DG_STATE int key_menu_incscreen;
+extern DG_STATE int key_menu_decscreen;
+extern DG_STATE int key_menu_screenshot;
+
+extern DG_STATE int mousebfire;
+extern DG_STATE int mousebstrafe;
+extern DG_STATE int mousebforward;
+
+extern DG_STATE int mousebjump;
+
+extern DG_STATE int mousebstrafeleft;
+extern DG_STATE int mousebstraferight;
+extern DG_STATE int mousebbackward;
+extern DG_STATE int mousebuse;
+
+extern DG_STATE int mousebprevweapon;
+extern DG_STATE int mousebnextweapon;
+
+extern DG_STATE int joybfire;
+extern DG_STATE int joybstrafe;
+extern DG_STATE int joybuse;
+extern DG_STATE int joybspeed;
+
+extern DG_STATE int joybjump;
+
+extern DG_STATE int joybstrafeleft;
+extern DG_STATE int joybstraferight;
+
+extern DG_STATE int joybprevweapon;
+extern DG_STATE int joybnextweapon;
+
+extern DG_STATE int joybmenu;
+
+extern DG_STATE int dclick_use;
 
 void M_BindBaseControls(void);
 void M_BindHereticControls(void);
@@ -59,44 +59,44 @@
 #include "m_menu.h"
 
 
-extern patch_t*		hu_font[HU_FONTSIZE];
-extern boolean		message_dontfuckwithme;
+extern DG_STATE patch_t*		hu_font[HU_FONTSIZE];
+extern DG_STATE boolean		message_dontfuckwithme;
 
-extern boolean		chat_on;		// in heads-up code
+extern DG_STATE boolean		chat_on;		// in heads-up code
 
 //
 // defaulted values
 //
-int			mouseSensitivity = 5;
+DG_STATE int			mouseSensitivity = 5;
 
 // Show messages has default, 0 = off, 1 = on
-int			showMessages = 1;
+DG_STATE int			showMessages = 1;
 	
 
 // Blocky mode, has default, 0 = high, 1 = normal
-int			detailLevel = 0;
-int			screenblocks = 10;
+DG_STATE int			detailLevel = 0;
+DG_STATE int			screenblocks = 10;
 
 // temp for screenblocks (0-9)
-int			screenSize;
+DG_STATE int			screenSize;
 
 // -1 = no quicksave slot picked!
-int			quickSaveSlot;
+DG_STATE int			quickSaveSlot;
 
  // 1 = message to be printed
-int			messageToPrint;
+DG_STATE int			messageToPrint;
 // ...and here is the message string!
-char*			messageString;
+DG_STATE char*			messageString;
 
 // message x & y
-int			messx;
-int			messy;
-int			messageLastMenuActive;
+DG_STATE int			messx;
+DG_STATE int			messy;
+DG_STATE int			messageLastMenuActive;
 
 // timed message = no input from user
-boolean			messageNeedsInput;
+DG_STATE boolean			messageNeedsInput;
 
-void    (*messageRoutine)(int response);
+DG_STATE void    (*messageRoutine)(int response);
 
 char gammamsg[5][26] =
 {
@@ -108,22 +108,22 @@ char gammamsg[5][26] =
 };
 
 // we are going to be entering a savegame string
-int			saveStringEnter;              
-int             	saveSlot;	// which slot to save in
-int			saveCharIndex;	// which char we're editing
+DG_STATE int			saveStringEnter;              
+DG_STATE int             	saveSlot;	// which slot to save in
+DG_STATE int			saveCharIndex;	// which char we're editing
 // old save description before edit
-char			saveOldString[SAVESTRINGSIZE];  
+DG_STATE char			saveOldString[SAVESTRINGSIZE];  
 
-boolean			inhelpscreens;
-boolean			menuactive;
+DG_STATE boolean			inhelpscreens;
+DG_STATE boolean			menuactive;
 
 #define SKULLXOFF		-32
 #define LINEHEIGHT		16
 
-extern boolean		sendpause;
-char			savegamestrings[10][SAVESTRINGSIZE];
+extern DG_STATE boolean		sendpause;
+DG_STATE char			savegamestrings[10][SAVESTRINGSIZE];
 
-char	endstring[160];
+DG_STATE char	endstring[160];
 
 //static boolean opldev;
 
@@ -159,16 +159,16 @@ typedef struct menu_s
     short		lastOn;		// last item user was on in menu
 } menu_t;
 
-short		itemOn;			// menu item skull is on
-short		skullAnimCounter;	// skull animation counter
-short		whichSkull;		// which skull to draw
+DG_STATE short		itemOn;			// menu item skull is on
+DG_STATE short		skullAnimCounter;	// skull animation counter
+DG_STATE short		whichSkull;		// which skull to draw
 
 // graphic name of skulls
 // warning: initializer-string for array of chars is too long
 char    *skullName[2] = {"M_SKULL1","M_SKULL2"};
 
 // current menudef
-menu_t*	currentMenu;                          
+DG_STATE menu_t*	currentMenu;                          
 
 //
 // PROTOTYPES
@@ -237,9 +237,9 @@ enum
     readthis,
     quitdoom,
     main_end
-} main_e;
+} DG_STATE main_e;
 
-menuitem_t MainMenu[]=
+DG_STATE menuitem_t MainMenu[]=
 {
     {1,"M_NGAME",M_NewGame,'n'},
     {1,"M_OPTION",M_Options,'o'},
@@ -250,11 +250,11 @@ menuitem_t MainMenu[]=
     {1,"M_QUITG",M_QuitDOOM,'q'}
 };
 
-menu_t  MainDef =
+DG_STATE menu_t  MainDef =
 {
     main_end,
     NULL,
-    MainMenu,
+    NULL,		// see M_LinkMenus
     M_DrawMainMenu,
     97,64,
     0
@@ -271,9 +271,9 @@ enum
     ep3,
     ep4,
     ep_end
-} episodes_e;
+} DG_STATE episodes_e;
 
-menuitem_t EpisodeMenu[]=
+DG_STATE menuitem_t EpisodeMenu[]=
 {
     {1,"M_EPI1", M_Episode,'k'},
     {1,"M_EPI2", M_Episode,'t'},
@@ -281,11 +281,11 @@ menuitem_t EpisodeMenu[]=
     {1,"M_EPI4", M_Episode,'t'}
 };
 
-menu_t  EpiDef =
+DG_STATE menu_t  EpiDef =
 {
     ep_end,		// # of menu items
-    &MainDef,		// previous menu
-    EpisodeMenu,	// menuitem_t ->
+    NULL,		// previous menu, see M_LinkMenus
+    NULL,		// menuitem_t ->, see M_LinkMenus
     M_DrawEpisode,	// drawing routine ->
     48,63,              // x,y
     ep1			// lastOn
@@ -302,9 +302,9 @@ enum
     violence,
     nightmare,
     newg_end
-} newgame_e;
+} DG_STATE newgame_e;
 
-menuitem_t NewGameMenu[]=
+DG_STATE menuitem_t NewGameMenu[]=
 {
     {1,"M_JKILL",	M_ChooseSkill, 'i'},
     {1,"M_ROUGH",	M_ChooseSkill, 'h'},
@@ -313,11 +313,11 @@ menuitem_t NewGameMenu[]=
     {1,"M_NMARE",	M_ChooseSkill, 'n'}
 };
 
-menu_t  NewDef =
+DG_STATE menu_t  NewDef =
 {
     newg_end,		// # of menu items
-    &EpiDef,		// previous menu
-    NewGameMenu,	// menuitem_t ->
+    NULL,		// previous menu, see M_LinkMenus
+    NULL,		// menuitem_t ->, see M_LinkMenus
     M_DrawNewGame,	// drawing routine ->
     48,63,              // x,y
     hurtme		// lastOn
@@ -339,9 +339,9 @@ enum
     option_empty2,
     soundvol,
     opt_end
-} options_e;
+} DG_STATE options_e;
 
-menuitem_t OptionsMenu[]=
+DG_STATE menuitem_t OptionsMenu[]=
 {
     {1,"M_ENDGAM",	M_EndGame,'e'},
     {1,"M_MESSG",	M_ChangeMessages,'m'},
@@ -353,11 +353,11 @@ menuitem_t OptionsMenu[]=
     {1,"M_SVOL",	M_Sound,'s'}
 };
 
-menu_t  OptionsDef =
+DG_STATE menu_t  OptionsDef =
 {
     opt_end,
-    &MainDef,
-    OptionsMenu,
+    NULL,		// see M_LinkMenus
+    NULL,		// see M_LinkMenus
     M_DrawOptions,
     60,37,
     0
@@ -370,18 +370,18 @@ enum
 {
     rdthsempty1,
     read1_end
-} read_e;
+} DG_STATE read_e;
 
-menuitem_t ReadMenu1[] =
+DG_STATE menuitem_t ReadMenu1[] =
 {
     {1,"",M_ReadThis2,0}
 };
 
-menu_t  ReadDef1 =
+DG_STATE menu_t  ReadDef1 =
 {
     read1_end,
-    &MainDef,
-    ReadMenu1,
+    NULL,		// see M_LinkMenus
+    NULL,		// see M_LinkMenus
     M_DrawReadThis1,
     280,185,
     0
@@ -391,18 +391,18 @@ enum
 {
     rdthsempty2,
     read2_end
-} read_e2;
+} DG_STATE read_e2;
 
-menuitem_t ReadMenu2[]=
+DG_STATE menuitem_t ReadMenu2[]=
 {
     {1,"",M_FinishReadThis,0}
 };
 
-menu_t  ReadDef2 =
+DG_STATE menu_t  ReadDef2 =
 {
     read2_end,
-    &ReadDef1,
-    ReadMenu2,
+    NULL,		// see M_LinkMenus
+    NULL,		// see M_LinkMenus
     M_DrawReadThis2,
     330,175,
     0
@@ -418,9 +418,9 @@ enum
     music_vol,
     sfx_empty2,
     sound_end
-} sound_e;
+} DG_STATE sound_e;
 
-menuitem_t SoundMenu[]=
+DG_STATE menuitem_t SoundMenu[]=
 {
     {2,"M_SFXVOL",M_SfxVol,'s'},
     {-1,"",0,'\0'},
@@ -428,11 +428,11 @@ menuitem_t SoundMenu[]=
     {-1,"",0,'\0'}
 };
 
-menu_t  SoundDef =
+DG_STATE menu_t  SoundDef =
 {
     sound_end,
-    &OptionsDef,
-    SoundMenu,
+    NULL,		// see M_LinkMenus
+    NULL,		// see M_LinkMenus
     M_DrawSound,
     80,64,
     0
@@ -450,9 +450,9 @@ enum
     load5,
     load6,
     load_end
-} load_e;
+} DG_STATE load_e;
 
-menuitem_t LoadMenu[]=
+DG_STATE menuitem_t LoadMenu[]=
 {
     {1,"", M_LoadSelect,'1'},
     {1,"", M_LoadSelect,'2'},
@@ -462,11 +462,11 @@ menuitem_t LoadMenu[]=
     {1,"", M_LoadSelect,'6'}
 };
 
-menu_t  LoadDef =
+DG_STATE menu_t  LoadDef =
 {
     load_end,
-    &MainDef,
-    LoadMenu,
+    NULL,		// see M_LinkMenus
+    NULL,		// see M_LinkMenus
     M_DrawLoad,
     80,54,
     0
@@ -475,7 +475,7 @@ menu_t  LoadDef =
 //
 // SAVE GAME MENU
 //
-menuitem_t SaveMenu[]=
+DG_STATE menuitem_t SaveMenu[]=
 {
     {1,"", M_SaveSelect,'1'},
     {1,"", M_SaveSelect,'2'},
@@ -485,11 +485,11 @@ menuitem_t SaveMenu[]=
     {1,"", M_SaveSelect,'6'}
 };
 
-menu_t  SaveDef =
+DG_STATE menu_t  SaveDef =
 {
     load_end,
-    &MainDef,
-    SaveMenu,
+    NULL,		// see M_LinkMenus
+    NULL,		// see M_LinkMenus
     M_DrawSave,
     80,54,
     0
@@ -667,7 +667,7 @@ void M_SaveGame (int choice)
 //
 //      M_QuickSave
 //
-char    tempstring[80];
+DG_STATE char    tempstring[80];
 
 void M_QuickSaveResponse(int key)
 {
@@ -925,7 +925,7 @@ void M_NewGame(int choice)
 //
 //      M_Episode
 //
-int     epi;
+DG_STATE int     epi;
 
 void M_DrawEpisode(void)
 {
@@ -1390,7 +1390,7 @@ M_WriteText
 	}
 		
 	w = SHORT (hu_font[c]->width);
-	if (cx+w > SCREENWIDTH)
+	if (cx+w > ORIGWIDTH)
 	    break;
 	V_DrawPatchDirect(cx, cy, hu_font[c]);
 	cx+=w;
@@ -1418,12 +1418,12 @@ boolean M_Responder (event_t* ev)
     int             ch;
     int             key;
     int             i;
-    static  int     joywait = 0;
-    static  int     mousewait = 0;
-    static  int     mousey = 0;
-    static  int     lasty = 0;
-    static  int     mousex = 0;
-    static  int     lastx = 0;
+    static DG_STATE  int     joywait = 0;
+    static DG_STATE  int     mousewait = 0;
+    static DG_STATE  int     mousey = 0;
+    static DG_STATE  int     lasty = 0;
+    static DG_STATE  int     mousex = 0;
+    static DG_STATE  int     lastx = 0;
 
     // In testcontrols mode, none of the function keys should do anything
     // - the only key is escape to quit.
@@ -1950,8 +1950,8 @@ static void M_DrawOPLDev(void)
 //
 void M_Drawer (void)
 {
-    static short	x;
-    static short	y;
+    static DG_STATE short	x;
+    static DG_STATE short	y;
     unsigned int	i;
     unsigned int	max;
     char		string[80];
@@ -1964,7 +1964,7 @@ void M_Drawer (void)
     if (messageToPrint)
     {
 	start = 0;
-	y = SCREENHEIGHT/2 - M_StringHeight(messageString) / 2;
+	y = ORIGHEIGHT/2 - M_StringHeight(messageString) / 2;
 	while (messageString[start] != '\0')
 	{
 	    int foundnewline = 0;
@@ -1992,7 +1992,7 @@ void M_Drawer (void)
                 start += strlen(string);
             }
 
-	    x = SCREENWIDTH/2 - M_StringWidth(string) / 2;
+	    x = ORIGWIDTH/2 - M_StringWidth(string) / 2;
 	    M_WriteText(x, y, string);
 	    y += SHORT(hu_font[0]->height);
 	}
@@ -2071,11 +2071,39 @@ void M_Ticker (void)
 }
 
 
+//
+// M_LinkMenus
+// The menus are per-instance state, and an initializer cannot take
+//  the address of that, so the links between them are made here.
+//
+static void M_LinkMenus (void)
+{
+    MainDef.menuitems = MainMenu;
+    EpiDef.prevMenu = &MainDef;
+    EpiDef.menuitems = EpisodeMenu;
+    NewDef.prevMenu = &EpiDef;
+    NewDef.menuitems = NewGameMenu;
+    OptionsDef.prevMenu = &MainDef;
+    OptionsDef.menuitems = OptionsMenu;
+    ReadDef1.prevMenu = &MainDef;
+    ReadDef1.menuitems = ReadMenu1;
+    ReadDef2.prevMenu = &ReadDef1;
+    ReadDef2.menuitems = ReadMenu2;
+    SoundDef.prevMenu = &OptionsDef;
+    SoundDef.menuitems = SoundMenu;
+    LoadDef.prevMenu = &MainDef;
+    LoadDef.menuitems = LoadMenu;
+    SaveDef.prevMenu = &MainDef;
+    SaveDef.menuitems = SaveMenu;
+}
+
 //
 // M_Init
 //
 void M_Init (void)
 {
+    M_LinkMenus ();
+
     currentMenu = &MainDef;
     menuactive = 0;
     itemOn = currentMenu->lastOn;
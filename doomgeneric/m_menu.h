@@ -53,8 +53,8 @@ void M_StartControlPanel (void);
 
 
 
-extern int detailLevel;
-extern int screenblocks;
+extern DG_STATE int detailLevel;
+extern DG_STATE int screenblocks;
 
 
 
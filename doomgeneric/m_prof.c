@@ -0,0 +1,290 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Hot-path profiling.
+//
+//      Every PROF_BEGIN/PROF_END pair adds one event to a ring
+//      buffer; every frame adds one more, carrying the counters for
+//      that frame and the map being played.  Once a ring is full the
+//      oldest entries are overwritten, so the trace always covers the
+//      last PROFEVENTS zone events and PROFFRAMES frames.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i_system.h"
+#include "m_argv.h"
+
+#include "m_prof.h"
+
+#ifdef PROFILING
+
+#include "i_timer.h"
+#include "m_misc.h"
+
+#define PROFEVENTS 65536
+#define PROFFRAMES 8192
+
+typedef struct
+{
+    uint64_t start;
+    uint64_t duration;
+    profzone_t zone;
+} profevent_t;
+
+typedef struct
+{
+    uint64_t start;
+    uint64_t duration;
+    char map[9];
+    int counters[NUMPROFCOUNTERS];
+} profframe_t;
+
+static const char *zone_names[NUMPROFZONES] =
+{
+    "frame",
+    "R_RenderBSPNode",
+    "R_DrawPlanes",
+    "R_DrawMasked",
+    "P_RunThinkers",
+};
+
+static const char *counter_names[NUMPROFCOUNTERS] =
+{
+    "nodes",
+    "segs",
+    "visplanes",
+    "spans",
+    "vissprites",
+    "drawsegs_scanned",
+    "thinkers_mobj",
+    "thinkers_ceiling",
+    "thinkers_door",
+    "thinkers_floor",
+    "thinkers_plat",
+    "thinkers_light",
+    "thinkers_other",
+    "thinkers_removed",
+    "zmallocs",
+    "rover_steps",
+    "composites",
+};
+
+DG_STATE int prof_counters[NUMPROFCOUNTERS];
+
+static DG_STATE profevent_t *events = NULL;
+static DG_STATE unsigned int num_events = 0;
+static DG_STATE profframe_t *frames = NULL;
+static DG_STATE unsigned int num_frames = 0;
+
+static DG_STATE uint64_t zone_start[NUMPROFZONES];
+static DG_STATE char current_map[9];
+static DG_STATE char *trace_filename = NULL;
+
+static void WriteTraceAtExit(void)
+{
+    if (M_ProfWriteTrace(trace_filename))
+    {
+        printf("M_ProfWriteTrace: wrote %s\n", trace_filename);
+    }
+}
+
+void M_ProfInit(void)
+{
+    int p;
+
+    events = malloc(PROFEVENTS * sizeof(*events));
+    frames = malloc(PROFFRAMES * sizeof(*frames));
+
+    if (events == NULL || frames == NULL)
+    {
+        I_Error("M_ProfInit: out of memory");
+    }
+
+    //!
+    // @arg <filename>
+    //
+    // Profiling builds: on exit, write the timings and counters of
+    // the last frames to the given file as Chrome trace-event JSON.
+    //
+
+    p = M_CheckParmWithArgs("-proftrace", 1);
+
+    if (p > 0)
+    {
+        trace_filename = myargv[p + 1];
+        I_AtExit(WriteTraceAtExit, true);
+    }
+}
+
+void M_ProfBegin(profzone_t zone)
+{
+    zone_start[zone] = I_GetTimeNS();
+}
+
+void M_ProfEnd(profzone_t zone)
+{
+    uint64_t now;
+    profevent_t *event;
+    profframe_t *frame;
+
+    if (events == NULL)
+    {
+        return;
+    }
+
+    now = I_GetTimeNS();
+
+    if (zone != prof_frame)
+    {
+        event = &events[num_events % PROFEVENTS];
+        event->start = zone_start[zone];
+        event->duration = now - zone_start[zone];
+        event->zone = zone;
+        ++num_events;
+        return;
+    }
+
+    frame = &frames[num_frames % PROFFRAMES];
+    frame->start = zone_start[zone];
+    frame->duration = now - zone_start[zone];
+    memcpy(frame->map, current_map, sizeof(frame->map));
+    memcpy(frame->counters, prof_counters, sizeof(prof_counters));
+    ++num_frames;
+
+    memset(prof_counters, 0, sizeof(prof_counters));
+}
+
+void M_ProfSetMap(char *name)
+{
+    M_StringCopy(current_map, name, sizeof(current_map));
+}
+
+//
+// Chrome trace output
+//
+
+static void WriteFrame(FILE *out, profframe_t *frame, uint64_t base)
+{
+    double ts;
+    int i;
+
+    ts = (frame->start - base) / 1000.0;
+
+    fprintf(out, "{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                 "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"map\":\"%s\"",
+            ts, frame->duration / 1000.0, frame->map);
+
+    for (i = 0; i < NUMPROFCOUNTERS; ++i)
+    {
+        fprintf(out, ",\"%s\":%i", counter_names[i], frame->counters[i]);
+    }
+
+    fprintf(out, "}},\n");
+
+    // The same counters again as counter events, so that they are
+    // drawn as graphs.
+
+    fprintf(out, "{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,"
+                 "\"ts\":%.3f,\"args\":{", ts);
+
+    for (i = 0; i < NUMPROFCOUNTERS; ++i)
+    {
+        fprintf(out, "%s\"%s\":%i", i > 0 ? "," : "",
+                counter_names[i], frame->counters[i]);
+    }
+
+    fprintf(out, "}}");
+}
+
+boolean M_ProfWriteTrace(char *filename)
+{
+    FILE *out;
+    unsigned int first_event, first_frame;
+    unsigned int i;
+    uint64_t base;
+    boolean comma;
+
+    if (events == NULL)
+    {
+        return false;
+    }
+
+    out = fopen(filename, "w");
+
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    first_event = num_events > PROFEVENTS ? num_events - PROFEVENTS : 0;
+    first_frame = num_frames > PROFFRAMES ? num_frames - PROFFRAMES : 0;
+
+    // Timestamps are relative to the oldest entry kept.
+
+    base = 0;
+
+    if (first_event < num_events)
+    {
+        base = events[first_event % PROFEVENTS].start;
+    }
+
+    if (first_frame < num_frames
+     && (base == 0 || frames[first_frame % PROFFRAMES].start < base))
+    {
+        base = frames[first_frame % PROFFRAMES].start;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    comma = false;
+
+    for (i = first_frame; i < num_frames; ++i)
+    {
+        fprintf(out, "%s", comma ? ",\n" : "");
+        WriteFrame(out, &frames[i % PROFFRAMES], base);
+        comma = true;
+    }
+
+    for (i = first_event; i < num_events; ++i)
+    {
+        profevent_t *event = &events[i % PROFEVENTS];
+
+        fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                     "\"ts\":%.3f,\"dur\":%.3f}",
+                comma ? ",\n" : "", zone_names[event->zone],
+                (event->start - base) / 1000.0, event->duration / 1000.0);
+        comma = true;
+    }
+
+    fprintf(out, "\n]}\n");
+    fclose(out);
+
+    return true;
+}
+
+#else
+
+void M_ProfInit(void)
+{
+    if (M_ParmExists("-proftrace"))
+    {
+        printf("M_ProfInit: -proftrace needs a build with PROFILING "
+               "defined\n");
+    }
+}
+
+#endif
+
@@ -0,0 +1,99 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Hot-path profiling: scoped timers and per-frame counters,
+//      kept in a ring buffer and written out as a Chrome trace
+//      (chrome://tracing, Perfetto).
+//
+//      Only compiled in when PROFILING is defined; otherwise the
+//      PROF_* macros expand to nothing.
+//
+
+
+#ifndef __M_PROF__
+#define __M_PROF__
+
+#include "doomtype.h"
+
+// Timed stages.
+
+typedef enum
+{
+    prof_frame,                 // one whole doomgeneric_Tick
+    prof_bspnode,               // R_RenderBSPNode
+    prof_drawplanes,            // R_DrawPlanes
+    prof_drawmasked,            // R_DrawMasked
+    prof_runthinkers,           // P_RunThinkers
+
+    NUMPROFZONES
+} profzone_t;
+
+// Counters, reset at the start of every frame.
+
+typedef enum
+{
+    prof_nodes,                 // BSP nodes visited
+    prof_segs,                  // wall ranges stored (drawsegs)
+    prof_visplanes,             // visplanes drawn
+    prof_spans,                 // flat spans drawn
+    prof_vissprites,            // sprites drawn
+    prof_drawsegs_scanned,      // drawsegs checked for sprite clipping
+    prof_thinkers_mobj,         // thinkers run, by type
+    prof_thinkers_ceiling,
+    prof_thinkers_door,
+    prof_thinkers_floor,
+    prof_thinkers_plat,
+    prof_thinkers_light,
+    prof_thinkers_other,
+    prof_thinkers_removed,
+    prof_zmallocs,              // Z_Malloc calls
+    prof_rover_steps,           // blocks Z_Malloc stepped over
+    prof_composites,            // composite textures built
+
+    NUMPROFCOUNTERS
+} profcounter_t;
+
+// Read -proftrace.  Does nothing, apart from a warning if -proftrace
+// is given, when profiling is not compiled in.
+
+void M_ProfInit(void);
+
+#ifdef PROFILING
+
+extern DG_STATE int prof_counters[NUMPROFCOUNTERS];
+
+void M_ProfBegin(profzone_t zone);
+void M_ProfEnd(profzone_t zone);
+void M_ProfSetMap(char *name);
+
+// Write the contents of the ring buffer as Chrome trace-event JSON.
+
+boolean M_ProfWriteTrace(char *filename);
+
+#define PROF_BEGIN(zone)        M_ProfBegin(zone)
+#define PROF_END(zone)          M_ProfEnd(zone)
+#define PROF_COUNT(counter, n)  (prof_counters[counter] += (n))
+#define PROF_MAP(name)          M_ProfSetMap(name)
+
+#else
+
+#define PROF_BEGIN(zone)
+#define PROF_END(zone)
+#define PROF_COUNT(counter, n)
+#define PROF_MAP(name)
+
+#endif
+
+#endif
+
@@ -35,7 +35,7 @@
 //
 
 
-ceiling_t*	activeceilings[MAXCEILINGS];
+DG_STATE ceiling_t*	activeceilings[MAXCEILINGS];
 
 
 //
@@ -189,7 +189,7 @@ EV_DoCeiling
 	
 	// new door thinker
 	rtn = 1;
-	ceiling = Z_Malloc (sizeof(*ceiling), PU_LEVSPEC, 0);
+	ceiling = P_AllocThinker (tp_ceiling);
 	P_AddThinker (&ceiling->thinker);
 	sec->specialdata = ceiling;
 	ceiling->thinker.function.acp1 = (actionf_p1)T_MoveCeiling;
@@ -93,7 +93,7 @@ void A_Fall (mobj_t *actor);
 // sound blocking lines cut off traversal.
 //
 
-mobj_t*		soundtarget;
+DG_STATE mobj_t*		soundtarget;
 
 void
 P_RecursiveSound
@@ -761,6 +761,59 @@ void A_Chase (mobj_t*	actor)
 }
 
 
+//
+// P_QueueMonsterSight
+// For -parallelai: queues the sight checks of every monster that is
+//  about to A_Look or A_Chase this tic, for P_RunSightQueries to
+//  trace on the worker threads.
+//
+DG_STATE boolean	parallelai;
+
+void P_QueueMonsterSight (void)
+{
+    thinker_t*	th;
+    mobj_t*	mo;
+    mobj_t*	targ;
+    actionf_p1	action;
+    int		i;
+
+    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    {
+	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
+	    continue;
+
+	mo = (mobj_t *)th;
+
+	// about to go into its next state?
+	if (mo->tics != 1)
+	    continue;
+
+	action = states[mo->state->nextstate].action.acp1;
+
+	if (action == (actionf_p1)A_Chase)
+	{
+	    if (mo->target)
+		P_AddSightQuery (mo, mo->target);
+	}
+	else if (action == (actionf_p1)A_Look)
+	{
+	    targ = mo->subsector->sector->soundtarget;
+
+	    if (targ && (mo->flags & MF_AMBUSH))
+		P_AddSightQuery (mo, targ);
+
+	    for (i=0 ; i<MAXPLAYERS ; i++)
+	    {
+		if (playeringame[i] && players[i].health > 0)
+		    P_AddSightQuery (mo, players[i].mo);
+	    }
+	}
+    }
+
+    P_RunSightQueries ();
+}
+
+
 //
 // A_FaceTarget
 //
@@ -1106,10 +1159,10 @@ void A_SkelFist (mobj_t*	actor)
 // PIT_VileCheck
 // Detect a corpse that could be raised.
 //
-mobj_t*		corpsehit;
-mobj_t*		vileobj;
-fixed_t		viletryx;
-fixed_t		viletryy;
+DG_STATE mobj_t*		corpsehit;
+DG_STATE mobj_t*		vileobj;
+DG_STATE fixed_t		viletryx;
+DG_STATE fixed_t		viletryy;
 
 boolean PIT_VileCheck (mobj_t*	thing)
 {
@@ -1804,9 +1857,9 @@ A_CloseShotgun2
 
 
 
-mobj_t*		braintargets[32];
-int		numbraintargets;
-int		braintargeton = 0;
+DG_STATE mobj_t*		braintargets[32];
+DG_STATE int		numbraintargets;
+DG_STATE int		braintargeton = 0;
 
 void A_BrainAwake (mobj_t* mo)
 {
@@ -1901,7 +1954,7 @@ void A_BrainSpit (mobj_t*	mo)
     mobj_t*	targ;
     mobj_t*	newmobj;
     
-    static int	easy = 0;
+    static DG_STATE int	easy = 0;
 	
     easy ^= 1;
     if (gameskill <= sk_easy && (!easy))
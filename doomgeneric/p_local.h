@@ -64,10 +64,57 @@
 //
 
 // both the head and tail of the thinker list
-extern	thinker_t	thinkercap;	
+extern DG_STATE	thinker_t	thinkercap;	
+
+
+// Every kind of thinker has a pool, which hands out thinkers from
+//  chunks allocated from the zone and keeps them on a free list when
+//  removed, so that they sit together in memory and creating and
+//  removing them does not go to the zone.
+typedef enum
+{
+    tp_mobj,
+    tp_ceiling,
+    tp_door,
+    tp_floor,
+    tp_plat,
+    tp_flash,
+    tp_strobe,
+    tp_glow,
+    tp_flicker,
+    NUMTHINKERPOOLS
+
+} thinkerpooltype_t;
+
+typedef struct thinkerchunk_s
+{
+    struct thinkerchunk_s*	next;
+    // THINKERCHUNK thinkers follow
+} thinkerchunk_t;
+
+typedef struct thinkerpool_s
+{
+    int			size;
+    thinker_t*		free;		// linked through next
+    thinkerchunk_t*	chunks;
+
+    // Thinkers that can run in any order, and do not use P_Random,
+    //  are not put on the thinker list, but are run straight from
+    //  the pool after everything on the list.
+    boolean		batched;
+} thinkerpool_t;
 
 
 void P_InitThinkers (void);
+void P_InitThinkerPools (void);
+void* P_AllocThinker (thinkerpooltype_t type);
+void P_FreeThinker (thinker_t* thinker);
+void P_FreeBatchedThinkers (void);
+
+void
+P_IteratePoolThinkers
+( thinkerpooltype_t	type,
+  void			(*func)(thinker_t*) );
 void P_AddThinker (thinker_t* thinker);
 void P_RemoveThinker (thinker_t* thinker);
 
@@ -95,10 +142,10 @@ void	P_PlayerThink (player_t* player);
 // Time interval for item respawning.
 #define ITEMQUESIZE		128
 
-extern mapthing_t	itemrespawnque[ITEMQUESIZE];
-extern int		itemrespawntime[ITEMQUESIZE];
-extern int		iquehead;
-extern int		iquetail;
+extern DG_STATE mapthing_t	itemrespawnque[ITEMQUESIZE];
+extern DG_STATE int		itemrespawntime[ITEMQUESIZE];
+extern DG_STATE int		iquehead;
+extern DG_STATE int		iquetail;
 
 
 void P_RespawnSpecials (void);
@@ -125,6 +172,9 @@ void	P_SpawnPlayerMissile (mobj_t* source, mobjtype_t type);
 // P_ENEMY
 //
 void P_NoiseAlert (mobj_t* target, mobj_t* emmiter);
+void P_QueueMonsterSight (void);
+
+extern DG_STATE boolean	parallelai;
 
 
 //
@@ -154,8 +204,8 @@ typedef struct
 #define MAXINTERCEPTS_ORIGINAL 128
 #define MAXINTERCEPTS          (MAXINTERCEPTS_ORIGINAL + 61)
 
-extern intercept_t	intercepts[MAXINTERCEPTS];
-extern intercept_t*	intercept_p;
+extern DG_STATE intercept_t	intercepts[MAXINTERCEPTS];
+extern DG_STATE intercept_t*	intercept_p;
 
 typedef boolean (*traverser_t) (intercept_t *in);
 
@@ -166,21 +216,30 @@ void 	P_MakeDivline (line_t* li, divline_t* dl);
 fixed_t P_InterceptVector (divline_t* v2, divline_t* v1);
 int 	P_BoxOnLineSide (fixed_t* tmbox, line_t* ld);
 
-extern fixed_t		opentop;
-extern fixed_t 		openbottom;
-extern fixed_t		openrange;
-extern fixed_t		lowfloor;
+extern DG_STATE fixed_t		opentop;
+extern DG_STATE fixed_t 		openbottom;
+extern DG_STATE fixed_t		openrange;
+extern DG_STATE fixed_t		lowfloor;
 
 void 	P_LineOpening (line_t* linedef);
 
 boolean P_BlockLinesIterator (int x, int y, boolean(*func)(line_t*) );
 boolean P_BlockThingsIterator (int x, int y, boolean(*func)(mobj_t*) );
 
+boolean
+P_BlockThingsIteratorNear
+( int		x,
+  int		y,
+  fixed_t	nearx,
+  fixed_t	neary,
+  fixed_t	range,
+  boolean	(*func)(mobj_t*) );
+
 #define PT_ADDLINES		1
 #define PT_ADDTHINGS	2
 #define PT_EARLYOUT		4
 
-extern divline_t	trace;
+extern DG_STATE divline_t	trace;
 
 boolean
 P_PathTraverse
@@ -201,12 +260,12 @@ void P_SetThingPosition (mobj_t* thing);
 
 // If "floatok" true, move would be ok
 // if within "tmfloorz - tmceilingz".
-extern boolean		floatok;
-extern fixed_t		tmfloorz;
-extern fixed_t		tmceilingz;
+extern DG_STATE boolean		floatok;
+extern DG_STATE fixed_t		tmfloorz;
+extern DG_STATE fixed_t		tmceilingz;
 
 
-extern	line_t*		ceilingline;
+extern DG_STATE	line_t*		ceilingline;
 
 // fraggle: I have increased the size of this buffer.  In the original Doom,
 // overrunning past this limit caused other bits of memory to be overwritten,
@@ -219,19 +278,25 @@ extern	line_t*		ceilingline;
 #define MAXSPECIALCROSS 		20
 #define MAXSPECIALCROSS_ORIGINAL	8
 
-extern	line_t*	spechit[MAXSPECIALCROSS];
-extern	int	numspechit;
+extern DG_STATE	line_t*	spechit[MAXSPECIALCROSS];
+extern DG_STATE	int	numspechit;
 
 boolean P_CheckPosition (mobj_t *thing, fixed_t x, fixed_t y);
 boolean P_TryMove (mobj_t* thing, fixed_t x, fixed_t y);
 boolean P_TeleportMove (mobj_t* thing, fixed_t x, fixed_t y);
 void	P_SlideMove (mobj_t* mo);
 boolean P_CheckSight (mobj_t* t1, mobj_t* t2);
+void	P_InitSight (void);
+void	P_ClearSightCache (void);
+void	P_AddSightQuery (mobj_t* t1, mobj_t* t2);
+void	P_RunSightQueries (void);
+void	P_ClearSightQueries (void);
+void	P_ForgetSightQueries (mobj_t* mo);
 void 	P_UseLines (player_t* player);
 
 boolean P_ChangeSector (sector_t* sector, boolean crunch);
 
-extern mobj_t*	linetarget;	// who got hit (or NULL)
+extern DG_STATE mobj_t*	linetarget;	// who got hit (or NULL)
 
 fixed_t
 P_AimLineAttack
@@ -258,14 +323,37 @@ P_RadiusAttack
 //
 // P_SETUP
 //
-extern byte*		rejectmatrix;	// for fast sight rejection
-extern short*		blockmaplump;	// offsets in blockmap are from here
-extern short*		blockmap;
-extern int		bmapwidth;
-extern int		bmapheight;	// in mapblocks
-extern fixed_t		bmaporgx;
-extern fixed_t		bmaporgy;	// origin of block map
-extern mobj_t**		blocklinks;	// for thing chains
+extern DG_STATE byte*		rejectmatrix;	// for fast sight rejection
+extern DG_STATE short*		blockmaplump;	// offsets in blockmap are from here
+extern DG_STATE short*		blockmap;
+extern DG_STATE int		bmapwidth;
+extern DG_STATE int		bmapheight;	// in mapblocks
+extern DG_STATE fixed_t		bmaporgx;
+extern DG_STATE fixed_t		bmaporgy;	// origin of block map
+extern DG_STATE mobj_t**		blocklinks;	// for thing chains
+
+// The thing grid: unless -nothinggrid is given, the things in each
+//  mapblock are kept in an array of these instead of on blocklinks,
+//  oldest first, so that iterating over them does not have to chase
+//  bnext through every mobj.
+typedef struct
+{
+    fixed_t	x;
+    fixed_t	y;
+    fixed_t	radius;
+    mobj_t*	mobj;		// NULL if unlinked during an iteration
+} blockthing_t;
+
+typedef struct
+{
+    blockthing_t*	things;
+    int			numthings;
+    int			maxthings;
+    int			numholes;	// NULL mobjs in things
+} blockcell_t;
+
+extern DG_STATE boolean		thinggrid;
+extern DG_STATE blockcell_t*	blockcells;
 
 
 
@@ -60,30 +60,30 @@
 //#define DEFAULT_SPECHIT_MAGIC 0x84f968e8
 
 
-fixed_t		tmbbox[4];
-mobj_t*		tmthing;
-int		tmflags;
-fixed_t		tmx;
-fixed_t		tmy;
+DG_STATE fixed_t		tmbbox[4];
+DG_STATE mobj_t*		tmthing;
+DG_STATE int		tmflags;
+DG_STATE fixed_t		tmx;
+DG_STATE fixed_t		tmy;
 
 
 // If "floatok" true, move would be ok
 // if within "tmfloorz - tmceilingz".
-boolean		floatok;
+DG_STATE boolean		floatok;
 
-fixed_t		tmfloorz;
-fixed_t		tmceilingz;
-fixed_t		tmdropoffz;
+DG_STATE fixed_t		tmfloorz;
+DG_STATE fixed_t		tmceilingz;
+DG_STATE fixed_t		tmdropoffz;
 
 // keep track of the line that lowers the ceiling,
 // so missiles don't explode against sky hack walls
-line_t*		ceilingline;
+DG_STATE line_t*		ceilingline;
 
 // keep track of special lines as they are hit,
 // but don't process them until the move is proven valid
 
-line_t*		spechit[MAXSPECIALCROSS];
-int		numspechit;
+DG_STATE line_t*		spechit[MAXSPECIALCROSS];
+DG_STATE int		numspechit;
 
 
 
@@ -175,7 +175,8 @@ P_TeleportMove
 
     for (bx=xl ; bx<=xh ; bx++)
 	for (by=yl ; by<=yh ; by++)
-	    if (!P_BlockThingsIterator(bx,by,PIT_StompThing))
+	    if (!P_BlockThingsIteratorNear(bx,by,tmx,tmy,tmthing->radius,
+					   PIT_StompThing))
 		return false;
     
     // the move is ok,
@@ -451,7 +452,8 @@ P_CheckPosition
 
     for (bx=xl ; bx<=xh ; bx++)
 	for (by=yl ; by<=yh ; by++)
-	    if (!P_BlockThingsIterator(bx,by,PIT_CheckThing))
+	    if (!P_BlockThingsIteratorNear(bx,by,tmx,tmy,tmthing->radius,
+					   PIT_CheckThing))
 		return false;
     
     // check lines
@@ -590,16 +592,16 @@ boolean P_ThingHeightClip (mobj_t* thing)
 // SLIDE MOVE
 // Allows the player to slide along any angled walls.
 //
-fixed_t		bestslidefrac;
-fixed_t		secondslidefrac;
+DG_STATE fixed_t		bestslidefrac;
+DG_STATE fixed_t		secondslidefrac;
 
-line_t*		bestslideline;
-line_t*		secondslideline;
+DG_STATE line_t*		bestslideline;
+DG_STATE line_t*		secondslideline;
 
-mobj_t*		slidemo;
+DG_STATE mobj_t*		slidemo;
 
-fixed_t		tmxmove;
-fixed_t		tmymove;
+DG_STATE fixed_t		tmxmove;
+DG_STATE fixed_t		tmymove;
 
 
 
@@ -818,21 +820,21 @@ void P_SlideMove (mobj_t* mo)
 //
 // P_LineAttack
 //
-mobj_t*		linetarget;	// who got hit (or NULL)
-mobj_t*		shootthing;
+DG_STATE mobj_t*		linetarget;	// who got hit (or NULL)
+DG_STATE mobj_t*		shootthing;
 
 // Height if not aiming up or down
 // ???: use slope for monsters?
-fixed_t		shootz;	
+DG_STATE fixed_t		shootz;	
 
-int		la_damage;
-fixed_t		attackrange;
+DG_STATE int		la_damage;
+DG_STATE fixed_t		attackrange;
 
-fixed_t		aimslope;
+DG_STATE fixed_t		aimslope;
 
 // slopes to top and bottom of target
-extern fixed_t	topslope;
-extern fixed_t	bottomslope;	
+extern DG_THREAD_LOCAL fixed_t	topslope;
+extern DG_THREAD_LOCAL fixed_t	bottomslope;	
 
 
 //
@@ -1137,7 +1139,7 @@ P_LineAttack
 //
 // USE LINES
 //
-mobj_t*		usething;
+DG_STATE mobj_t*		usething;
 
 boolean	PTR_UseTraverse (intercept_t* in)
 {
@@ -1198,9 +1200,9 @@ void P_UseLines (player_t*	player)
 //
 // RADIUS ATTACK
 //
-mobj_t*		bombsource;
-mobj_t*		bombspot;
-int		bombdamage;
+DG_STATE mobj_t*		bombsource;
+DG_STATE mobj_t*		bombspot;
+DG_STATE int		bombdamage;
 
 
 //
@@ -1276,7 +1278,8 @@ P_RadiusAttack
 	
     for (y=yl ; y<=yh ; y++)
 	for (x=xl ; x<=xh ; x++)
-	    P_BlockThingsIterator (x, y, PIT_RadiusAttack );
+	    P_BlockThingsIteratorNear (x, y, spot->x, spot->y,
+				       damage<<FRACBITS, PIT_RadiusAttack);
 }
 
 
@@ -1294,8 +1297,8 @@ P_RadiusAttack
 //  the way it was and call P_ChangeSector again
 //  to undo the changes.
 //
-boolean		crushchange;
-boolean		nofit;
+DG_STATE boolean		crushchange;
+DG_STATE boolean		nofit;
 
 
 //
@@ -1374,6 +1377,9 @@ P_ChangeSector
 	
     nofit = false;
     crushchange = crunch;
+
+    // the sector's height has just changed
+    P_ClearSightCache ();
 	
     // re-check heights for all things near the moving sector
     for (x=sector->blockbox[BOXLEFT] ; x<= sector->blockbox[BOXRIGHT] ; x++)
@@ -1390,7 +1396,7 @@ P_ChangeSector
 
 static void SpechitOverrun(line_t *ld)
 {
-    static unsigned int baseaddr = 0;
+    static DG_STATE unsigned int baseaddr = 0;
     unsigned int addr;
    
     if (baseaddr == 0)
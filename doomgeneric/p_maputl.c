@@ -23,9 +23,11 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 
 #include "m_bbox.h"
+#include "z_zone.h"
 
 #include "doomdef.h"
 #include "doomstat.h"
@@ -286,10 +288,10 @@ P_InterceptVector
 // through a two sided line.
 // OPTIMIZE: keep this precalculated
 //
-fixed_t opentop;
-fixed_t openbottom;
-fixed_t openrange;
-fixed_t	lowfloor;
+DG_STATE fixed_t opentop;
+DG_STATE fixed_t openbottom;
+DG_STATE fixed_t openrange;
+DG_STATE fixed_t	lowfloor;
 
 
 void P_LineOpening (line_t* linedef)
@@ -327,6 +329,122 @@ void P_LineOpening (line_t* linedef)
 }
 
 
+//
+// THING GRID
+// The blockcell of each mapblock holds its things oldest first, and
+//  P_BlockThingsIterator goes through them newest first: the same
+//  order as the blocklinks lists, which things are added to the
+//  head of.
+// A thing unlinked while an iterator is running only has its mobj
+//  cleared, so that the iterator does not lose its place; holes are
+//  squeezed out the next time the cell changes with none running.
+//
+DG_STATE boolean		thinggrid;
+
+static DG_STATE int		blockiterators;
+
+
+static blockcell_t* P_ThingBlockCell (mobj_t* thing)
+{
+    int		blockx;
+    int		blocky;
+
+    blockx = (thing->x - bmaporgx)>>MAPBLOCKSHIFT;
+    blocky = (thing->y - bmaporgy)>>MAPBLOCKSHIFT;
+
+    if (blockx>=0
+	&& blockx < bmapwidth
+	&& blocky>=0
+	&& blocky < bmapheight)
+    {
+	return &blockcells[blocky*bmapwidth+blockx];
+    }
+
+    // thing is off the map
+    return NULL;
+}
+
+
+static void P_CompactBlockCell (blockcell_t* cell)
+{
+    int		i;
+    int		j;
+
+    for (i=j=0 ; i<cell->numthings ; i++)
+    {
+	if (cell->things[i].mobj != NULL)
+	    cell->things[j++] = cell->things[i];
+    }
+
+    cell->numthings = j;
+    cell->numholes = 0;
+}
+
+
+static void P_UnlinkBlockThing (mobj_t* thing)
+{
+    blockcell_t*	cell;
+    int			i;
+
+    cell = P_ThingBlockCell (thing);
+
+    if (cell == NULL)
+	return;
+
+    for (i=cell->numthings-1 ; i>=0 ; i--)
+    {
+	if (cell->things[i].mobj == thing)
+	    break;
+    }
+
+    if (i < 0)
+	return;
+
+    cell->things[i].mobj = NULL;
+    cell->numholes++;
+
+    if (!blockiterators)
+	P_CompactBlockCell (cell);
+}
+
+
+static void P_LinkBlockThing (mobj_t* thing)
+{
+    blockcell_t*	cell;
+    blockthing_t*	things;
+    blockthing_t*	bt;
+
+    cell = P_ThingBlockCell (thing);
+
+    if (cell == NULL)
+	return;
+
+    if (cell->numholes && !blockiterators)
+	P_CompactBlockCell (cell);
+
+    if (cell->numthings == cell->maxthings)
+    {
+	cell->maxthings = cell->maxthings ? cell->maxthings*2 : 4;
+	things = Z_Malloc (cell->maxthings * sizeof(*things), PU_LEVEL, 0);
+
+	if (cell->things != NULL)
+	{
+	    memcpy (things, cell->things, cell->numthings * sizeof(*things));
+	    Z_Free (cell->things);
+	}
+
+	cell->things = things;
+    }
+
+    bt = &cell->things[cell->numthings++];
+    bt->x = thing->x;
+    bt->y = thing->y;
+    bt->radius = thing->radius;
+    bt->mobj = thing;
+}
+
+
+
 //
 // THING POSITION SETTING
 //
@@ -357,7 +475,11 @@ void P_UnsetThingPosition (mobj_t* thing)
 	    thing->subsector->sector->thinglist = thing->snext;
     }
 	
-    if ( ! (thing->flags & MF_NOBLOCKMAP) )
+    if ( ! (thing->flags & MF_NOBLOCKMAP) && thinggrid)
+    {
+	P_UnlinkBlockThing (thing);
+    }
+    else if ( ! (thing->flags & MF_NOBLOCKMAP) )
     {
 	// inert things don't need to be in blockmap
 	// unlink from block map
@@ -417,7 +539,11 @@ P_SetThingPosition (mobj_t* thing)
 
     
     // link into blockmap
-    if ( ! (thing->flags & MF_NOBLOCKMAP) )
+    if ( ! (thing->flags & MF_NOBLOCKMAP) && thinggrid)
+    {
+	P_LinkBlockThing (thing);
+    }
+    else if ( ! (thing->flags & MF_NOBLOCKMAP) )
     {
 	// inert things don't need to be in blockmap		
 	blockx = (thing->x - bmaporgx)>>MAPBLOCKSHIFT;
@@ -509,8 +635,33 @@ P_BlockThingsIterator
 ( int			x,
   int			y,
   boolean(*func)(mobj_t*) )
+{
+    return P_BlockThingsIteratorNear (x, y, 0, 0, -1, func);
+}
+
+
+//
+// P_BlockThingsIteratorNear
+// Like P_BlockThingsIterator, but if range is not negative, things
+//  whose radius plus range is not more than their distance from
+//  nearx,neary along x or y are skipped.  This is only for PIT_*
+//  functions that would ignore them anyway, without side effects;
+//  with the thing grid the mobjs are then not even looked at.
+//
+boolean
+P_BlockThingsIteratorNear
+( int			x,
+  int			y,
+  fixed_t		nearx,
+  fixed_t		neary,
+  fixed_t		range,
+  boolean(*func)(mobj_t*) )
 {
     mobj_t*		mobj;
+    blockcell_t*	cell;
+    blockthing_t*	bt;
+    fixed_t		blockdist;
+    int			i;
 	
     if ( x<0
 	 || y<0
@@ -519,15 +670,61 @@ P_BlockThingsIterator
     {
 	return true;
     }
-    
 
-    for (mobj = blocklinks[y*bmapwidth+x] ;
-	 mobj ;
-	 mobj = mobj->bnext)
+    if (!thinggrid)
     {
-	if (!func( mobj ) )
+	for (mobj = blocklinks[y*bmapwidth+x] ;
+	     mobj ;
+	     mobj = mobj->bnext)
+	{
+	    if (range >= 0)
+	    {
+		blockdist = mobj->radius + range;
+
+		if ( abs(mobj->x - nearx) >= blockdist
+		     || abs(mobj->y - neary) >= blockdist )
+		{
+		    continue;
+		}
+	    }
+
+	    if (!func( mobj ) )
+		return false;
+	}
+	return true;
+    }
+
+    // func can add and remove things, so the array can move;
+    //  things added go on the end, where they are not visited.
+    cell = &blockcells[y*bmapwidth+x];
+    blockiterators++;
+
+    for (i=cell->numthings-1 ; i>=0 ; i--)
+    {
+	bt = &cell->things[i];
+
+	if (bt->mobj == NULL)
+	    continue;
+
+	if (range >= 0)
+	{
+	    blockdist = bt->radius + range;
+
+	    if ( abs(bt->x - nearx) >= blockdist
+		 || abs(bt->y - neary) >= blockdist )
+	    {
+		continue;
+	    }
+	}
+
+	if (!func( bt->mobj ) )
+	{
+	    blockiterators--;
 	    return false;
+	}
     }
+
+    blockiterators--;
     return true;
 }
 
@@ -536,12 +733,12 @@ P_BlockThingsIterator
 //
 // INTERCEPT ROUTINES
 //
-intercept_t	intercepts[MAXINTERCEPTS];
-intercept_t*	intercept_p;
+DG_STATE intercept_t	intercepts[MAXINTERCEPTS];
+DG_STATE intercept_t*	intercept_p;
 
-divline_t 	trace;
-boolean 	earlyout;
-int		ptflags;
+DG_STATE divline_t 	trace;
+DG_STATE boolean 	earlyout;
+DG_STATE int		ptflags;
 
 static void InterceptsOverrun(int num_intercepts, intercept_t *intercept);
 
@@ -728,7 +925,7 @@ P_TraverseIntercepts
     return true;		// everything was traversed
 }
 
-extern fixed_t bulletslope;
+extern DG_STATE fixed_t bulletslope;
 
 // Intercepts Overrun emulation, from PrBoom-plus.
 // Thanks to Andrey Budko (entryway) for researching this and his 
@@ -742,41 +939,6 @@ typedef struct
     boolean int16_array;
 } intercepts_overrun_t;
 
-// Intercepts memory table.  This is where various variables are located
-// in memory in Vanilla Doom.  When the intercepts table overflows, we
-// need to write to them.
-//
-// Almost all of the values to overwrite are 32-bit integers, except for
-// playerstarts, which is effectively an array of 16-bit integers and
-// must be treated differently.
-
-static intercepts_overrun_t intercepts_overrun[] =
-{
-    {4,   NULL,                          false},
-    {4,   NULL, /* &earlyout, */         false},
-    {4,   NULL, /* &intercept_p, */      false},
-    {4,   &lowfloor,                     false},
-    {4,   &openbottom,                   false},
-    {4,   &opentop,                      false},
-    {4,   &openrange,                    false},
-    {4,   NULL,                          false},
-    {120, NULL, /* &activeplats, */      false},
-    {8,   NULL,                          false},
-    {4,   &bulletslope,                  false},
-    {4,   NULL, /* &swingx, */           false},
-    {4,   NULL, /* &swingy, */           false},
-    {4,   NULL,                          false},
-    {40,  &playerstarts,                 true},
-    {4,   NULL, /* &blocklinks, */       false},
-    {4,   &bmapwidth,                    false},
-    {4,   NULL, /* &blockmap, */         false},
-    {4,   &bmaporgx,                     false},
-    {4,   &bmaporgy,                     false},
-    {4,   NULL, /* &blockmaplump, */     false},
-    {4,   &bmapheight,                   false},
-    {0,   NULL,                          false},
-};
-
 // Overwrite a specific memory location with a value.
 
 static void InterceptsMemoryOverrun(int location, int value)
@@ -785,6 +947,45 @@ static void InterceptsMemoryOverrun(int location, int value)
     int index;
     void *addr;
 
+    // Intercepts memory table.  This is where various variables are located
+    // in memory in Vanilla Doom.  When the intercepts table overflows, we
+    // need to write to them.
+    //
+    // Almost all of the values to overwrite are 32-bit integers, except for
+    // playerstarts, which is effectively an array of 16-bit integers and
+    // must be treated differently.
+    //
+    // The table is built on the stack rather than statically: the
+    // addresses of thread-local variables are not constant initializers
+    // in a multi-instance build.
+
+    intercepts_overrun_t intercepts_overrun[] =
+    {
+        {4,   NULL,                          false},
+        {4,   NULL, /* &earlyout, */         false},
+        {4,   NULL, /* &intercept_p, */      false},
+        {4,   &lowfloor,                     false},
+        {4,   &openbottom,                   false},
+        {4,   &opentop,                      false},
+        {4,   &openrange,                    false},
+        {4,   NULL,                          false},
+        {120, NULL, /* &activeplats, */      false},
+        {8,   NULL,                          false},
+        {4,   &bulletslope,                  false},
+        {4,   NULL, /* &swingx, */           false},
+        {4,   NULL, /* &swingy, */           false},
+        {4,   NULL,                          false},
+        {40,  &playerstarts,                 true},
+        {4,   NULL, /* &blocklinks, */       false},
+        {4,   &bmapwidth,                    false},
+        {4,   NULL, /* &blockmap, */         false},
+        {4,   &bmaporgx,                     false},
+        {4,   &bmaporgy,                     false},
+        {4,   NULL, /* &blockmaplump, */     false},
+        {4,   &bmapheight,                   false},
+        {0,   NULL,                          false},
+    };
+
     i = 0;
     offset = 0;
 
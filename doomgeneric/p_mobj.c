@@ -42,7 +42,7 @@ void P_SpawnMapThing (mapthing_t*	mthing);
 // P_SetMobjState
 // Returns true if the mobj is still present.
 //
-int test;
+DG_STATE int test;
 
 boolean
 P_SetMobjState
@@ -513,8 +513,7 @@ P_SpawnMobj
     state_t*	st;
     mobjinfo_t*	info;
 	
-    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
-    memset (mobj, 0, sizeof (*mobj));
+    mobj = P_AllocThinker (tp_mobj);
     info = &mobjinfo[type];
 	
     mobj->type = type;
@@ -563,10 +562,10 @@ P_SpawnMobj
 //
 // P_RemoveMobj
 //
-mapthing_t	itemrespawnque[ITEMQUESIZE];
-int		itemrespawntime[ITEMQUESIZE];
-int		iquehead;
-int		iquetail;
+DG_STATE mapthing_t	itemrespawnque[ITEMQUESIZE];
+DG_STATE int		itemrespawntime[ITEMQUESIZE];
+DG_STATE int		iquehead;
+DG_STATE int		iquetail;
 
 
 void P_RemoveMobj (mobj_t* mobj)
@@ -590,6 +589,9 @@ void P_RemoveMobj (mobj_t* mobj)
     
     // stop any playing sound
     S_StopSound (mobj);
+
+    // its memory may be reused before the tic is over
+    P_ForgetSightQueries (mobj);
     
     // free block
     P_RemoveThinker ((thinker_t*)mobj);
@@ -845,7 +847,7 @@ void P_SpawnMapThing (mapthing_t* mthing)
 //
 // P_SpawnPuff
 //
-extern fixed_t attackrange;
+extern DG_STATE fixed_t attackrange;
 
 void
 P_SpawnPuff
@@ -930,7 +932,7 @@ mobj_t *P_SubstNullMobj(mobj_t *mobj)
 {
     if (mobj == NULL)
     {
-        static mobj_t dummy_mobj;
+        static DG_STATE mobj_t dummy_mobj;
 
         dummy_mobj.x = 0;
         dummy_mobj.y = 0;
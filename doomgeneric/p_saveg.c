@@ -36,9 +36,9 @@
 #define SAVEGAME_EOF 0x1d
 #define VERSIONSIZE 16 
 
-FILE *save_stream;
-int savegamelength;
-boolean savegame_error;
+DG_STATE FILE *save_stream;
+DG_STATE int savegamelength;
+DG_STATE boolean savegame_error;
 
 // Get the filename of a temporary file to write the savegame to.  After
 // the file has been successfully saved, it will be renamed to the 
@@ -46,7 +46,7 @@ boolean savegame_error;
 
 char *P_TempSaveGameFile(void)
 {
-    static char *filename = NULL;
+    static DG_STATE char *filename = NULL;
 
     if (filename == NULL)
     {
@@ -60,8 +60,8 @@ char *P_TempSaveGameFile(void)
 
 char *P_SaveGameFile(int slot)
 {
-    static char *filename = NULL;
-    static size_t filename_size = 0;
+    static DG_STATE char *filename = NULL;
+    static DG_STATE size_t filename_size = 0;
     char basename[32];
 
     if (filename == NULL)
@@ -1537,6 +1537,9 @@ void P_UnArchiveWorld (void)
     line_t*		li;
     side_t*		si;
     
+    // the sight cache knows nothing of the heights about to be read
+    P_ClearSightCache ();
+
     // do sectors
     for (i=0, sec = sectors ; i<numsectors ; i++,sec++)
     {
@@ -1632,11 +1635,12 @@ void P_UnArchiveThinkers (void)
 	
 	if (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
 	    P_RemoveMobj ((mobj_t *)currentthinker);
-	else
-	    Z_Free (currentthinker);
+
+	P_FreeThinker (currentthinker);
 
 	currentthinker = next;
     }
+    P_FreeBatchedThinkers ();
     P_InitThinkers ();
     
     // read in saved thinkers
@@ -1650,7 +1654,7 @@ void P_UnArchiveThinkers (void)
 			
 	  case tc_mobj:
 	    saveg_read_pad();
-	    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
+	    mobj = P_AllocThinker (tp_mobj);
             saveg_read_mobj_t(mobj);
 
 	    mobj->target = NULL;
@@ -1686,7 +1690,7 @@ enum
     tc_glow,
     tc_endspecials
 
-} specials_e;	
+} DG_STATE specials_e;	
 
 
 
@@ -1701,85 +1705,93 @@ enum
 // T_Glow, (glow_t: sector_t *),
 // T_PlatRaise, (plat_t: sector_t *), - active list
 //
-void P_ArchiveSpecials (void)
+static void P_ArchiveSpecial (thinker_t* th)
 {
-    thinker_t*		th;
     int			i;
-	
-    // save off the current thinkers
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+
+    if (th->function.acv == (actionf_v)NULL)
     {
-	if (th->function.acv == (actionf_v)NULL)
-	{
-	    for (i = 0; i < MAXCEILINGS;i++)
-		if (activeceilings[i] == (ceiling_t *)th)
-		    break;
+	for (i = 0; i < MAXCEILINGS;i++)
+	    if (activeceilings[i] == (ceiling_t *)th)
+		break;
 	    
-	    if (i<MAXCEILINGS)
-	    {
-                saveg_write8(tc_ceiling);
-		saveg_write_pad();
-                saveg_write_ceiling_t((ceiling_t *) th);
-	    }
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_MoveCeiling)
+	if (i<MAXCEILINGS)
 	{
             saveg_write8(tc_ceiling);
 	    saveg_write_pad();
             saveg_write_ceiling_t((ceiling_t *) th);
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_VerticalDoor)
-	{
-            saveg_write8(tc_door);
-	    saveg_write_pad();
-            saveg_write_vldoor_t((vldoor_t *) th);
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_MoveFloor)
-	{
-            saveg_write8(tc_floor);
-	    saveg_write_pad();
-            saveg_write_floormove_t((floormove_t *) th);
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_PlatRaise)
-	{
-            saveg_write8(tc_plat);
-	    saveg_write_pad();
-            saveg_write_plat_t((plat_t *) th);
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_LightFlash)
-	{
-            saveg_write8(tc_flash);
-	    saveg_write_pad();
-            saveg_write_lightflash_t((lightflash_t *) th);
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_StrobeFlash)
-	{
-            saveg_write8(tc_strobe);
-	    saveg_write_pad();
-            saveg_write_strobe_t((strobe_t *) th);
-	    continue;
-	}
-			
-	if (th->function.acp1 == (actionf_p1)T_Glow)
-	{
-            saveg_write8(tc_glow);
-	    saveg_write_pad();
-            saveg_write_glow_t((glow_t *) th);
-	    continue;
 	}
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_MoveCeiling)
+    {
+        saveg_write8(tc_ceiling);
+	saveg_write_pad();
+        saveg_write_ceiling_t((ceiling_t *) th);
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_VerticalDoor)
+    {
+        saveg_write8(tc_door);
+	saveg_write_pad();
+        saveg_write_vldoor_t((vldoor_t *) th);
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_MoveFloor)
+    {
+        saveg_write8(tc_floor);
+	saveg_write_pad();
+        saveg_write_floormove_t((floormove_t *) th);
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_PlatRaise)
+    {
+        saveg_write8(tc_plat);
+	saveg_write_pad();
+        saveg_write_plat_t((plat_t *) th);
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_LightFlash)
+    {
+        saveg_write8(tc_flash);
+	saveg_write_pad();
+        saveg_write_lightflash_t((lightflash_t *) th);
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_StrobeFlash)
+    {
+        saveg_write8(tc_strobe);
+	saveg_write_pad();
+        saveg_write_strobe_t((strobe_t *) th);
+	return;
+    }
+		
+    if (th->function.acp1 == (actionf_p1)T_Glow)
+    {
+        saveg_write8(tc_glow);
+	saveg_write_pad();
+        saveg_write_glow_t((glow_t *) th);
+	return;
     }
+}
+
+void P_ArchiveSpecials (void)
+{
+    thinker_t*		th;
+	
+    // save off the current thinkers
+    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+	P_ArchiveSpecial (th);
+
+    // and the lights that are not on the list
+    P_IteratePoolThinkers (tp_strobe, P_ArchiveSpecial);
+    P_IteratePoolThinkers (tp_glow, P_ArchiveSpecial);
 	
     // add a terminating marker
     saveg_write8(tc_endspecials);
@@ -1814,7 +1826,7 @@ void P_UnArchiveSpecials (void)
 			
 	  case tc_ceiling:
 	    saveg_read_pad();
-	    ceiling = Z_Malloc (sizeof(*ceiling), PU_LEVEL, NULL);
+	    ceiling = P_AllocThinker (tp_ceiling);
             saveg_read_ceiling_t(ceiling);
 	    ceiling->sector->specialdata = ceiling;
 
@@ -1827,7 +1839,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_door:
 	    saveg_read_pad();
-	    door = Z_Malloc (sizeof(*door), PU_LEVEL, NULL);
+	    door = P_AllocThinker (tp_door);
             saveg_read_vldoor_t(door);
 	    door->sector->specialdata = door;
 	    door->thinker.function.acp1 = (actionf_p1)T_VerticalDoor;
@@ -1836,7 +1848,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_floor:
 	    saveg_read_pad();
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVEL, NULL);
+	    floor = P_AllocThinker (tp_floor);
             saveg_read_floormove_t(floor);
 	    floor->sector->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1)T_MoveFloor;
@@ -1845,7 +1857,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_plat:
 	    saveg_read_pad();
-	    plat = Z_Malloc (sizeof(*plat), PU_LEVEL, NULL);
+	    plat = P_AllocThinker (tp_plat);
             saveg_read_plat_t(plat);
 	    plat->sector->specialdata = plat;
 
@@ -1858,7 +1870,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_flash:
 	    saveg_read_pad();
-	    flash = Z_Malloc (sizeof(*flash), PU_LEVEL, NULL);
+	    flash = P_AllocThinker (tp_flash);
             saveg_read_lightflash_t(flash);
 	    flash->thinker.function.acp1 = (actionf_p1)T_LightFlash;
 	    P_AddThinker (&flash->thinker);
@@ -1866,7 +1878,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_strobe:
 	    saveg_read_pad();
-	    strobe = Z_Malloc (sizeof(*strobe), PU_LEVEL, NULL);
+	    strobe = P_AllocThinker (tp_strobe);
             saveg_read_strobe_t(strobe);
 	    strobe->thinker.function.acp1 = (actionf_p1)T_StrobeFlash;
 	    P_AddThinker (&strobe->thinker);
@@ -1874,7 +1886,7 @@ void P_UnArchiveSpecials (void)
 				
 	  case tc_glow:
 	    saveg_read_pad();
-	    glow = Z_Malloc (sizeof(*glow), PU_LEVEL, NULL);
+	    glow = P_AllocThinker (tp_glow);
             saveg_read_glow_t(glow);
 	    glow->thinker.function.acp1 = (actionf_p1)T_Glow;
 	    P_AddThinker (&glow->thinker);
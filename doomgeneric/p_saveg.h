@@ -55,8 +55,8 @@ void P_UnArchiveThinkers (void);
 void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 
-extern FILE *save_stream;
-extern boolean savegame_error;
+extern DG_STATE FILE *save_stream;
+extern DG_STATE boolean savegame_error;
 
 
 #endif
@@ -27,10 +27,12 @@
 #include "i_swap.h"
 #include "m_argv.h"
 #include "m_bbox.h"
+#include "m_prof.h"
 
 #include "g_game.h"
 
 #include "i_system.h"
+#include "i_thread.h"
 #include "w_wad.h"
 
 #include "doomdef.h"
@@ -48,28 +50,28 @@ void	P_SpawnMapThing (mapthing_t*	mthing);
 // MAP related Lookup tables.
 // Store VERTEXES, LINEDEFS, SIDEDEFS, etc.
 //
-int		numvertexes;
-vertex_t*	vertexes;
+DG_STATE int		numvertexes;
+DG_STATE vertex_t*	vertexes;
 
-int		numsegs;
-seg_t*		segs;
+DG_STATE int		numsegs;
+DG_STATE seg_t*		segs;
 
-int		numsectors;
-sector_t*	sectors;
+DG_STATE int		numsectors;
+DG_STATE sector_t*	sectors;
 
-int		numsubsectors;
-subsector_t*	subsectors;
+DG_STATE int		numsubsectors;
+DG_STATE subsector_t*	subsectors;
 
-int		numnodes;
-node_t*		nodes;
+DG_STATE int		numnodes;
+DG_STATE node_t*		nodes;
 
-int		numlines;
-line_t*		lines;
+DG_STATE int		numlines;
+DG_STATE line_t*		lines;
 
-int		numsides;
-side_t*		sides;
+DG_STATE int		numsides;
+DG_STATE side_t*		sides;
 
-static int      totallines;
+static DG_STATE int      totallines;
 
 // BLOCKMAP
 // Created from axis aligned bounding box
@@ -79,16 +81,17 @@ static int      totallines;
 // by spatial subdivision in 2D.
 //
 // Blockmap size.
-int		bmapwidth;
-int		bmapheight;	// size in mapblocks
-short*		blockmap;	// int for larger maps
+DG_STATE int		bmapwidth;
+DG_STATE int		bmapheight;	// size in mapblocks
+DG_STATE short*		blockmap;	// int for larger maps
 // offsets in blockmap are from here
-short*		blockmaplump;		
+DG_STATE short*		blockmaplump;		
 // origin of block map
-fixed_t		bmaporgx;
-fixed_t		bmaporgy;
+DG_STATE fixed_t		bmaporgx;
+DG_STATE fixed_t		bmaporgy;
 // for thing chains
-mobj_t**	blocklinks;		
+DG_STATE mobj_t**	blocklinks;		
+DG_STATE blockcell_t*	blockcells;
 
 
 // REJECT
@@ -98,53 +101,165 @@ mobj_t**	blocklinks;
 // Without special effect, this could be
 //  used as a PVS lookup as well.
 //
-byte*		rejectmatrix;
+DG_STATE byte*		rejectmatrix;
 
 
 // Maintain single and multi player starting spots.
 #define MAX_DEATHMATCH_STARTS	10
 
-mapthing_t	deathmatchstarts[MAX_DEATHMATCH_STARTS];
-mapthing_t*	deathmatch_p;
-mapthing_t	playerstarts[MAXPLAYERS];
+DG_STATE mapthing_t	deathmatchstarts[MAX_DEATHMATCH_STARTS];
+DG_STATE mapthing_t*	deathmatch_p;
+DG_STATE mapthing_t	playerstarts[MAXPLAYERS];
 
 
 
 
 
+//
+// LEVEL LOADING TASKS
+// The P_Load* functions run on the main thread: they allocate the
+//  level arrays and cache the map lumps, which both go through the
+//  zone.  Converting the records from the lump into the arrays is
+//  queued as tasks, which only read the lump and write their own
+//  range of one array, so with worker threads (see -renderthreads)
+//  the conversions of one stage run at the same time.
+//  P_RunLoadTasks finishes a stage; see P_SetupLevel for the order.
+//
+// Arrays are split in up to one piece per worker,
+//  but not into pieces smaller than this.
+#define LOADCHUNK		512
+
+// Enough for the largest stage, with the most workers.
+#define MAXLOADTASKS		256
+#define MAXLOADLUMPS		16
+
+typedef void (*loadfunc_t) (byte* data, int start, int end);
+
+typedef struct
+{
+    loadfunc_t	func;
+    byte*	data;
+    int		start;
+    int		end;
+} loadtask_t;
+
+static DG_STATE loadtask_t	loadtasks[MAXLOADTASKS];
+static DG_STATE int		numloadtasks;
+
+// Lumps to release when the stage is finished.
+static DG_STATE int		loadlumps[MAXLOADLUMPS];
+static DG_STATE int		numloadlumps;
+
+
+//
+// P_CacheMapLump
+// Caches a lump, until the end of the stage.
+//
+static byte* P_CacheMapLump (int lump)
+{
+    if (numloadlumps == MAXLOADLUMPS)
+	I_Error ("P_CacheMapLump: too many lumps");
+
+    loadlumps[numloadlumps++] = lump;
+
+    return W_CacheLumpNum (lump, PU_STATIC);
+}
+
+
+//
+// P_AddLoadTasks
+// Queues func to convert records 0..count-1 of data.
+//
+static void
+P_AddLoadTasks
+( loadfunc_t	func,
+  byte*		data,
+  int		count )
+{
+    loadtask_t*	task;
+    int		pieces;
+    int		i;
+
+    pieces = count / LOADCHUNK;
+
+    if (pieces > I_NumWorkers ())
+	pieces = I_NumWorkers ();
+    if (pieces < 1)
+	pieces = 1;
+
+    if (numloadtasks + pieces > MAXLOADTASKS)
+	I_Error ("P_AddLoadTasks: too many tasks");
+
+    for (i=0 ; i<pieces ; i++)
+    {
+	task = &loadtasks[numloadtasks++];
+	task->func = func;
+	task->data = data;
+	task->start = (count * i) / pieces;
+	task->end = (count * (i+1)) / pieces;
+    }
+}
+
+
+static void P_RunLoadTask (void *data, int i)
+{
+    loadtask_t*	task;
+
+    task = (loadtask_t *) data + i;
+    task->func (task->data, task->start, task->end);
+}
+
+
+//
+// P_RunLoadTasks
+// Runs everything queued, and waits for it.
+//
+static void P_RunLoadTasks (void)
+{
+    int		i;
+
+    I_RunWorkers (P_RunLoadTask, loadtasks, numloadtasks);
+    numloadtasks = 0;
+
+    for (i=0 ; i<numloadlumps ; i++)
+	W_ReleaseLumpNum (loadlumps[i]);
+
+    numloadlumps = 0;
+}
+
+
+
 //
 // P_LoadVertexes
 //
-void P_LoadVertexes (int lump)
+static void P_ConvertVertexes (byte* data, int start, int end)
 {
-    byte*		data;
     int			i;
     mapvertex_t*	ml;
     vertex_t*		li;
 
-    // Determine number of lumps:
-    //  total lump length / vertex record length.
-    numvertexes = W_LumpLength (lump) / sizeof(mapvertex_t);
-
-    // Allocate zone memory for buffer.
-    vertexes = Z_Malloc (numvertexes*sizeof(vertex_t),PU_LEVEL,0);	
-
-    // Load data into cache.
-    data = W_CacheLumpNum (lump, PU_STATIC);
-	
-    ml = (mapvertex_t *)data;
-    li = vertexes;
+    ml = (mapvertex_t *)data + start;
+    li = vertexes + start;
 
     // Copy and convert vertex coordinates,
     // internal representation as fixed.
-    for (i=0 ; i<numvertexes ; i++, li++, ml++)
+    for (i=start ; i<end ; i++, li++, ml++)
     {
 	li->x = SHORT(ml->x)<<FRACBITS;
 	li->y = SHORT(ml->y)<<FRACBITS;
     }
+}
 
-    // Free buffer memory.
-    W_ReleaseLumpNum(lump);
+void P_LoadVertexes (int lump)
+{
+    // Determine number of lumps:
+    //  total lump length / vertex record length.
+    numvertexes = W_LumpLength (lump) / sizeof(mapvertex_t);
+
+    // Allocate zone memory for buffer.
+    vertexes = Z_Malloc (numvertexes*sizeof(vertex_t),PU_LEVEL,0);	
+
+    P_AddLoadTasks (P_ConvertVertexes, P_CacheMapLump (lump), numvertexes);
 }
 
 //
@@ -152,8 +267,8 @@ void P_LoadVertexes (int lump)
 //
 sector_t* GetSectorAtNullAddress(void)
 {
-    static boolean null_sector_is_initialized = false;
-    static sector_t null_sector;
+    static DG_STATE boolean null_sector_is_initialized = false;
+    static DG_STATE sector_t null_sector;
 
     if (!null_sector_is_initialized)
     {
@@ -169,9 +284,8 @@ sector_t* GetSectorAtNullAddress(void)
 //
 // P_LoadSegs
 //
-void P_LoadSegs (int lump)
+static void P_ConvertSegs (byte* data, int start, int end)
 {
-    byte*		data;
     int			i;
     mapseg_t*		ml;
     seg_t*		li;
@@ -180,14 +294,9 @@ void P_LoadSegs (int lump)
     int			side;
     int                 sidenum;
 	
-    numsegs = W_LumpLength (lump) / sizeof(mapseg_t);
-    segs = Z_Malloc (numsegs*sizeof(seg_t),PU_LEVEL,0);	
-    memset (segs, 0, numsegs*sizeof(seg_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
-    ml = (mapseg_t *)data;
-    li = segs;
-    for (i=0 ; i<numsegs ; i++, li++, ml++)
+    ml = (mapseg_t *)data + start;
+    li = segs + start;
+    for (i=start ; i<end ; i++, li++, ml++)
     {
 	li->v1 = &vertexes[SHORT(ml->v1)];
 	li->v2 = &vertexes[SHORT(ml->v2)];
@@ -225,36 +334,48 @@ void P_LoadSegs (int lump)
 	    li->backsector = 0;
         }
     }
-	
-    W_ReleaseLumpNum(lump);
+}
+
+void P_LoadSegs (int lump)
+{
+    numsegs = W_LumpLength (lump) / sizeof(mapseg_t);
+    segs = Z_Malloc (numsegs*sizeof(seg_t),PU_LEVEL,0);	
+    memset (segs, 0, numsegs*sizeof(seg_t));
+
+    // Set up the null sector here rather than in a task.
+    GetSectorAtNullAddress ();
+
+    P_AddLoadTasks (P_ConvertSegs, P_CacheMapLump (lump), numsegs);
 }
 
 
 //
 // P_LoadSubsectors
 //
-void P_LoadSubsectors (int lump)
+static void P_ConvertSubsectors (byte* data, int start, int end)
 {
-    byte*		data;
     int			i;
     mapsubsector_t*	ms;
     subsector_t*	ss;
 	
-    numsubsectors = W_LumpLength (lump) / sizeof(mapsubsector_t);
-    subsectors = Z_Malloc (numsubsectors*sizeof(subsector_t),PU_LEVEL,0);	
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
-    ms = (mapsubsector_t *)data;
-    memset (subsectors,0, numsubsectors*sizeof(subsector_t));
-    ss = subsectors;
+    ms = (mapsubsector_t *)data + start;
+    ss = subsectors + start;
     
-    for (i=0 ; i<numsubsectors ; i++, ss++, ms++)
+    for (i=start ; i<end ; i++, ss++, ms++)
     {
 	ss->numlines = SHORT(ms->numsegs);
 	ss->firstline = SHORT(ms->firstseg);
     }
-	
-    W_ReleaseLumpNum(lump);
+}
+
+void P_LoadSubsectors (int lump)
+{
+    numsubsectors = W_LumpLength (lump) / sizeof(mapsubsector_t);
+    subsectors = Z_Malloc (numsubsectors*sizeof(subsector_t),PU_LEVEL,0);	
+    memset (subsectors,0, numsubsectors*sizeof(subsector_t));
+
+    P_AddLoadTasks (P_ConvertSubsectors, P_CacheMapLump (lump),
+		    numsubsectors);
 }
 
 
@@ -262,56 +383,66 @@ void P_LoadSubsectors (int lump)
 //
 // P_LoadSectors
 //
+static void P_ConvertSectors (byte* data, int start, int end)
+{
+    int			i;
+    mapsector_t*	ms;
+    sector_t*		ss;
+	
+    ms = (mapsector_t *)data + start;
+    ss = sectors + start;
+    for (i=start ; i<end ; i++, ss++, ms++)
+    {
+	ss->floorheight = SHORT(ms->floorheight)<<FRACBITS;
+	ss->ceilingheight = SHORT(ms->ceilingheight)<<FRACBITS;
+	ss->lightlevel = SHORT(ms->lightlevel);
+	ss->special = SHORT(ms->special);
+	ss->tag = SHORT(ms->tag);
+	ss->thinglist = NULL;
+    }
+}
+
 void P_LoadSectors (int lump)
 {
     byte*		data;
     int			i;
     mapsector_t*	ms;
     sector_t*		ss;
-	
+
     numsectors = W_LumpLength (lump) / sizeof(mapsector_t);
     sectors = Z_Malloc (numsectors*sizeof(sector_t),PU_LEVEL,0);	
     memset (sectors, 0, numsectors*sizeof(sector_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
+    data = P_CacheMapLump (lump);
+
+    // Flat names are looked up here, not in the tasks: an unknown
+    //  name is an I_Error, which must not happen on a worker thread.
     ms = (mapsector_t *)data;
     ss = sectors;
     for (i=0 ; i<numsectors ; i++, ss++, ms++)
     {
-	ss->floorheight = SHORT(ms->floorheight)<<FRACBITS;
-	ss->ceilingheight = SHORT(ms->ceilingheight)<<FRACBITS;
 	ss->floorpic = R_FlatNumForName(ms->floorpic);
 	ss->ceilingpic = R_FlatNumForName(ms->ceilingpic);
-	ss->lightlevel = SHORT(ms->lightlevel);
-	ss->special = SHORT(ms->special);
-	ss->tag = SHORT(ms->tag);
-	ss->thinglist = NULL;
     }
-	
-    W_ReleaseLumpNum(lump);
+
+    P_AddLoadTasks (P_ConvertSectors, data, numsectors);
 }
 
 
 //
 // P_LoadNodes
 //
-void P_LoadNodes (int lump)
+static void P_ConvertNodes (byte* data, int start, int end)
 {
-    byte*	data;
     int		i;
     int		j;
     int		k;
     mapnode_t*	mn;
     node_t*	no;
 	
-    numnodes = W_LumpLength (lump) / sizeof(mapnode_t);
-    nodes = Z_Malloc (numnodes*sizeof(node_t),PU_LEVEL,0);	
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
-    mn = (mapnode_t *)data;
-    no = nodes;
+    mn = (mapnode_t *)data + start;
+    no = nodes + start;
     
-    for (i=0 ; i<numnodes ; i++, no++, mn++)
+    for (i=start ; i<end ; i++, no++, mn++)
     {
 	no->x = SHORT(mn->x)<<FRACBITS;
 	no->y = SHORT(mn->y)<<FRACBITS;
@@ -324,8 +455,14 @@ void P_LoadNodes (int lump)
 		no->bbox[j][k] = SHORT(mn->bbox[j][k])<<FRACBITS;
 	}
     }
-	
-    W_ReleaseLumpNum(lump);
+}
+
+void P_LoadNodes (int lump)
+{
+    numnodes = W_LumpLength (lump) / sizeof(mapnode_t);
+    nodes = Z_Malloc (numnodes*sizeof(node_t),PU_LEVEL,0);	
+
+    P_AddLoadTasks (P_ConvertNodes, P_CacheMapLump (lump), numnodes);
 }
 
 
@@ -389,23 +526,17 @@ void P_LoadThings (int lump)
 // P_LoadLineDefs
 // Also counts secret lines for intermissions.
 //
-void P_LoadLineDefs (int lump)
+static void P_ConvertLineDefs (byte* data, int start, int end)
 {
-    byte*		data;
     int			i;
     maplinedef_t*	mld;
     line_t*		ld;
     vertex_t*		v1;
     vertex_t*		v2;
 	
-    numlines = W_LumpLength (lump) / sizeof(maplinedef_t);
-    lines = Z_Malloc (numlines*sizeof(line_t),PU_LEVEL,0);	
-    memset (lines, 0, numlines*sizeof(line_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
-    mld = (maplinedef_t *)data;
-    ld = lines;
-    for (i=0 ; i<numlines ; i++, mld++, ld++)
+    mld = (maplinedef_t *)data + start;
+    ld = lines + start;
+    for (i=start ; i<end ; i++, mld++, ld++)
     {
 	ld->flags = SHORT(mld->flags);
 	ld->special = SHORT(mld->special);
@@ -462,48 +593,81 @@ void P_LoadLineDefs (int lump)
 	else
 	    ld->backsector = 0;
     }
+}
 
-    W_ReleaseLumpNum(lump);
+void P_LoadLineDefs (int lump)
+{
+    numlines = W_LumpLength (lump) / sizeof(maplinedef_t);
+    lines = Z_Malloc (numlines*sizeof(line_t),PU_LEVEL,0);	
+    memset (lines, 0, numlines*sizeof(line_t));
+
+    P_AddLoadTasks (P_ConvertLineDefs, P_CacheMapLump (lump), numlines);
 }
 
 
 //
 // P_LoadSideDefs
 //
+static void P_ConvertSideDefs (byte* data, int start, int end)
+{
+    int			i;
+    mapsidedef_t*	msd;
+    side_t*		sd;
+	
+    msd = (mapsidedef_t *)data + start;
+    sd = sides + start;
+    for (i=start ; i<end ; i++, msd++, sd++)
+    {
+	sd->textureoffset = SHORT(msd->textureoffset)<<FRACBITS;
+	sd->rowoffset = SHORT(msd->rowoffset)<<FRACBITS;
+	sd->sector = &sectors[SHORT(msd->sector)];
+    }
+}
+
 void P_LoadSideDefs (int lump)
 {
     byte*		data;
     int			i;
     mapsidedef_t*	msd;
     side_t*		sd;
-	
+
     numsides = W_LumpLength (lump) / sizeof(mapsidedef_t);
     sides = Z_Malloc (numsides*sizeof(side_t),PU_LEVEL,0);	
     memset (sides, 0, numsides*sizeof(side_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
+    data = P_CacheMapLump (lump);
+
+    // Texture names are looked up here, not in the tasks, for the same
+    //  reason as the flats in P_LoadSectors.
     msd = (mapsidedef_t *)data;
     sd = sides;
     for (i=0 ; i<numsides ; i++, msd++, sd++)
     {
-	sd->textureoffset = SHORT(msd->textureoffset)<<FRACBITS;
-	sd->rowoffset = SHORT(msd->rowoffset)<<FRACBITS;
 	sd->toptexture = R_TextureNumForName(msd->toptexture);
 	sd->bottomtexture = R_TextureNumForName(msd->bottomtexture);
 	sd->midtexture = R_TextureNumForName(msd->midtexture);
-	sd->sector = &sectors[SHORT(msd->sector)];
     }
 
-    W_ReleaseLumpNum(lump);
+    P_AddLoadTasks (P_ConvertSideDefs, data, numsides);
 }
 
 
 //
 // P_LoadBlockMap
 //
-void P_LoadBlockMap (int lump)
+static void P_ConvertBlockMap (byte* data, int start, int end)
 {
     int i;
+
+    // Swap all short integers to native byte ordering.
+  
+    for (i=start; i<end; i++)
+    {
+	blockmaplump[i] = SHORT(blockmaplump[i]);
+    }
+}
+
+void P_LoadBlockMap (int lump)
+{
     int count;
     int lumplen;
 
@@ -514,25 +678,29 @@ void P_LoadBlockMap (int lump)
     W_ReadLump(lump, blockmaplump);
     blockmap = blockmaplump + 4;
 
-    // Swap all short integers to native byte ordering.
-  
-    for (i=0; i<count; i++)
-    {
-	blockmaplump[i] = SHORT(blockmaplump[i]);
-    }
-		
-    // Read the header
+    // Read the header; the rest is swapped by a task.
 
-    bmaporgx = blockmaplump[0]<<FRACBITS;
-    bmaporgy = blockmaplump[1]<<FRACBITS;
-    bmapwidth = blockmaplump[2];
-    bmapheight = blockmaplump[3];
+    bmaporgx = SHORT(blockmaplump[0])<<FRACBITS;
+    bmaporgy = SHORT(blockmaplump[1])<<FRACBITS;
+    bmapwidth = SHORT(blockmaplump[2]);
+    bmapheight = SHORT(blockmaplump[3]);
+
+    P_AddLoadTasks (P_ConvertBlockMap, NULL, count);
 	
     // Clear out mobj chains
 
-    count = sizeof(*blocklinks) * bmapwidth * bmapheight;
-    blocklinks = Z_Malloc(count, PU_LEVEL, 0);
-    memset(blocklinks, 0, count);
+    if (thinggrid)
+    {
+        count = sizeof(*blockcells) * bmapwidth * bmapheight;
+        blockcells = Z_Malloc(count, PU_LEVEL, 0);
+        memset(blockcells, 0, count);
+    }
+    else
+    {
+        count = sizeof(*blocklinks) * bmapwidth * bmapheight;
+        blocklinks = Z_Malloc(count, PU_LEVEL, 0);
+        memset(blocklinks, 0, count);
+    }
 }
 
 
@@ -768,8 +936,8 @@ P_SetupLevel
 
     Z_FreeTags (PU_LEVEL, PU_PURGELEVEL-1);
 
-    // UNUSED W_Profile ();
     P_InitThinkers ();
+    P_InitThinkerPools ();
 	   
     // find map name
     if ( gamemode == commercial)
@@ -789,6 +957,8 @@ P_SetupLevel
     }
 
     lumpnum = W_GetNumForName (lumpname);
+
+    PROF_MAP (lumpname);
 	
     leveltime = 0;
 	
@@ -798,13 +968,22 @@ P_SetupLevel
     P_LoadSectors (lumpnum+ML_SECTORS);
     P_LoadSideDefs (lumpnum+ML_SIDEDEFS);
 
+    // linedefs need the vertexes and the sectors of the sidedefs
+    P_RunLoadTasks ();
+
     P_LoadLineDefs (lumpnum+ML_LINEDEFS);
     P_LoadSubsectors (lumpnum+ML_SSECTORS);
     P_LoadNodes (lumpnum+ML_NODES);
+
+    // segs need the linedefs
+    P_RunLoadTasks ();
+
     P_LoadSegs (lumpnum+ML_SEGS);
+    P_RunLoadTasks ();
 
     P_GroupLines ();
     P_LoadReject (lumpnum+ML_REJECT);
+    P_InitSight ();
 
     bodyqueslot = 0;
     deathmatch_p = deathmatchstarts;
@@ -846,6 +1025,27 @@ P_SetupLevel
 //
 void P_Init (void)
 {
+    //!
+    // @category obscure
+    //
+    // Keep the things in each mapblock on linked lists through the
+    // mobjs, as Vanilla Doom does, instead of in arrays.
+    //
+
+    thinggrid = !M_CheckParm ("-nothinggrid");
+
+    //!
+    // @category game
+    //
+    // Do the sight checks of monsters about to look or chase on the
+    // -renderthreads worker threads, all at the start of each tic.
+    // Monsters then act on where things were at the start of the
+    // tic, so demos go out of sync, but play stays the same from run
+    // to run however many threads there are.
+    //
+
+    parallelai = M_CheckParm ("-parallelai") > 0;
+
     P_InitSwitchList ();
     P_InitPicAnims ();
     R_InitSprites (sprnames);
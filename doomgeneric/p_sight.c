@@ -18,26 +18,93 @@
 
 
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "doomdef.h"
 
 #include "i_system.h"
+#include "i_thread.h"
+#include "m_argv.h"
 #include "p_local.h"
+#include "z_zone.h"
 
 // State.
 #include "r_state.h"
 
 //
 // P_CheckSight
+// The worker threads can trace sight lines too; see SIGHT QUERIES.
 //
-fixed_t		sightzstart;		// eye z of looker
-fixed_t		topslope;
-fixed_t		bottomslope;		// slopes to top and bottom of target
+DG_THREAD_LOCAL fixed_t		sightzstart;		// eye z of looker
+DG_THREAD_LOCAL fixed_t		topslope;
+DG_THREAD_LOCAL fixed_t		bottomslope;		// slopes to top and bottom of target
+
+DG_THREAD_LOCAL divline_t	strace;			// from t1 to t2
+DG_THREAD_LOCAL fixed_t		t2x;
+DG_THREAD_LOCAL fixed_t		t2y;
 
-divline_t	strace;			// from t1 to t2
-fixed_t		t2x;
-fixed_t		t2y;
+// Set on the worker threads, which must not touch validcount.  The
+//  answer is the same without it; it only saves looking at a line
+//  again from its other side.
+static DG_THREAD_LOCAL boolean	sightnovalidcount;
 
-int		sightcounts[2];
+DG_STATE int		sightcounts[2];
+
+
+//
+// SIGHT CACHE
+// The result of P_CheckSight depends only on where the two things
+//  are, how tall they are, and the heights of the sectors, so it is
+//  remembered until a floor or ceiling moves.  Monsters that are
+//  standing around keep looking at players that are standing still.
+//
+#define SIGHTCACHESIZE	512
+
+typedef struct
+{
+    fixed_t		x1, y1, z1, height1;
+    fixed_t		x2, y2, z2, height2;
+    subsector_t*	ss1;
+    subsector_t*	ss2;
+    int			generation;
+    boolean		result;
+} sightcache_t;
+
+static DG_STATE sightcache_t	sightcache[SIGHTCACHESIZE];
+static DG_STATE int		sightgeneration = 1;
+
+// With -sightgroups, the sector each sector can be reached from
+//  through two-sided lines; see P_InitSight.
+static DG_STATE boolean		usesightgroups;
+static DG_STATE int*		sightgroups;
+
+
+//
+// SIGHT QUERIES
+// With -parallelai, the sight checks that monsters are about to make
+//  are queued before the thinkers run, and traced all at once on the
+//  worker threads from where everything is at the start of the tic.
+//  Until the queries are cleared, P_CheckSight gives those answers,
+//  even if one of the things has moved since.
+//
+typedef struct
+{
+    mobj_t*	t1;
+    mobj_t*	t2;
+    boolean	result;
+} sightquery_t;
+
+// Queries traced by one task.
+#define SIGHTQUERYCHUNK	64
+
+static DG_STATE sightquery_t*	sightqueries;
+static DG_STATE int		numsightqueries;
+static DG_STATE int		maxsightqueries;
+
+// Index + 1 of the query for a pair, or 0.
+static DG_STATE int*		sightqueryhash;
+static DG_STATE int		sightqueryhashsize;
 
 
 //
@@ -160,11 +227,14 @@ boolean P_CrossSubsector (int num)
     {
 	line = seg->linedef;
 
-	// allready checked other side?
-	if (line->validcount == validcount)
-	    continue;
+	if (!sightnovalidcount)
+	{
+	    // allready checked other side?
+	    if (line->validcount == validcount)
+		continue;
 	
-	line->validcount = validcount;
+	    line->validcount = validcount;
+	}
 
 	v1 = line->v1;
 	v2 = line->v2;
@@ -292,23 +362,92 @@ boolean P_CrossBSPNode (int bspnum)
 
 
 //
-// P_CheckSight
-// Returns true
-//  if a straight line between t1 and t2 is unobstructed.
-// Uses REJECT.
+// P_ClearSightCache
+// Call whenever a floor or ceiling height changes.
 //
-boolean
-P_CheckSight
-( mobj_t*	t1,
-  mobj_t*	t2 )
+void P_ClearSightCache (void)
+{
+    sightgeneration++;
+}
+
+
+//
+// P_InitSight
+// Call at level load, after the lines are grouped by sector.
+//
+void P_InitSight (void)
+{
+    line_t*	line;
+    int		front;
+    int		back;
+    int		i;
+
+    P_ClearSightCache ();
+
+    //!
+    // @category game
+    //
+    // Treat sectors that cannot be reached from each other through
+    // two-sided lines as if REJECT said they can't see each other.
+    // Vanilla Doom can sometimes see through walls, so this can
+    // make demos go out of sync.
+    //
+
+    usesightgroups = M_CheckParm ("-sightgroups") > 0;
+
+    if (!usesightgroups)
+	return;
+
+    // Start with every sector in its own group, and join the groups
+    //  on the two sides of each two-sided line.
+    sightgroups = Z_Malloc (numsectors * sizeof(*sightgroups), PU_LEVEL, 0);
+
+    for (i=0 ; i<numsectors ; i++)
+	sightgroups[i] = i;
+
+    for (i=0, line = lines ; i<numlines ; i++, line++)
+    {
+	if (line->backsector == NULL)
+	    continue;
+
+	front = line->frontsector - sectors;
+	back = line->backsector - sectors;
+
+	while (sightgroups[front] != front)
+	    front = sightgroups[front];
+	while (sightgroups[back] != back)
+	    back = sightgroups[back];
+
+	if (front < back)
+	    sightgroups[back] = front;
+	else
+	    sightgroups[front] = back;
+    }
+
+    // Point every sector straight at its group.
+    for (i=0 ; i<numsectors ; i++)
+    {
+	front = i;
+
+	while (sightgroups[front] != front)
+	    front = sightgroups[front];
+
+	sightgroups[i] = front;
+    }
+}
+
+
+//
+// P_SightRejected
+// True if REJECT (or the sight groups) say t1 can't see t2.
+//
+static boolean P_SightRejected (mobj_t* t1, mobj_t* t2)
 {
     int		s1;
     int		s2;
     int		pnum;
     int		bytenum;
     int		bitnum;
-    
-    // First check for trivial rejection.
 
     // Determine subsector entries in REJECT table.
     s1 = (t1->subsector->sector - sectors);
@@ -319,18 +458,20 @@ P_CheckSight
 
     // Check in REJECT table.
     if (rejectmatrix[bytenum]&bitnum)
-    {
-	sightcounts[0]++;
+	return true;
 
-	// can't possibly be connected
-	return false;	
-    }
+    return usesightgroups && sightgroups[s1] != sightgroups[s2];
+}
 
-    // An unobstructed LOS is possible.
-    // Now look from eyes of t1 to any part of t2.
-    sightcounts[1]++;
 
-    validcount++;
+//
+// P_TraceSight
+// Looks from the eyes of t1 to any part of t2 through the BSP.
+//
+static boolean P_TraceSight (mobj_t* t1, mobj_t* t2)
+{
+    if (!sightnovalidcount)
+	validcount++;
 	
     sightzstart = t1->z + t1->height - (t1->height>>2);
     topslope = (t2->z+t2->height) - sightzstart;
@@ -344,7 +485,251 @@ P_CheckSight
     strace.dy = t2->y - t1->y;
 
     // the head node is the last node output
-    return P_CrossBSPNode (numnodes-1);	
+    return P_CrossBSPNode (numnodes-1);
+}
+
+
+static int P_QueryHash (mobj_t* t1, mobj_t* t2)
+{
+    uintptr_t	hash;
+
+    hash = (uintptr_t) t1 * 31 + (uintptr_t) t2;
+    hash ^= hash >> 7;
+    hash ^= hash >> 17;
+
+    return hash & (sightqueryhashsize-1);
+}
+
+
+//
+// P_AddSightQuery
+// Queues a sight check of t2 from t1 for P_RunSightQueries.
+//
+void P_AddSightQuery (mobj_t* t1, mobj_t* t2)
+{
+    sightquery_t*	query;
+
+    if (numsightqueries == maxsightqueries)
+    {
+	sightqueries = R_GrowArray (sightqueries, &maxsightqueries,
+				    sizeof(*sightqueries), 256);
+    }
+
+    query = &sightqueries[numsightqueries++];
+    query->t1 = t1;
+    query->t2 = t2;
+}
+
+
+static void P_RunSightQueryTask (void* data, int task)
+{
+    sightquery_t*	query;
+    int			i;
+    int			end;
+
+    sightnovalidcount = true;
+
+    i = task * SIGHTQUERYCHUNK;
+    end = i + SIGHTQUERYCHUNK;
+
+    if (end > numsightqueries)
+	end = numsightqueries;
+
+    for ( ; i<end ; i++)
+    {
+	query = &sightqueries[i];
+	query->result = !P_SightRejected (query->t1, query->t2)
+			&& P_TraceSight (query->t1, query->t2);
+    }
+
+    sightnovalidcount = false;
+}
+
+
+//
+// P_RunSightQueries
+// Traces everything queued, and makes the answers available to
+//  P_CheckSight.
+//
+void P_RunSightQueries (void)
+{
+    int		numtasks;
+    int		i;
+    int		h;
+
+    if (numsightqueries == 0)
+	return;
+
+    numtasks = (numsightqueries + SIGHTQUERYCHUNK - 1) / SIGHTQUERYCHUNK;
+    I_RunWorkers (P_RunSightQueryTask, NULL, numtasks);
+
+    // Hash the pairs, with the table at most half full.
+    if (sightqueryhashsize < numsightqueries * 2)
+    {
+	free (sightqueryhash);
+
+	if (sightqueryhashsize == 0)
+	    sightqueryhashsize = 512;
+	while (sightqueryhashsize < numsightqueries * 2)
+	    sightqueryhashsize *= 2;
+
+	sightqueryhash = malloc (sightqueryhashsize * sizeof(*sightqueryhash));
+
+	if (sightqueryhash == NULL)
+	    I_Error ("P_RunSightQueries: out of memory");
+    }
+
+    memset (sightqueryhash, 0, sightqueryhashsize * sizeof(*sightqueryhash));
+
+    for (i=0 ; i<numsightqueries ; i++)
+    {
+	h = P_QueryHash (sightqueries[i].t1, sightqueries[i].t2);
+
+	while (sightqueryhash[h])
+	    h = (h+1) & (sightqueryhashsize-1);
+
+	sightqueryhash[h] = i + 1;
+    }
+}
+
+
+//
+// P_ClearSightQueries
+//
+void P_ClearSightQueries (void)
+{
+    numsightqueries = 0;
+}
+
+
+//
+// P_ForgetSightQueries
+// Drops the answers involving a thing that is being removed.  Its
+//  memory goes back to the thinker pool and may be handed straight
+//  to a new thing spawned this tic, which must not get the old
+//  thing's answers.
+//
+void P_ForgetSightQueries (mobj_t* mo)
+{
+    sightquery_t*	query;
+    int			i;
+
+    for (i=0 ; i<numsightqueries ; i++)
+    {
+	query = &sightqueries[i];
+
+	// Left in the hash chain, but never matched again.
+	if (query->t1 == mo || query->t2 == mo)
+	{
+	    query->t1 = NULL;
+	    query->t2 = NULL;
+	}
+    }
+}
+
+
+static sightquery_t* P_FindSightQuery (mobj_t* t1, mobj_t* t2)
+{
+    sightquery_t*	query;
+    int			h;
+
+    h = P_QueryHash (t1, t2);
+
+    while (sightqueryhash[h])
+    {
+	query = &sightqueries[sightqueryhash[h] - 1];
+
+	if (query->t1 == t1 && query->t2 == t2)
+	    return query;
+
+	h = (h+1) & (sightqueryhashsize-1);
+    }
+
+    return NULL;
+}
+
+
+static int P_SightHash (mobj_t* t1, mobj_t* t2)
+{
+    unsigned int	hash;
+
+    hash = t1->x ^ (t1->y * 3) ^ (t1->z * 5);
+    hash = hash * 31 + (t2->x ^ (t2->y * 3) ^ (t2->z * 5));
+    hash ^= hash >> 16;
+
+    return (hash ^ (hash >> 9)) & (SIGHTCACHESIZE-1);
+}
+
+
+//
+// P_CheckSight
+// Returns true
+//  if a straight line between t1 and t2 is unobstructed.
+// Uses REJECT.
+//
+boolean
+P_CheckSight
+( mobj_t*	t1,
+  mobj_t*	t2 )
+{
+    sightcache_t*	cache;
+    sightquery_t*	query;
+    
+    // First check for trivial rejection.
+    if (P_SightRejected (t1, t2))
+    {
+	sightcounts[0]++;
+
+	// can't possibly be connected
+	return false;	
+    }
+
+    // Worked out at the start of the tic?
+    if (numsightqueries > 0)
+    {
+	query = P_FindSightQuery (t1, t2);
+
+	if (query != NULL)
+	    return query->result;
+    }
+
+    // Looked at from here before?
+    cache = &sightcache[P_SightHash (t1, t2)];
+
+    if (cache->generation == sightgeneration
+	&& cache->x1 == t1->x
+	&& cache->y1 == t1->y
+	&& cache->z1 == t1->z
+	&& cache->height1 == t1->height
+	&& cache->x2 == t2->x
+	&& cache->y2 == t2->y
+	&& cache->z2 == t2->z
+	&& cache->height2 == t2->height
+	&& cache->ss1 == t1->subsector
+	&& cache->ss2 == t2->subsector)
+    {
+	return cache->result;
+    }
+
+    cache->generation = sightgeneration;
+    cache->x1 = t1->x;
+    cache->y1 = t1->y;
+    cache->z1 = t1->z;
+    cache->height1 = t1->height;
+    cache->x2 = t2->x;
+    cache->y2 = t2->y;
+    cache->z2 = t2->z;
+    cache->height2 = t2->height;
+    cache->ss1 = t1->subsector;
+    cache->ss2 = t2->subsector;
+
+    // An unobstructed LOS is possible.
+    // Now look from eyes of t1 to any part of t2.
+    sightcounts[1]++;
+
+    cache->result = P_TraceSight (t1, t2);
+
+    return cache->result;
 }
 
 
@@ -77,8 +77,8 @@ typedef struct
 
 #define MAXANIMS                32
 
-extern anim_t	anims[MAXANIMS];
-extern anim_t*	lastanim;
+extern DG_STATE anim_t	anims[MAXANIMS];
+extern DG_STATE anim_t*	lastanim;
 
 //
 // P_InitPicAnims
@@ -126,8 +126,8 @@ animdef_t		animdefs[] =
     {-1,        "",             "",             0},
 };
 
-anim_t		anims[MAXANIMS];
-anim_t*		lastanim;
+DG_STATE anim_t		anims[MAXANIMS];
+DG_STATE anim_t*		lastanim;
 
 
 //
@@ -135,8 +135,8 @@ anim_t*		lastanim;
 //
 #define MAXLINEANIMS            64
 
-extern  short	numlinespecials;
-extern  line_t*	linespeciallist[MAXLINEANIMS];
+extern DG_STATE  short	numlinespecials;
+extern DG_STATE  line_t*	linespeciallist[MAXLINEANIMS];
 
 
 
@@ -1087,8 +1087,8 @@ void P_PlayerInSpecialSector (player_t* player)
 // P_UpdateSpecials
 // Animate planes, scroll walls, etc.
 //
-boolean		levelTimer;
-int		levelTimeCount;
+DG_STATE boolean		levelTimer;
+DG_STATE int		levelTimeCount;
 
 void P_UpdateSpecials (void)
 {
@@ -1178,11 +1178,11 @@ void P_UpdateSpecials (void)
 static void DonutOverrun(fixed_t *s3_floorheight, short *s3_floorpic,
                          line_t *line, sector_t *pillar_sector)
 {
-    static int first = 1;
-    static int tmp_s3_floorheight;
-    static int tmp_s3_floorpic;
+    static DG_STATE int first = 1;
+    static DG_STATE int tmp_s3_floorheight;
+    static DG_STATE int tmp_s3_floorpic;
 
-    extern int numflats;
+    extern DG_STATE int numflats;
 
     if (first)
     {
@@ -1325,7 +1325,7 @@ int EV_DoDonut(line_t*	line)
             }
 
 	    //	Spawn rising slime
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+	    floor = P_AllocThinker (tp_floor);
 	    P_AddThinker (&floor->thinker);
 	    s2->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1) T_MoveFloor;
@@ -1339,7 +1339,7 @@ int EV_DoDonut(line_t*	line)
 	    floor->floordestheight = s3_floorheight;
 	    
 	    //	Spawn lowering donut-hole
-	    floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+	    floor = P_AllocThinker (tp_floor);
 	    P_AddThinker (&floor->thinker);
 	    s1->specialdata = floor;
 	    floor->thinker.function.acp1 = (actionf_p1) T_MoveFloor;
@@ -1366,8 +1366,8 @@ int EV_DoDonut(line_t*	line)
 // After the map has been loaded, scan for specials
 //  that spawn thinkers
 //
-short		numlinespecials;
-line_t*		linespeciallist[MAXLINEANIMS];
+DG_STATE short		numlinespecials;
+DG_STATE line_t*		linespeciallist[MAXLINEANIMS];
 
 
 // Parses command line parameters.
@@ -27,8 +27,8 @@
 //
 // End-level timer (-TIMER option)
 //
-extern	boolean levelTimer;
-extern	int	levelTimeCount;
+extern DG_STATE	boolean levelTimer;
+extern DG_STATE	int	levelTimeCount;
 
 
 //      Define values for map objects
@@ -175,6 +175,7 @@ typedef struct
 #define FASTDARK			15
 #define SLOWDARK			35
 
+void    T_FireFlicker (fireflicker_t* flick);
 void    P_SpawnFireFlicker (sector_t* sector);
 void    T_LightFlash (lightflash_t* flash);
 void    P_SpawnLightFlash (sector_t* sector);
@@ -243,7 +244,7 @@ typedef struct
  // 1 second, in ticks. 
 #define BUTTONTIME      35             
 
-extern button_t	buttonlist[MAXBUTTONS]; 
+extern DG_STATE button_t	buttonlist[MAXBUTTONS]; 
 
 void
 P_ChangeSwitchTexture
@@ -303,7 +304,7 @@ typedef struct
 #define MAXPLATS		30
 
 
-extern plat_t*	activeplats[MAXPLATS];
+extern DG_STATE plat_t*	activeplats[MAXPLATS];
 
 void    T_PlatRaise(plat_t*	plat);
 
@@ -514,7 +515,7 @@ typedef struct
 #define CEILWAIT		150
 #define MAXCEILINGS		30
 
-extern ceiling_t*	activeceilings[MAXCEILINGS];
+extern DG_STATE ceiling_t*	activeceilings[MAXCEILINGS];
 
 int
 EV_DoCeiling
@@ -90,9 +90,9 @@ switchlist_t alphSwitchList[] =
     {"\0",		"\0",		0}
 };
 
-int		switchlist[MAXSWITCHES * 2];
-int		numswitches;
-button_t        buttonlist[MAXBUTTONS];
+DG_STATE int		switchlist[MAXSWITCHES * 2];
+DG_STATE int		numswitches;
+DG_STATE button_t        buttonlist[MAXBUTTONS];
 
 //
 // P_InitSwitchList
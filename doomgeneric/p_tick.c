@@ -18,17 +18,20 @@
 //
 
 
+#include <string.h>
+
 #include "z_zone.h"
+#include "m_prof.h"
 #include "p_local.h"
 
 #include "doomstat.h"
 
 
-int	leveltime;
+DG_STATE int	leveltime;
 
 //
 // THINKERS
-// All thinkers should be allocated by Z_Malloc
+// All thinkers should be allocated by P_AllocThinker
 // so they can be operated on uniformly.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
@@ -37,7 +40,40 @@ int	leveltime;
 
 
 // Both the head and tail of the thinker list.
-thinker_t	thinkercap;
+DG_STATE thinker_t	thinkercap;
+
+DG_STATE thinkerpool_t	thinkerpools[NUMTHINKERPOOLS];
+
+static const int thinkersizes[NUMTHINKERPOOLS] =
+{
+    sizeof(mobj_t),
+    sizeof(ceiling_t),
+    sizeof(vldoor_t),
+    sizeof(floormove_t),
+    sizeof(plat_t),
+    sizeof(lightflash_t),
+    sizeof(strobe_t),
+    sizeof(glow_t),
+    sizeof(fireflicker_t),
+};
+
+// Thinkers allocated from the zone at a time when a pool runs dry.
+#define THINKERCHUNK	64
+
+// Glowing and strobing lights only ever change their own sector's
+//  light level; there are hundreds of them on some maps.
+static const boolean thinkerbatched[NUMTHINKERPOOLS] =
+{
+    false,		// tp_mobj
+    false,		// tp_ceiling
+    false,		// tp_door
+    false,		// tp_floor
+    false,		// tp_plat
+    false,		// tp_flash: P_Random
+    true,		// tp_strobe
+    true,		// tp_glow
+    false,		// tp_flicker: P_Random
+};
 
 
 //
@@ -51,12 +87,149 @@ void P_InitThinkers (void)
 
 
 
+//
+// P_InitThinkerPools
+// Empties the pools; call after the PU_LEVEL blocks they were
+//  carved from have been freed.
+//
+void P_InitThinkerPools (void)
+{
+    int		i;
+
+    for (i=0 ; i<NUMTHINKERPOOLS ; i++)
+    {
+	thinkerpools[i].size = thinkersizes[i];
+	thinkerpools[i].free = NULL;
+	thinkerpools[i].chunks = NULL;
+	thinkerpools[i].batched = thinkerbatched[i];
+    }
+}
+
+
+
+//
+// P_AllocThinker
+// Returns a zeroed thinker of the given kind.
+//
+void* P_AllocThinker (thinkerpooltype_t type)
+{
+    thinkerpool_t*	pool;
+    thinkerchunk_t*	chunk;
+    thinker_t*		thinker;
+    int			i;
+
+    pool = &thinkerpools[type];
+
+    if (pool->free == NULL)
+    {
+	chunk = Z_Malloc (sizeof(*chunk) + THINKERCHUNK * pool->size,
+			  PU_LEVEL, NULL);
+	chunk->next = pool->chunks;
+	pool->chunks = chunk;
+
+	// Chain the new thinkers up back to front, so that they are
+	//  handed out in address order.
+	for (i=THINKERCHUNK-1 ; i>=0 ; i--)
+	{
+	    thinker = (thinker_t *) ((byte *) (chunk + 1) + i * pool->size);
+	    thinker->function.acv = NULL;
+	    thinker->next = pool->free;
+	    pool->free = thinker;
+	}
+    }
+
+    thinker = pool->free;
+    pool->free = thinker->next;
+
+    memset (thinker, 0, pool->size);
+    thinker->pool = pool;
+
+    return thinker;
+}
+
+
+
+//
+// P_FreeThinker
+// Gives back a thinker that is no longer on the list to its pool.
+//
+void P_FreeThinker (thinker_t* thinker)
+{
+    thinkerpool_t*	pool;
+
+    pool = thinker->pool;
+    thinker->function.acv = NULL;
+    thinker->next = pool->free;
+    pool->free = thinker;
+}
+
+
+
+//
+// P_IteratePoolThinkers
+// Calls func for every live thinker of a batched pool, in address
+//  order.  func can free the thinker it is given.
+//
+void
+P_IteratePoolThinkers
+( thinkerpooltype_t	type,
+  void			(*func)(thinker_t*) )
+{
+    thinkerpool_t*	pool;
+    thinkerchunk_t*	chunk;
+    thinkerchunk_t*	next;
+    byte*		data;
+    thinker_t*		thinker;
+    int			i;
+
+    pool = &thinkerpools[type];
+
+    for (chunk = pool->chunks ; chunk ; chunk = next)
+    {
+	next = chunk->next;
+	data = (byte *) (chunk + 1);
+
+	for (i=0 ; i<THINKERCHUNK ; i++, data += pool->size)
+	{
+	    thinker = (thinker_t *) data;
+
+	    if (thinker->function.acv != NULL)
+		func (thinker);
+	}
+    }
+}
+
+
+
+//
+// P_FreeBatchedThinkers
+// Frees the thinkers that are not on the list, for when the list
+//  is being thrown away.
+//
+void P_FreeBatchedThinkers (void)
+{
+    int		i;
+
+    for (i=0 ; i<NUMTHINKERPOOLS ; i++)
+    {
+	if (thinkerpools[i].batched)
+	    P_IteratePoolThinkers (i, P_FreeThinker);
+    }
+}
+
+
+
 //
 // P_AddThinker
 // Adds a new thinker at the end of the list.
+// Batched thinkers are only marked as being in use, and are run
+//  from their pool.
 //
 void P_AddThinker (thinker_t* thinker)
 {
+    if (thinker->pool->batched)
+	return;
+
     thinkercap.prev->next = thinker;
     thinker->next = &thinkercap;
     thinker->prev = thinkercap.prev;
@@ -88,12 +261,88 @@ void P_AllocateThinker (thinker_t*	thinker)
 
 
 
+#ifdef PROFILING
+
+//
+// ThinkerCounter
+// Profiling counter for a thinker of the given type.
+//
+static profcounter_t ThinkerCounter (actionf_p1 function)
+{
+    if (function == (actionf_p1) T_MoveCeiling)
+	return prof_thinkers_ceiling;
+    if (function == (actionf_p1) T_VerticalDoor)
+	return prof_thinkers_door;
+    if (function == (actionf_p1) T_MoveFloor)
+	return prof_thinkers_floor;
+    if (function == (actionf_p1) T_PlatRaise)
+	return prof_thinkers_plat;
+    if (function == (actionf_p1) T_LightFlash
+     || function == (actionf_p1) T_StrobeFlash
+     || function == (actionf_p1) T_Glow
+     || function == (actionf_p1) T_FireFlicker)
+	return prof_thinkers_light;
+
+    return prof_thinkers_other;
+}
+
+#endif
+
+//
+// P_MobjQuickThink
+// Most mobjs are standing still and not changing state this tic, and
+//  all P_MobjThinker does for them is count down tics, or nothing.
+//  Do that here without the call, and return false for the rest.
+//
+static boolean P_MobjQuickThink (mobj_t* mobj)
+{
+    if ( (mobj->momx | mobj->momy | mobj->momz)
+	 || (mobj->flags & MF_SKULLFLY)
+	 || mobj->z != mobj->floorz )
+    {
+	return false;
+    }
+
+    if (mobj->tics > 1)
+    {
+	mobj->tics--;
+	return true;
+    }
+
+    // no nightmare respawn check?
+    return mobj->tics == -1
+	&& !( (mobj->flags & MF_COUNTKILL) && respawnmonsters );
+}
+
+//
+// P_RunBatchedThinker
+//
+static void P_RunBatchedThinker (thinker_t* thinker)
+{
+    if (thinker->function.acv == (actionf_v)(-1))
+    {
+	PROF_COUNT (prof_thinkers_removed, 1);
+	P_FreeThinker (thinker);
+	return;
+    }
+
+    PROF_COUNT (ThinkerCounter (thinker->function.acp1), 1);
+    thinker->function.acp1 (thinker);
+}
+
 //
 // P_RunThinkers
 //
 void P_RunThinkers (void)
 {
     thinker_t*	currentthinker;
+    thinker_t*	nextthinker;
+    int		i;
+
+    PROF_BEGIN (prof_runthinkers);
+
+    if (parallelai)
+	P_QueueMonsterSight ();
 
     currentthinker = thinkercap.next;
     while (currentthinker != &thinkercap)
@@ -101,17 +350,43 @@ void P_RunThinkers (void)
 	if ( currentthinker->function.acv == (actionf_v)(-1) )
 	{
 	    // time to remove it
+	    PROF_COUNT (prof_thinkers_removed, 1);
 	    currentthinker->next->prev = currentthinker->prev;
 	    currentthinker->prev->next = currentthinker->next;
-	    Z_Free (currentthinker);
+
+	    // freeing it reuses next for the free list
+	    nextthinker = currentthinker->next;
+	    P_FreeThinker (currentthinker);
+	    currentthinker = nextthinker;
+	    continue;
+	}
+	else if (currentthinker->function.acp1 == (actionf_p1) P_MobjThinker)
+	{
+	    PROF_COUNT (prof_thinkers_mobj, 1);
+
+	    if (!P_MobjQuickThink ((mobj_t *) currentthinker))
+		P_MobjThinker ((mobj_t *) currentthinker);
 	}
 	else
 	{
 	    if (currentthinker->function.acp1)
+	    {
+		PROF_COUNT (ThinkerCounter (currentthinker->function.acp1), 1);
 		currentthinker->function.acp1 (currentthinker);
+	    }
 	}
 	currentthinker = currentthinker->next;
     }
+
+    for (i=0 ; i<NUMTHINKERPOOLS ; i++)
+    {
+	if (thinkerpools[i].batched)
+	    P_IteratePoolThinkers (i, P_RunBatchedThinker);
+    }
+
+    P_ClearSightQueries ();
+
+    PROF_END (prof_runthinkers);
 }
 
 
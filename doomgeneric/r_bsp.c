@@ -22,6 +22,7 @@
 #include "doomdef.h"
 
 #include "m_bbox.h"
+#include "m_prof.h"
 
 #include "i_system.h"
 
@@ -37,14 +38,15 @@
 
 
 
-seg_t*		curline;
-side_t*		sidedef;
-line_t*		linedef;
-sector_t*	frontsector;
-sector_t*	backsector;
+DG_STATE seg_t*		curline;
+DG_STATE side_t*		sidedef;
+DG_STATE line_t*		linedef;
+DG_STATE sector_t*	frontsector;
+DG_STATE sector_t*	backsector;
 
-drawseg_t	drawsegs[MAXDRAWSEGS];
-drawseg_t*	ds_p;
+DG_STATE drawseg_t*	drawsegs;
+DG_STATE int		maxdrawsegs;
+DG_STATE drawseg_t*	ds_p;
 
 
 void
@@ -60,6 +62,10 @@ R_StoreWallRange
 //
 void R_ClearDrawSegs (void)
 {
+    if (drawsegs == NULL)
+	drawsegs = R_GrowArray (drawsegs, &maxdrawsegs,
+				sizeof(*drawsegs), MAXDRAWSEGS);
+
     ds_p = drawsegs;
 }
 
@@ -78,11 +84,15 @@ typedef	struct
 } cliprange_t;
 
 
-#define MAXSEGS		32
+// The most separate ranges the columns of a screen can split into.
+// This is a hard bound, as ranges merge unless an open column keeps
+//  them apart, so unlike drawsegs or visplanes, solidsegs never has
+//  to grow.
+#define MAXSEGS		(MAXWIDTH/2+1)
 
 // newend is one past the last valid seg
-cliprange_t*	newend;
-cliprange_t	solidsegs[MAXSEGS];
+DG_STATE cliprange_t*	newend;
+DG_STATE cliprange_t	solidsegs[MAXSEGS];
 
 
 
@@ -547,6 +557,8 @@ void R_RenderBSPNode (int bspnum)
     node_t*	bsp;
     int		side;
 
+    PROF_COUNT (prof_nodes, 1);
+
     // Found a subsector?
     if (bspnum & NF_SUBSECTOR)
     {
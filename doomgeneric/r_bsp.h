@@ -22,25 +22,26 @@
 
 
 
-extern seg_t*		curline;
-extern side_t*		sidedef;
-extern line_t*		linedef;
-extern sector_t*	frontsector;
-extern sector_t*	backsector;
+extern DG_STATE seg_t*		curline;
+extern DG_STATE side_t*		sidedef;
+extern DG_STATE line_t*		linedef;
+extern DG_STATE sector_t*	frontsector;
+extern DG_STATE sector_t*	backsector;
 
-extern int		rw_x;
-extern int		rw_stopx;
+extern DG_STATE int		rw_x;
+extern DG_STATE int		rw_stopx;
 
-extern boolean		segtextured;
+extern DG_STATE boolean		segtextured;
 
 // false if the back side is the same plane
-extern boolean		markfloor;		
-extern boolean		markceiling;
+extern DG_STATE boolean		markfloor;		
+extern DG_STATE boolean		markceiling;
 
 extern boolean		skymap;
 
-extern drawseg_t	drawsegs[MAXDRAWSEGS];
-extern drawseg_t*	ds_p;
+extern DG_STATE drawseg_t*	drawsegs;
+extern DG_STATE int		maxdrawsegs;
+extern DG_STATE drawseg_t*	ds_p;
 
 extern lighttable_t**	hscalelight;
 extern lighttable_t**	vscalelight;
@@ -18,17 +18,22 @@
 //
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "deh_main.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
+#include "i_video.h"
 #include "z_zone.h"
 
 
 #include "w_wad.h"
 
 #include "doomdef.h"
+#include "m_argv.h"
 #include "m_misc.h"
+#include "m_prof.h"
 #include "r_local.h"
 #include "p_local.h"
 
@@ -110,14 +115,6 @@ struct texture_s
     short	width;
     short	height;
 
-    // Index in textures list
-
-    int         index;
-
-    // Next in hash table chain
-
-    texture_t  *next;
-    
     // All the patches[patchcount]
     //  are drawn back to front into the cached texture.
     short	patchcount;
@@ -126,41 +123,41 @@ struct texture_s
 
 
 
-int		firstflat;
-int		lastflat;
-int		numflats;
+DG_STATE int		firstflat;
+DG_STATE int		lastflat;
+DG_STATE int		numflats;
 
-int		firstpatch;
-int		lastpatch;
-int		numpatches;
+DG_STATE int		firstpatch;
+DG_STATE int		lastpatch;
+DG_STATE int		numpatches;
 
-int		firstspritelump;
-int		lastspritelump;
-int		numspritelumps;
+DG_STATE int		firstspritelump;
+DG_STATE int		lastspritelump;
+DG_STATE int		numspritelumps;
 
-int		numtextures;
-texture_t**	textures;
-texture_t**     textures_hashtable;
+DG_STATE int		numtextures;
+DG_STATE texture_t**	textures;
+static DG_STATE nameindex_t	textureindex;
 
 
-int*			texturewidthmask;
+DG_STATE int*			texturewidthmask;
 // needed for texture pegging
-fixed_t*		textureheight;		
-int*			texturecompositesize;
-short**			texturecolumnlump;
-unsigned short**	texturecolumnofs;
-byte**			texturecomposite;
+DG_STATE fixed_t*		textureheight;		
+DG_STATE int*			texturecompositesize;
+DG_STATE short**			texturecolumnlump;
+DG_STATE unsigned short**	texturecolumnofs;
+DG_STATE byte**			texturecomposite;
 
 // for global animation
-int*		flattranslation;
-int*		texturetranslation;
+DG_STATE int*		flattranslation;
+DG_STATE int*		texturetranslation;
 
 // needed for pre rendering
-fixed_t*	spritewidth;	
-fixed_t*	spriteoffset;
-fixed_t*	spritetopoffset;
+DG_STATE fixed_t*	spritewidth;	
+DG_STATE fixed_t*	spriteoffset;
+DG_STATE fixed_t*	spritetopoffset;
 
-lighttable_t	*colormaps;
+DG_STATE lighttable_t	*colormaps;
 
 
 //
@@ -217,6 +214,191 @@ R_DrawColumnInCache
 
 
 
+//
+// COMPOSITE TEXTURE CACHE
+// Composites are kept outside the zone, so that they are
+//  not purged and rebuilt in the middle of a frame.  They
+//  are kept on a list in order of use, and the least recently
+//  used ones are freed when the total goes over the budget.
+//
+typedef struct
+{
+    int		prev;		// more recently used, or -1
+    int		next;		// less recently used, or -1
+    int		builds;
+} compositelink_t;
+
+static DG_STATE compositelink_t*	compositelinks;
+
+// Most and least recently used composites.
+static DG_STATE int	compositehead;
+static DG_STATE int	compositetail;
+
+static DG_STATE int	compositememory;
+static DG_STATE int	compositebudget;
+static DG_STATE int	compositepeak;
+
+static DG_STATE int	compositehits;
+static DG_STATE int	compositemisses;
+static DG_STATE int	compositerebuilds;
+static DG_STATE int	compositeevictions;
+
+// Default -texcache, in kilobytes.  Enough for all the
+//  composites of most levels.
+#define DEFAULTTEXCACHE	4096
+
+
+static void R_UnlinkComposite (int texnum)
+{
+    compositelink_t*	link;
+
+    link = &compositelinks[texnum];
+
+    if (link->prev != -1)
+	compositelinks[link->prev].next = link->next;
+    else
+	compositehead = link->next;
+
+    if (link->next != -1)
+	compositelinks[link->next].prev = link->prev;
+    else
+	compositetail = link->prev;
+}
+
+
+static void R_LinkComposite (int texnum)
+{
+    compositelink_t*	link;
+
+    link = &compositelinks[texnum];
+    link->prev = -1;
+    link->next = compositehead;
+
+    if (compositehead != -1)
+	compositelinks[compositehead].prev = texnum;
+    else
+	compositetail = texnum;
+
+    compositehead = texnum;
+}
+
+
+//
+// R_FreeComposite
+//
+static void R_FreeComposite (int texnum)
+{
+    R_UnlinkComposite (texnum);
+
+    free (texturecomposite[texnum]);
+    texturecomposite[texnum] = NULL;
+    compositememory -= texturecompositesize[texnum];
+    compositeevictions++;
+}
+
+
+//
+// R_AllocComposite
+// Frees the least recently used composites until the new one
+//  fits in the budget, or there are none left to free.
+//
+static byte* R_AllocComposite (int texnum)
+{
+    int		size;
+    byte*	block;
+
+    size = texturecompositesize[texnum];
+
+    if (compositememory + size > compositebudget && compositetail != -1)
+    {
+	// The draw queue can still point into them.
+	R_FlushDrawQueue ();
+
+	while (compositememory + size > compositebudget
+	       && compositetail != -1)
+	{
+	    R_FreeComposite (compositetail);
+	}
+    }
+
+    // Cleared, so that the gaps between posts come out the same
+    //  every time the texture is built.
+    block = calloc (1, size);
+
+    if (block == NULL)
+    {
+	I_Error ("R_AllocComposite: out of memory for texture %s",
+		 textures[texnum]->name);
+    }
+
+    texturecomposite[texnum] = block;
+    compositememory += size;
+    if (compositepeak < compositememory)
+	compositepeak = compositememory;
+
+    if (compositelinks[texnum].builds++)
+	compositerebuilds++;
+
+    R_LinkComposite (texnum);
+
+    PROF_COUNT (prof_composites, 1);
+
+    return block;
+}
+
+
+//
+// R_DrawPatchInComposite
+// Draws the columns of one patch that are covered
+//  by more than one patch into the composite.
+//
+static void
+R_DrawPatchInComposite
+( int		texnum,
+  texpatch_t*	patch,
+  patch_t*	realpatch )
+{
+    texture_t*		texture;
+    byte*		block;
+    int			x;
+    int			x1;
+    int			x2;
+    column_t*		patchcol;
+    short*		collump;
+    unsigned short*	colofs;
+
+    texture = textures[texnum];
+    block = texturecomposite[texnum];
+    collump = texturecolumnlump[texnum];
+    colofs = texturecolumnofs[texnum];
+
+    x1 = patch->originx;
+    x2 = x1 + SHORT(realpatch->width);
+
+    if (x1<0)
+	x = 0;
+    else
+	x = x1;
+	
+    if (x2 > texture->width)
+	x2 = texture->width;
+
+    for ( ; x<x2 ; x++)
+    {
+	// Column does not have multiple patches?
+	if (collump[x] >= 0)
+	    continue;
+	    
+	patchcol = (column_t *)((byte *)realpatch
+				+ LONG(realpatch->columnofs[x-x1]));
+	R_DrawColumnInCache (patchcol,
+			     block + colofs[x],
+			     patch->originy,
+			     texture->height);
+    }
+}
+
+
 //
 // R_GenerateComposite
 // Using the texture definition,
@@ -225,65 +407,80 @@ R_DrawColumnInCache
 //
 void R_GenerateComposite (int texnum)
 {
-    byte*		block;
     texture_t*		texture;
     texpatch_t*		patch;	
     patch_t*		realpatch;
-    int			x;
-    int			x1;
-    int			x2;
     int			i;
-    column_t*		patchcol;
-    short*		collump;
-    unsigned short*	colofs;
 	
     texture = textures[texnum];
 
-    block = Z_Malloc (texturecompositesize[texnum],
-		      PU_STATIC, 
-		      &texturecomposite[texnum]);	
+    R_AllocComposite (texnum);
+    compositemisses++;
 
-    collump = texturecolumnlump[texnum];
-    colofs = texturecolumnofs[texnum];
-    
     // Composite the columns together.
-    patch = texture->patches;
-		
     for (i=0 , patch = texture->patches;
 	 i<texture->patchcount;
 	 i++, patch++)
     {
 	realpatch = W_CacheLumpNum (patch->patch, PU_CACHE);
-	x1 = patch->originx;
-	x2 = x1 + SHORT(realpatch->width);
+	R_DrawPatchInComposite (texnum, patch, realpatch);
+    }
+}
 
-	if (x1<0)
-	    x = 0;
-	else
-	    x = x1;
-	
-	if (x2 > texture->width)
-	    x2 = texture->width;
 
-	for ( ; x<x2 ; x++)
-	{
-	    // Column does not have multiple patches?
-	    if (collump[x] >= 0)
-		continue;
-	    
-	    patchcol = (column_t *)((byte *)realpatch
-				    + LONG(realpatch->columnofs[x-x1]));
-	    R_DrawColumnInCache (patchcol,
-				 block + colofs[x],
-				 patch->originy,
-				 texture->height);
-	}
-						
+//
+// R_ReportTextureCache
+// Called at exit, with -devparm.
+//
+static void R_ReportTextureCache (void)
+{
+    if (!devparm)
+	return;
+
+    printf ("R_ReportTextureCache: %i hits, %i misses, %i rebuilds, "
+	    "%i evictions\n",
+	    compositehits, compositemisses, compositerebuilds,
+	    compositeevictions);
+    printf ("  %i of %i kb in use at most\n",
+	    (compositepeak + 1023) / 1024, compositebudget / 1024);
+}
+
+
+//
+// R_InitTextureCache
+//
+static void R_InitTextureCache (void)
+{
+    int		i;
+    int		p;
+
+    compositelinks = Z_Malloc (numtextures * sizeof(*compositelinks),
+			       PU_STATIC, 0);
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	compositelinks[i].prev = compositelinks[i].next = -1;
+	compositelinks[i].builds = 0;
     }
 
-    // Now that the texture has been built in column cache,
-    //  it is purgable from zone memory.
-    Z_ChangeTag (block, PU_CACHE);
+    compositehead = compositetail = -1;
+    compositememory = 0;
+    compositebudget = DEFAULTTEXCACHE * 1024;
+
+    //!
+    // @arg <kb>
+    // @category video
+    //
+    // Keep up to <kb> kilobytes of composite wall textures, the
+    // ones made up of more than one patch.  The default is 4096.
+    //
+
+    p = M_CheckParmWithArgs ("-texcache", 1);
+
+    if (p > 0)
+	compositebudget = atoi (myargv[p+1]) * 1024;
+
+    I_AtExit (R_ReportTextureCache, false);
 }
 
 
@@ -395,50 +592,39 @@ R_GetColumn
 	return (byte *)W_CacheLumpNum(lump,PU_CACHE)+ofs;
 
     if (!texturecomposite[tex])
+    {
 	R_GenerateComposite (tex);
+    }
+    else
+    {
+	compositehits++;
+
+	if (compositehead != tex)
+	{
+	    R_UnlinkComposite (tex);
+	    R_LinkComposite (tex);
+	}
+    }
 
     return texturecomposite[tex] + ofs;
 }
 
 
-static void GenerateTextureHashTable(void)
+static void GenerateTextureIndex(void)
 {
-    texture_t **rover;
     int i;
-    int key;
-
-    textures_hashtable 
-            = Z_Malloc(sizeof(texture_t *) * numtextures, PU_STATIC, 0);
 
-    memset(textures_hashtable, 0, sizeof(texture_t *) * numtextures);
+    W_InitNameIndex(&textureindex, numtextures);
 
-    // Add all textures to hash table
+    // Vanilla Doom does a linear search of the texures array
+    // and stops at the first entry it finds.  If there are two
+    // entries with the same name, the first one in the array
+    // wins.  Later entries in the index replace earlier ones, so
+    // add them backwards.
 
-    for (i=0; i<numtextures; ++i)
+    for (i=numtextures-1; i>=0; --i)
     {
-        // Store index
-
-        textures[i]->index = i;
-
-        // Vanilla Doom does a linear search of the texures array
-        // and stops at the first entry it finds.  If there are two
-        // entries with the same name, the first one in the array
-        // wins. The new entry must therefore be added at the end
-        // of the hash chain, so that earlier entries win.
-
-        key = W_LumpNameHash(textures[i]->name) % numtextures;
-
-        rover = &textures_hashtable[key];
-
-        while (*rover != NULL)
-        {
-            rover = &(*rover)->next;
-        }
-
-        // Hook into hash table
-
-        textures[i]->next = NULL;
-        *rover = textures[i];
+        W_AddToNameIndex(&textureindex, textures[i]->name, i);
     }
 }
 
@@ -615,6 +801,8 @@ void R_InitTextures (void)
 
     for (i=0 ; i<numtextures ; i++)
 	R_GenerateLookup (i);
+
+    R_InitTextureCache ();
     
     // Create translation table for global animation.
     texturetranslation = Z_Malloc ((numtextures+1)*sizeof(*texturetranslation), PU_STATIC, 0);
@@ -622,7 +810,7 @@ void R_InitTextures (void)
     for (i=0 ; i<numtextures ; i++)
 	texturetranslation[i] = i;
 
-    GenerateTextureHashTable();
+    GenerateTextureIndex();
 }
 
 
@@ -690,6 +878,11 @@ void R_InitColormaps (void)
     //  256 byte align tables.
     lump = W_GetNumForName(DEH_String("COLORMAP"));
     colormaps = W_CacheLumpNum(lump, PU_STATIC);
+
+#ifndef CMAP256
+    // The same tables in the framebuffer's pixel format.
+    I_SetColormaps (colormaps, W_LumpLength (lump) / 256);
+#endif
 }
 
 
@@ -743,26 +936,11 @@ int R_FlatNumForName (char* name)
 //
 int	R_CheckTextureNumForName (char *name)
 {
-    texture_t *texture;
-    int key;
-
     // "NoTexture" marker.
     if (name[0] == '-')		
 	return 0;
 		
-    key = W_LumpNameHash(name) % numtextures;
-
-    texture=textures_hashtable[key]; 
-    
-    while (texture != NULL)
-    {
-	if (!strncasecmp (texture->name, name, 8) )
-	    return texture->index;
-
-        texture = texture->next;
-    }
-    
-    return -1;
+    return W_FindInNameIndex (&textureindex, name);
 }
 
 
@@ -789,13 +967,117 @@ int	R_TextureNumForName (char* name)
 
 
 
+//
+// R_PrecacheComposites
+// Builds the composites of the textures on the level, as many
+//  as fit in the cache, on the worker threads.  The patches are
+//  locked first, so that the tasks do not touch the zone.
+//
+typedef struct
+{
+    int		texnum;
+    patch_t**	patches;
+} compositetask_t;
+
+static void R_BuildCompositeTask (void *data, int task)
+{
+    compositetask_t*	ct;
+    texture_t*		texture;
+    int			i;
+
+    ct = (compositetask_t *) data + task;
+    texture = textures[ct->texnum];
+
+    for (i=0 ; i<texture->patchcount ; i++)
+	R_DrawPatchInComposite (ct->texnum, &texture->patches[i],
+				ct->patches[i]);
+}
+
+static void R_PrecacheComposites (char* texturepresent)
+{
+    compositetask_t*	tasks;
+    patch_t**		patches;
+    int			numtasks;
+    int			numpatches;
+    int			size;
+    int			i;
+    int			j;
+
+    numtasks = 0;
+    numpatches = 0;
+    size = compositememory;
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	if (!texturepresent[i] || !texturecompositesize[i]
+	 || texturecomposite[i])
+	{
+	    continue;
+	}
+
+	// Leave the rest to be built when they are drawn.
+	if (size + texturecompositesize[i] > compositebudget)
+	    continue;
+
+	size += texturecompositesize[i];
+	numtasks++;
+	numpatches += textures[i]->patchcount;
+    }
+
+    if (!numtasks)
+	return;
+
+    tasks = Z_Malloc (numtasks * sizeof(*tasks), PU_STATIC, NULL);
+    patches = Z_Malloc (numpatches * sizeof(*patches), PU_STATIC, NULL);
+
+    numtasks = 0;
+    numpatches = 0;
+
+    for (i=0 ; i<numtextures ; i++)
+    {
+	if (!texturepresent[i] || !texturecompositesize[i]
+	 || texturecomposite[i])
+	{
+	    continue;
+	}
+
+	if (compositememory + texturecompositesize[i] > compositebudget)
+	    continue;
+
+	R_AllocComposite (i);
+
+	tasks[numtasks].texnum = i;
+	tasks[numtasks].patches = patches + numpatches;
+	numtasks++;
+
+	for (j=0 ; j<textures[i]->patchcount ; j++)
+	{
+	    patches[numpatches++] =
+		W_CacheLumpNum (textures[i]->patches[j].patch, PU_STATIC);
+	}
+    }
+
+    I_RunWorkers (R_BuildCompositeTask, tasks, numtasks);
+
+    for (i=0 ; i<numtasks ; i++)
+    {
+	for (j=0 ; j<textures[tasks[i].texnum]->patchcount ; j++)
+	    W_ReleaseLumpNum (textures[tasks[i].texnum]->patches[j].patch);
+    }
+
+    Z_Free(patches);
+    Z_Free(tasks);
+}
+
+
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
 //
-int		flatmemory;
-int		texturememory;
-int		spritememory;
+DG_STATE int		flatmemory;
+DG_STATE int		texturememory;
+DG_STATE int		spritememory;
 
 void R_PrecacheLevel (void)
 {
@@ -874,6 +1156,8 @@ void R_PrecacheLevel (void)
 	}
     }
 
+    R_PrecacheComposites (texturepresent);
+
     Z_Free(texturepresent);
     
     // Precache sprites.
@@ -48,7 +48,12 @@
 #define SIL_TOP			2
 #define SIL_BOTH		3
 
+// Vanilla renderer limits.  The arrays for these start out
+//  this big, and grow as needed; see R_GrowArray.
 #define MAXDRAWSEGS		256
+#define MAXVISPLANES		128
+#define MAXVISSPRITES		128
+#define MAXOPENINGS		(SCREENWIDTH*64)
 
 
 
@@ -337,10 +342,6 @@ typedef struct drawseg_s
 // I.e. a sprite object that is partly visible.
 typedef struct vissprite_s
 {
-    // Doubly linked list.
-    struct vissprite_s*	prev;
-    struct vissprite_s*	next;
-    
     int			x1;
     int			x2;
 
@@ -420,8 +421,11 @@ typedef struct
 //
 // Now what is a visplane, anyway?
 // 
-typedef struct
+typedef struct visplane_s
 {
+  // next in the R_FindPlane hash chain
+  struct visplane_s*	next;
+
   fixed_t		height;
   int			picnum;
   int			lightlevel;
@@ -430,15 +434,16 @@ typedef struct
   
   // leave pads for [minx-1]/[maxx+1]
   
-  byte		pad1;
+  unsigned short	pad1;
   // Here lies the rub for all
   //  dynamic resize/change of resolution.
-  byte		top[SCREENWIDTH];
-  byte		pad2;
-  byte		pad3;
+  // 0xffff where the plane has no span.
+  unsigned short	top[MAXWIDTH];
+  unsigned short	pad2;
+  unsigned short	pad3;
   // See above.
-  byte		bottom[SCREENWIDTH];
-  byte		pad4;
+  unsigned short	bottom[MAXWIDTH];
+  unsigned short	pad4;
 
 } visplane_t;
 
@@ -21,14 +21,26 @@
 
 
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "doomdef.h"
 #include "deh_main.h"
+#include "doomgeneric.h"
 
 #include "i_system.h"
+#include "i_thread.h"
+#include "i_video.h"
 #include "z_zone.h"
 #include "w_wad.h"
 
 #include "r_local.h"
+#include "st_stuff.h"
 
 // Needs access to LFB (guess what).
 #include "v_video.h"
@@ -37,13 +49,6 @@
 #include "doomstat.h"
 
 
-// ?
-#define MAXWIDTH			1120
-#define MAXHEIGHT			832
-
-// status bar height at bottom of screen
-#define SBARHEIGHT		32
-
 //
 // All drawing to the view buffer is accomplished in this file.
 // The other refresh files only know about ccordinates,
@@ -54,43 +59,59 @@
 //
 
 
-byte*		viewimage; 
-int		viewwidth;
-int		scaledviewwidth;
-int		viewheight;
-int		viewwindowx;
-int		viewwindowy; 
-byte*		ylookup[MAXHEIGHT]; 
-int		columnofs[MAXWIDTH]; 
+DG_STATE byte*		viewimage; 
+DG_STATE int		viewwidth;
+DG_STATE int		scaledviewwidth;
+DG_STATE int		viewheight;
+DG_STATE int		viewwindowx;
+DG_STATE int		viewwindowy; 
+DG_STATE byte*		ylookup[MAXHEIGHT]; 
+DG_STATE int		columnofs[MAXWIDTH]; 
+
+// Distance from a pixel of the view to the one below it,
+//  and to the one to the right of it.
+DG_STATE int		viewpitch;
+DG_STATE int		viewstep;
+
+// With -columnmajor, the view is drawn into viewbuffer with each
+//  column in one run, and copied into its window on the screen
+//  by R_CopyViewBuffer once it is done.
+DG_STATE boolean	columnmajor;
+static DG_STATE byte*	viewbuffer;
+
+#ifndef CMAP256
+// Rows of the view in DG_ScreenBuffer, for the truecolor drawers.
+DG_STATE pixel_t*	pixelrows[MAXHEIGHT];
+#endif
 
 // Color tables for different players,
 //  translate a limited part to another
 //  (color ramps used for  suit colors).
 //
-byte		translations[3][256];	
+DG_STATE byte		translations[3][256];	
  
 // Backing buffer containing the bezel drawn around the screen and 
 // surrounding background.
 
-static byte *background_buffer = NULL;
+static DG_STATE byte *background_buffer = NULL;
 
 
 //
 // R_DrawColumn
 // Source is the top of the column to scale.
 //
-lighttable_t*		dc_colormap; 
-int			dc_x; 
-int			dc_yl; 
-int			dc_yh; 
-fixed_t			dc_iscale; 
-fixed_t			dc_texturemid;
+DG_THREAD_LOCAL lighttable_t*		dc_colormap; 
+DG_THREAD_LOCAL int			dc_x; 
+DG_THREAD_LOCAL int			dc_yl; 
+DG_THREAD_LOCAL int			dc_yh; 
+DG_THREAD_LOCAL fixed_t			dc_iscale; 
+DG_THREAD_LOCAL fixed_t			dc_texturemid;
 
 // first pixel in a column (possibly virtual) 
-byte*			dc_source;		
+DG_THREAD_LOCAL byte*			dc_source;		
 
 // just for profiling 
-int			dccount;
+DG_STATE int			dccount;
 
 //
 // A column is a vertical slice/span from a wall texture that,
@@ -103,6 +124,7 @@ void R_DrawColumn (void)
 { 
     int			count; 
     byte*		dest; 
+    int			pitch;
     fixed_t		frac;
     fixed_t		fracstep;	 
  
@@ -122,6 +144,7 @@ void R_DrawColumn (void)
     // Framebuffer destination address.
     // Use ylookup LUT to avoid multiply with ScreenWidth.
     // Use columnofs LUT for subwindows? 
+    pitch = viewpitch;
     dest = ylookup[dc_yl] + columnofs[dc_x];  
 
     // Determine scaling,
@@ -138,13 +161,189 @@ void R_DrawColumn (void)
 	//  using a lighting/special effects LUT.
 	*dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
 	
-	dest += SCREENWIDTH; 
+	dest += pitch; 
 	frac += fracstep;
 	
     } while (count--); 
 } 
 
 
+//
+// Column batches.
+// Walls are drawn a column at a time, so every pixel written is a
+//  screen width away from the last one.  Up to COLUMNBATCH adjacent
+//  columns are instead collected and drawn together, a row at a
+//  time, over the rows they all cover.  Each column keeps its own
+//  source, colormap and step, and the rows above and below the
+//  shared ones are drawn a column at a time, so the output is the
+//  same as from R_DrawColumn.
+//
+#define COLUMNBATCH	4	// R_DrawColumns is unrolled for 4
+
+typedef struct
+{
+    int			count;
+
+    // dc_x of the first column.
+    int			x;
+
+    int			yl[COLUMNBATCH];
+    int			yh[COLUMNBATCH];
+    fixed_t		iscale[COLUMNBATCH];
+    fixed_t		texturemid[COLUMNBATCH];
+    byte*		source[COLUMNBATCH];
+    lighttable_t*	colormap[COLUMNBATCH];
+} colbatch_t;
+
+
+static void R_AddToBatch (colbatch_t* batch)
+{
+    int		i;
+
+    if (!batch->count)
+	batch->x = dc_x;
+
+    i = batch->count++;
+    batch->yl[i] = dc_yl;
+    batch->yh[i] = dc_yh;
+    batch->iscale[i] = dc_iscale;
+    batch->texturemid[i] = dc_texturemid;
+    batch->source[i] = dc_source;
+    batch->colormap[i] = dc_colormap;
+}
+
+
+//
+// R_DrawBatchRows
+// Draws rows y1 to y2 of one column of a batch.
+//
+static void
+R_DrawBatchRows
+( colbatch_t*	batch,
+  int		i,
+  fixed_t*	frac,
+  int		y1,
+  int		y2 )
+{
+    byte*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    fixed_t		fracstep;
+
+    dest = ylookup[y1] + columnofs[batch->x + i];
+    source = batch->source[i];
+    colormap = batch->colormap[i];
+    fracstep = batch->iscale[i];
+
+    for ( ; y1 <= y2 ; y1++)
+    {
+	*dest = colormap[source[(*frac>>FRACBITS)&127]];
+	dest += SCREENWIDTH;
+	*frac += fracstep;
+    }
+}
+
+
+//
+// R_DrawColumns
+// Draws a batch of adjacent columns.
+//
+static void R_DrawColumns (colbatch_t* batch)
+{
+    fixed_t	frac[COLUMNBATCH];
+    int		top;
+    int		bottom;
+    int		count;
+    int		i;
+    int		y;
+    byte*	dest;
+
+    count = batch->count;
+    top = batch->yl[0];
+    bottom = batch->yh[0];
+
+    for (i=0 ; i<count ; i++)
+    {
+	frac[i] = batch->texturemid[i]
+		+ (batch->yl[i]-centery)*batch->iscale[i];
+
+	if (top < batch->yl[i])
+	    top = batch->yl[i];
+	if (bottom > batch->yh[i])
+	    bottom = batch->yh[i];
+    }
+
+    if (top > bottom)
+    {
+	// No rows in common.
+	for (i=0 ; i<count ; i++)
+	    R_DrawBatchRows (batch, i, &frac[i], batch->yl[i], batch->yh[i]);
+	return;
+    }
+
+    for (i=0 ; i<count ; i++)
+	R_DrawBatchRows (batch, i, &frac[i], batch->yl[i], top-1);
+
+    dest = ylookup[top] + columnofs[batch->x];
+
+    if (count == COLUMNBATCH)
+    {
+	// Kept in locals: the stores through dest could alias
+	//  anything in the batch.
+	byte*		source0 = batch->source[0];
+	byte*		source1 = batch->source[1];
+	byte*		source2 = batch->source[2];
+	byte*		source3 = batch->source[3];
+	lighttable_t*	colormap0 = batch->colormap[0];
+	lighttable_t*	colormap1 = batch->colormap[1];
+	lighttable_t*	colormap2 = batch->colormap[2];
+	lighttable_t*	colormap3 = batch->colormap[3];
+	fixed_t		frac0 = frac[0];
+	fixed_t		frac1 = frac[1];
+	fixed_t		frac2 = frac[2];
+	fixed_t		frac3 = frac[3];
+	fixed_t		step0 = batch->iscale[0];
+	fixed_t		step1 = batch->iscale[1];
+	fixed_t		step2 = batch->iscale[2];
+	fixed_t		step3 = batch->iscale[3];
+
+	for (y=top ; y<=bottom ; y++)
+	{
+	    dest[0] = colormap0[source0[(frac0>>FRACBITS)&127]];
+	    dest[1] = colormap1[source1[(frac1>>FRACBITS)&127]];
+	    dest[2] = colormap2[source2[(frac2>>FRACBITS)&127]];
+	    dest[3] = colormap3[source3[(frac3>>FRACBITS)&127]];
+	    frac0 += step0;
+	    frac1 += step1;
+	    frac2 += step2;
+	    frac3 += step3;
+	    dest += SCREENWIDTH;
+	}
+
+	frac[0] = frac0;
+	frac[1] = frac1;
+	frac[2] = frac2;
+	frac[3] = frac3;
+    }
+    else
+    {
+	for (y=top ; y<=bottom ; y++)
+	{
+	    for (i=0 ; i<count ; i++)
+	    {
+		dest[i] = batch->colormap[i][batch->source[i]
+					     [(frac[i]>>FRACBITS)&127]];
+		frac[i] += batch->iscale[i];
+	    }
+	    dest += SCREENWIDTH;
+	}
+    }
+
+    for (i=0 ; i<count ; i++)
+	R_DrawBatchRows (batch, i, &frac[i], bottom+1, batch->yh[i]);
+}
+
+
 
 // UNUSED.
 // Loop unrolled.
@@ -210,6 +409,7 @@ void R_DrawColumnLow (void)
     int			count; 
     byte*		dest; 
     byte*		dest2;
+    int			pitch;
     fixed_t		frac;
     fixed_t		fracstep;	 
     int                 x;
@@ -233,6 +433,7 @@ void R_DrawColumnLow (void)
     // Blocky mode, need to multiply by 2.
     x = dc_x << 1;
     
+    pitch = viewpitch;
     dest = ylookup[dc_yl] + columnofs[x];
     dest2 = ylookup[dc_yl] + columnofs[x+1];
     
@@ -243,8 +444,8 @@ void R_DrawColumnLow (void)
     {
 	// Hack. Does not work corretly.
 	*dest2 = *dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += pitch;
+	dest2 += pitch;
 	frac += fracstep; 
 
     } while (count--);
@@ -255,10 +456,12 @@ void R_DrawColumnLow (void)
 // Spectre/Invisibility.
 //
 #define FUZZTABLE		50 
-#define FUZZOFF	(SCREENWIDTH)
+#define FUZZOFF	(1)
 
 
-int	fuzzoffset[FUZZTABLE] =
+// Rows up or down to take each pixel from; R_InitBuffer turns
+//  these into offsets in fuzzoffset.
+static const int fuzzrows[FUZZTABLE] =
 {
     FUZZOFF,-FUZZOFF,FUZZOFF,-FUZZOFF,FUZZOFF,FUZZOFF,-FUZZOFF,
     FUZZOFF,FUZZOFF,-FUZZOFF,FUZZOFF,FUZZOFF,FUZZOFF,-FUZZOFF,
@@ -269,7 +472,9 @@ int	fuzzoffset[FUZZTABLE] =
     FUZZOFF,FUZZOFF,-FUZZOFF,FUZZOFF,FUZZOFF,-FUZZOFF,FUZZOFF 
 }; 
 
-int	fuzzpos = 0; 
+DG_STATE int	fuzzoffset[FUZZTABLE];
+
+DG_THREAD_LOCAL int	fuzzpos = 0; 
 
 
 //
@@ -284,6 +489,7 @@ void R_DrawFuzzColumn (void)
 { 
     int			count; 
     byte*		dest; 
+    int			pitch;
     fixed_t		frac;
     fixed_t		fracstep;	 
 
@@ -310,6 +516,7 @@ void R_DrawFuzzColumn (void)
     }
 #endif
     
+    pitch = viewpitch;
     dest = ylookup[dc_yl] + columnofs[dc_x];
 
     // Looks familiar.
@@ -331,7 +538,7 @@ void R_DrawFuzzColumn (void)
 	if (++fuzzpos == FUZZTABLE) 
 	    fuzzpos = 0;
 	
-	dest += SCREENWIDTH;
+	dest += pitch;
 
 	frac += fracstep; 
     } while (count--); 
@@ -344,6 +551,7 @@ void R_DrawFuzzColumnLow (void)
     int			count; 
     byte*		dest; 
     byte*		dest2; 
+    int			pitch;
     fixed_t		frac;
     fixed_t		fracstep;	 
     int x;
@@ -375,6 +583,7 @@ void R_DrawFuzzColumnLow (void)
     }
 #endif
     
+    pitch = viewpitch;
     dest = ylookup[dc_yl] + columnofs[x];
     dest2 = ylookup[dc_yl] + columnofs[x+1];
 
@@ -398,8 +607,8 @@ void R_DrawFuzzColumnLow (void)
 	if (++fuzzpos == FUZZTABLE) 
 	    fuzzpos = 0;
 	
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += pitch;
+	dest2 += pitch;
 
 	frac += fracstep; 
     } while (count--); 
@@ -418,13 +627,14 @@ void R_DrawFuzzColumnLow (void)
 //  of the BaronOfHell, the HellKnight, uses
 //  identical sprites, kinda brightened up.
 //
-byte*	dc_translation;
-byte*	translationtables;
+DG_THREAD_LOCAL byte*	dc_translation;
+DG_STATE byte*	translationtables;
 
 void R_DrawTranslatedColumn (void) 
 { 
     int			count; 
     byte*		dest; 
+    int			pitch;
     fixed_t		frac;
     fixed_t		fracstep;	 
  
@@ -444,6 +654,7 @@ void R_DrawTranslatedColumn (void)
 #endif 
 
 
+    pitch = viewpitch;
     dest = ylookup[dc_yl] + columnofs[dc_x]; 
 
     // Looks familiar.
@@ -459,7 +670,7 @@ void R_DrawTranslatedColumn (void)
 	// Thus the "green" ramp of the player 0 sprite
 	//  is mapped to gray, red, black/indigo. 
 	*dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
-	dest += SCREENWIDTH;
+	dest += pitch;
 	
 	frac += fracstep; 
     } while (count--); 
@@ -470,6 +681,7 @@ void R_DrawTranslatedColumnLow (void)
     int			count; 
     byte*		dest; 
     byte*		dest2; 
+    int			pitch;
     fixed_t		frac;
     fixed_t		fracstep;	 
     int                 x;
@@ -493,6 +705,7 @@ void R_DrawTranslatedColumnLow (void)
 #endif 
 
 
+    pitch = viewpitch;
     dest = ylookup[dc_yl] + columnofs[x]; 
     dest2 = ylookup[dc_yl] + columnofs[x+1]; 
 
@@ -510,8 +723,8 @@ void R_DrawTranslatedColumnLow (void)
 	//  is mapped to gray, red, black/indigo. 
 	*dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
 	*dest2 = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += pitch;
+	dest2 += pitch;
 	
 	frac += fracstep; 
     } while (count--); 
@@ -555,6 +768,62 @@ void R_InitTranslationTables (void)
 
 
 
+#if defined(__SSE2__)
+
+//
+// Vectorized spans.
+// The packed positions of eight pixels are kept in two vectors
+//  and stepped together.  The flat offsets are worked out from
+//  them the same way as in the scalar loop, eight at a time;
+//  only the texel and colormap fetches are left to scalar code.
+// The arithmetic is the same 32-bit wrapping arithmetic, so the
+//  output is identical.
+//
+static inline void
+R_SpanPositions
+( __m128i*	pos,
+  unsigned int	position,
+  unsigned int	step )
+{
+    pos[0] = _mm_setr_epi32 (position, position + step,
+			     position + step * 2, position + step * 3);
+    pos[1] = _mm_add_epi32 (pos[0], _mm_set1_epi32 (step * 4));
+}
+
+//
+// R_SpanSpots
+// Returns the flat offsets of the next eight pixels, as 16-bit
+//  lanes, and steps the positions past them.
+//
+static inline __m128i R_SpanSpots (__m128i* pos, __m128i step8)
+{
+    __m128i	mask;
+    __m128i	spot0;
+    __m128i	spot1;
+
+    mask = _mm_set1_epi32 (0x0fc0);
+
+    spot0 = _mm_or_si128 (_mm_srli_epi32 (pos[0], 26),
+			  _mm_and_si128 (_mm_srli_epi32 (pos[0], 4), mask));
+    spot1 = _mm_or_si128 (_mm_srli_epi32 (pos[1], 26),
+			  _mm_and_si128 (_mm_srli_epi32 (pos[1], 4), mask));
+
+    pos[0] = _mm_add_epi32 (pos[0], step8);
+    pos[1] = _mm_add_epi32 (pos[1], step8);
+
+    // Offsets are below 4096, so the saturation never kicks in.
+    return _mm_packs_epi32 (spot0, spot1);
+}
+
+#define SPANPIXEL(spots, i) \
+    ds_colormap[ds_source[_mm_extract_epi16 (spots, i)]]
+
+// Set by R_TestSpans, to get pixels from the scalar loops alone
+//  to check the vector loops against.
+static DG_STATE boolean		spanscalar;
+
+#endif
+
 //
 // R_DrawSpan 
 // With DOOM style restrictions on view orientation,
@@ -567,22 +836,22 @@ void R_InitTranslationTables (void)
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
 //
-int			ds_y; 
-int			ds_x1; 
-int			ds_x2;
+DG_THREAD_LOCAL int			ds_y; 
+DG_THREAD_LOCAL int			ds_x1; 
+DG_THREAD_LOCAL int			ds_x2;
 
-lighttable_t*		ds_colormap; 
+DG_THREAD_LOCAL lighttable_t*		ds_colormap; 
 
-fixed_t			ds_xfrac; 
-fixed_t			ds_yfrac; 
-fixed_t			ds_xstep; 
-fixed_t			ds_ystep;
+DG_THREAD_LOCAL fixed_t			ds_xfrac; 
+DG_THREAD_LOCAL fixed_t			ds_yfrac; 
+DG_THREAD_LOCAL fixed_t			ds_xstep; 
+DG_THREAD_LOCAL fixed_t			ds_ystep;
 
 // start of a 64*64 tile image 
-byte*			ds_source;	
+DG_THREAD_LOCAL byte*			ds_source;	
 
 // just for profiling
-int			dscount;
+DG_STATE int			dscount;
 
 
 //
@@ -591,6 +860,7 @@ void R_DrawSpan (void)
 { 
     unsigned int position, step;
     byte *dest;
+    int stride;
     int count;
     int spot;
     unsigned int xtemp, ytemp;
@@ -618,10 +888,42 @@ void R_DrawSpan (void)
          | ((ds_ystep >> 6)  & 0x0000ffff);
 
     dest = ylookup[ds_y] + columnofs[ds_x1];
+    stride = viewstep;
 
     // We do not check for zero spans here?
     count = ds_x2 - ds_x1;
 
+#if defined(__SSE2__)
+    if (count >= 8 && !spanscalar)
+    {
+	__m128i	pos[2];
+	__m128i	step8;
+	__m128i	spots;
+
+	R_SpanPositions (pos, position, step);
+	step8 = _mm_set1_epi32 (step * 8);
+
+	// Leaves at least one pixel for the loop below.
+	do
+	{
+	    spots = R_SpanSpots (pos, step8);
+
+	    dest[0] = SPANPIXEL (spots, 0);
+	    dest[stride] = SPANPIXEL (spots, 1);
+	    dest[stride*2] = SPANPIXEL (spots, 2);
+	    dest[stride*3] = SPANPIXEL (spots, 3);
+	    dest[stride*4] = SPANPIXEL (spots, 4);
+	    dest[stride*5] = SPANPIXEL (spots, 5);
+	    dest[stride*6] = SPANPIXEL (spots, 6);
+	    dest[stride*7] = SPANPIXEL (spots, 7);
+
+	    dest += stride*8;
+	    position += step * 8;
+	    count -= 8;
+	} while (count >= 8);
+    }
+#endif
+
     do
     {
 	// Calculate current texture index in u,v.
@@ -631,7 +933,8 @@ void R_DrawSpan (void)
 
 	// Lookup pixel from flat texture tile,
 	//  re-index using light/colormap.
-	*dest++ = ds_colormap[ds_source[spot]];
+	*dest = ds_colormap[ds_source[spot]];
+	dest += stride;
 
         position += step;
 
@@ -721,6 +1024,7 @@ void R_DrawSpanLow (void)
     unsigned int position, step;
     unsigned int xtemp, ytemp;
     byte *dest;
+    int stride;
     int count;
     int spot;
 
@@ -748,6 +1052,37 @@ void R_DrawSpanLow (void)
     ds_x2 <<= 1;
 
     dest = ylookup[ds_y] + columnofs[ds_x1];
+    stride = viewstep;
+
+#if defined(__SSE2__)
+    if (count >= 8 && !spanscalar)
+    {
+	__m128i	pos[2];
+	__m128i	step8;
+	__m128i	spots;
+
+	R_SpanPositions (pos, position, step);
+	step8 = _mm_set1_epi32 (step * 8);
+
+	do
+	{
+	    spots = R_SpanSpots (pos, step8);
+
+	    dest[0] = dest[stride] = SPANPIXEL (spots, 0);
+	    dest[stride*2] = dest[stride*3] = SPANPIXEL (spots, 1);
+	    dest[stride*4] = dest[stride*5] = SPANPIXEL (spots, 2);
+	    dest[stride*6] = dest[stride*7] = SPANPIXEL (spots, 3);
+	    dest[stride*8] = dest[stride*9] = SPANPIXEL (spots, 4);
+	    dest[stride*10] = dest[stride*11] = SPANPIXEL (spots, 5);
+	    dest[stride*12] = dest[stride*13] = SPANPIXEL (spots, 6);
+	    dest[stride*14] = dest[stride*15] = SPANPIXEL (spots, 7);
+
+	    dest += stride*16;
+	    position += step * 8;
+	    count -= 8;
+	} while (count >= 8);
+    }
+#endif
 
     do
     {
@@ -758,154 +1093,1113 @@ void R_DrawSpanLow (void)
 
 	// Lowres/blocky mode does it twice,
 	//  while scale is adjusted appropriately.
-	*dest++ = ds_colormap[ds_source[spot]];
-	*dest++ = ds_colormap[ds_source[spot]];
+	*dest = ds_colormap[ds_source[spot]];
+	dest += stride;
+	*dest = ds_colormap[ds_source[spot]];
+	dest += stride;
 
 	position += step;
 
     } while (count--);
 }
 
+
+#if defined(__SSE2__)
+
+// Spans drawn by R_TestSpans with each drawer and layout.
+#define NUMTESTSPANS	2000
+
+static fixed_t R_RandomFixed (void)
+{
+    return (fixed_t) (((unsigned int) rand () << 16) ^ (unsigned int) rand ());
+}
+
 //
-// R_InitBuffer 
-// Creats lookup tables that avoid
-//  multiplies and other hazzles
-//  for getting the framebuffer address
-//  of a pixel to draw.
+// R_SpansMatch
+// Draws the span set up in ds_* into buffer1 with the vector loop,
+//  and into buffer2 with the scalar one.  Returns true if the two
+//  buffers are still the same; if not, they are made the same again.
 //
-void
-R_InitBuffer
-( int		width,
-  int		height ) 
-{ 
-    int		i; 
+static boolean
+R_SpansMatch
+( void		(*drawer) (void),
+  byte*		buffer1,
+  byte*		buffer2,
+  int		size )
+{
+    int		x1;
+    int		x2;
 
-    // Handle resize,
-    //  e.g. smaller view windows
-    //  with border and/or status bar.
-    viewwindowx = (SCREENWIDTH-width) >> 1; 
+    // R_DrawSpanLow doubles these.
+    x1 = ds_x1;
+    x2 = ds_x2;
 
-    // Column offset. For windows.
-    for (i=0 ; i<width ; i++) 
-	columnofs[i] = viewwindowx + i;
+    ylookup[0] = buffer1;
+    drawer ();
 
-    // Samw with base row offset.
-    if (width == SCREENWIDTH) 
-	viewwindowy = 0; 
-    else 
-	viewwindowy = (SCREENHEIGHT-SBARHEIGHT-height) >> 1; 
+    ds_x1 = x1;
+    ds_x2 = x2;
 
-    // Preclaculate all row offsets.
-    for (i=0 ; i<height ; i++) 
-	ylookup[i] = I_VideoBuffer + (i+viewwindowy)*SCREENWIDTH; 
-} 
- 
- 
+    ylookup[0] = buffer2;
+    spanscalar = true;
+    drawer ();
+    spanscalar = false;
 
+    ds_x1 = x1;
+    ds_x2 = x2;
+
+    if (!memcmp (buffer1, buffer2, size))
+	return true;
+
+    memcpy (buffer2, buffer1, size);
+    return false;
+}
+
+#endif
 
 //
-// R_FillBackScreen
-// Fills the back screen with a pattern
-//  for variable screen sizes
-// Also draws a beveled edge.
+// R_TestSpans
+// Draws random spans with R_DrawSpan and R_DrawSpanLow, with and
+//  without their SSE2 loops, both a row and a column at a time, and
+//  returns how many came out differently.
+// The view lookup tables are pointed at scratch buffers, so this has
+//  to run before the view is set up.
 //
-void R_FillBackScreen (void) 
-{ 
-    byte*	src;
-    byte*	dest; 
-    int		x;
-    int		y; 
-    patch_t*	patch;
+int R_TestSpans (void)
+{
+#if defined(__SSE2__)
+    byte	source[64*64];
+    byte	colormap[256];
+    byte*	buffer1;
+    byte*	buffer2;
+    int		stride;
+    int		size;
+    int		maxx;
+    int		failed;
+    int		drawer;
+    int		i;
 
-    // DOOM border patch.
-    char       *name1 = DEH_String("FLOOR7_2");
+    buffer1 = malloc (SCREENWIDTH * SCREENHEIGHT);
+    buffer2 = malloc (SCREENWIDTH * SCREENHEIGHT);
 
-    // DOOM II border patch.
-    char *name2 = DEH_String("GRNROCK");
+    if (buffer1 == NULL || buffer2 == NULL)
+	I_Error ("R_TestSpans: out of memory");
 
-    char *name;
+    for (i=0 ; i<64*64 ; i++)
+	source[i] = rand ();
+    for (i=0 ; i<256 ; i++)
+	colormap[i] = rand ();
 
-    // If we are running full screen, there is no need to do any of this,
-    // and the background buffer can be freed if it was previously in use.
+    ds_source = source;
+    ds_colormap = colormap;
+    ds_y = 0;
 
-    if (scaledviewwidth == SCREENWIDTH)
+    failed = 0;
+
+    // Row-major, then column-major (see -columnmajor).
+    for (stride = 1 ; ; stride = SCREENHEIGHT)
     {
-        if (background_buffer != NULL)
-        {
-            Z_Free(background_buffer);
-            background_buffer = NULL;
-        }
+	size = SCREENWIDTH * stride;
+	viewstep = stride;
 
-	return;
+	for (i=0 ; i<SCREENWIDTH ; i++)
+	    columnofs[i] = i * stride;
+
+	memset (buffer1, 0, size);
+	memset (buffer2, 0, size);
+
+	for (drawer=0 ; drawer<2 ; drawer++)
+	{
+	    // Low detail spans are drawn twice as wide.
+	    maxx = drawer ? SCREENWIDTH / 2 : SCREENWIDTH;
+
+	    for (i=0 ; i<NUMTESTSPANS ; i++)
+	    {
+		// Plenty of short spans, around the vector loop's
+		//  eight pixels.
+		ds_x1 = rand () % maxx;
+		ds_x2 = ds_x1 + rand () % (i & 1 ? 20 : maxx);
+
+		if (ds_x2 >= maxx)
+		    ds_x2 = maxx - 1;
+
+		ds_xfrac = R_RandomFixed ();
+		ds_yfrac = R_RandomFixed ();
+		ds_xstep = R_RandomFixed ();
+		ds_ystep = R_RandomFixed ();
+
+		if (!R_SpansMatch (drawer ? R_DrawSpanLow : R_DrawSpan,
+				   buffer1, buffer2, size))
+		{
+		    printf ("R_TestSpans: %s differs for %i to %i, "
+			    "stride %i\n",
+			    drawer ? "R_DrawSpanLow" : "R_DrawSpan",
+			    ds_x1, ds_x2, stride);
+		    failed++;
+		}
+	    }
+	}
+
+	if (stride == SCREENHEIGHT)
+	    break;
     }
 
-    // Allocate the background buffer if necessary
-	
-    if (background_buffer == NULL)
+    free (buffer1);
+    free (buffer2);
+
+    printf ("R_TestSpans: %i of %i spans differ\n",
+	    failed, NUMTESTSPANS * 4);
+
+    return failed;
+#else
+    printf ("R_TestSpans: no SSE2 span drawers to test\n");
+
+    return 0;
+#endif
+}
+
+#ifndef CMAP256
+
+//
+// Truecolor drawers.
+// With -truecolor, the view is drawn straight into DG_ScreenBuffer
+//  (see R_RenderPlayerView).  These are the drawers above, writing
+//  the entry of fb_colormaps that matches the colormap entry they
+//  would have written, so the pixels come out as I_FinishUpdate
+//  would have converted them.
+//
+
+// The entries of fb_colormaps for a colormap.
+#define PIXELMAP(colormap)	(fb_colormaps + ((colormap) - colormaps))
+
+// Colormap 6 scales each channel by about 26/32; fuzz does the same
+//  to the pixels, as there are no palette indices left to remap.
+#define FUZZPIXEL(p) \
+    (((((p) & 0xff00ff) * 26 >> 5) & 0xff00ff) \
+     | ((((p) & 0x00ff00) * 26 >> 5) & 0x00ff00))
+
+void R_DrawPixelColumn (void)
+{
+    int			count;
+    pixel_t*		dest;
+    uint32_t*		pixelmap;
+    fixed_t		frac;
+    fixed_t		fracstep;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawPixelColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = pixelrows[dc_yl] + columnofs[dc_x];
+    pixelmap = PIXELMAP (dc_colormap);
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    do
     {
-        background_buffer = Z_Malloc(SCREENWIDTH * (SCREENHEIGHT - SBARHEIGHT),
-                                     PU_STATIC, NULL);
-    }
+	*dest = pixelmap[dc_source[(frac>>FRACBITS)&127]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    } while (count--);
+}
 
-    if (gamemode == commercial)
-	name = name2;
-    else
-	name = name1;
-    
-    src = W_CacheLumpName(name, PU_CACHE); 
-    dest = background_buffer;
-	 
-    for (y=0 ; y<SCREENHEIGHT-SBARHEIGHT ; y++) 
-    { 
-	for (x=0 ; x<SCREENWIDTH/64 ; x++) 
-	{ 
-	    memcpy (dest, src+((y&63)<<6), 64); 
-	    dest += 64; 
-	} 
-
-	if (SCREENWIDTH&63) 
-	{ 
-	    memcpy (dest, src+((y&63)<<6), SCREENWIDTH&63); 
-	    dest += (SCREENWIDTH&63); 
-	} 
-    } 
+void R_DrawPixelColumnLow (void)
+{
+    int			count;
+    pixel_t*		dest;
+    uint32_t*		pixelmap;
+    fixed_t		frac;
+    fixed_t		fracstep;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawPixelColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
+#endif
+
+    // Blocky mode, need to multiply by 2.
+    dest = pixelrows[dc_yl] + columnofs[dc_x << 1];
+    pixelmap = PIXELMAP (dc_colormap);
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    do
+    {
+	dest[0] = dest[1] = pixelmap[dc_source[(frac>>FRACBITS)&127]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    } while (count--);
+}
+
+void R_DrawPixelFuzzColumn (void)
+{
+    int			count;
+    pixel_t*		dest;
+
+    // Same borders as R_DrawFuzzColumn.
+    if (!dc_yl)
+	dc_yl = 1;
+
+    if (dc_yh == viewheight-1)
+	dc_yh = viewheight - 2;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0 || dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawPixelFuzzColumn: %i to %i at %i",
+		 dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = pixelrows[dc_yl] + columnofs[dc_x];
+
+    do
+    {
+	*dest = FUZZPIXEL (dest[fuzzoffset[fuzzpos]]);
+
+	if (++fuzzpos == FUZZTABLE)
+	    fuzzpos = 0;
+
+	dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawPixelFuzzColumnLow (void)
+{
+    int			count;
+    pixel_t*		dest;
+
+    if (!dc_yl)
+	dc_yl = 1;
+
+    if (dc_yh == viewheight-1)
+	dc_yh = viewheight - 2;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0 || dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawPixelFuzzColumn: %i to %i at %i",
+		 dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = pixelrows[dc_yl] + columnofs[dc_x << 1];
+
+    do
+    {
+	dest[0] = FUZZPIXEL (dest[fuzzoffset[fuzzpos]]);
+	dest[1] = FUZZPIXEL (dest[1 + fuzzoffset[fuzzpos]]);
+
+	if (++fuzzpos == FUZZTABLE)
+	    fuzzpos = 0;
+
+	dest += SCREENWIDTH;
+    } while (count--);
+}
+
+void R_DrawPixelTranslatedColumn (void)
+{
+    int			count;
+    pixel_t*		dest;
+    uint32_t*		pixelmap;
+    fixed_t		frac;
+    fixed_t		fracstep;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawPixelColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = pixelrows[dc_yl] + columnofs[dc_x];
+    pixelmap = PIXELMAP (dc_colormap);
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    do
+    {
+	*dest = pixelmap[dc_translation[dc_source[frac>>FRACBITS]]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    } while (count--);
+}
+
+void R_DrawPixelTranslatedColumnLow (void)
+{
+    int			count;
+    pixel_t*		dest;
+    uint32_t*		pixelmap;
+    fixed_t		frac;
+    fixed_t		fracstep;
+
+    count = dc_yh - dc_yl;
+
+    if (count < 0)
+	return;
+
+#ifdef RANGECHECK
+    if ((unsigned)dc_x >= SCREENWIDTH
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+	I_Error ("R_DrawPixelColumn: %i to %i at %i", dc_yl, dc_yh, dc_x);
+#endif
+
+    dest = pixelrows[dc_yl] + columnofs[dc_x << 1];
+    pixelmap = PIXELMAP (dc_colormap);
+
+    fracstep = dc_iscale;
+    frac = dc_texturemid + (dc_yl-centery)*fracstep;
+
+    do
+    {
+	dest[0] = dest[1] =
+	    pixelmap[dc_translation[dc_source[frac>>FRACBITS]]];
+	dest += SCREENWIDTH;
+	frac += fracstep;
+    } while (count--);
+}
+
+void R_DrawPixelSpan (void)
+{
+    unsigned int	position, step;
+    unsigned int	xtemp, ytemp;
+    pixel_t*		dest;
+    uint32_t*		pixelmap;
+    int			count;
+    int			spot;
+
+#ifdef RANGECHECK
+    if (ds_x2 < ds_x1
+	|| ds_x1<0
+	|| ds_x2>=SCREENWIDTH
+	|| (unsigned)ds_y>SCREENHEIGHT)
+	I_Error ("R_DrawPixelSpan: %i to %i at %i", ds_x1, ds_x2, ds_y);
+#endif
+
+    position = ((ds_xfrac << 10) & 0xffff0000)
+             | ((ds_yfrac >> 6)  & 0x0000ffff);
+    step = ((ds_xstep << 10) & 0xffff0000)
+         | ((ds_ystep >> 6)  & 0x0000ffff);
+
+    dest = pixelrows[ds_y] + columnofs[ds_x1];
+    pixelmap = PIXELMAP (ds_colormap);
+    count = ds_x2 - ds_x1;
+
+#if defined(__SSE2__)
+    if (count >= 8)
+    {
+	__m128i	pos[2];
+	__m128i	step8;
+	__m128i	spots;
+
+	R_SpanPositions (pos, position, step);
+	step8 = _mm_set1_epi32 (step * 8);
+
+	do
+	{
+	    spots = R_SpanSpots (pos, step8);
+
+	    _mm_storeu_si128 ((__m128i *) dest,
+		_mm_setr_epi32 (
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 0)]],
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 1)]],
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 2)]],
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 3)]]));
+	    _mm_storeu_si128 ((__m128i *) (dest + 4),
+		_mm_setr_epi32 (
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 4)]],
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 5)]],
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 6)]],
+		    pixelmap[ds_source[_mm_extract_epi16 (spots, 7)]]));
+
+	    dest += 8;
+	    position += step * 8;
+	    count -= 8;
+	} while (count >= 8);
+    }
+#endif
+
+    do
+    {
+        ytemp = (position >> 4) & 0x0fc0;
+        xtemp = (position >> 26);
+        spot = xtemp | ytemp;
+
+	*dest++ = pixelmap[ds_source[spot]];
+
+        position += step;
+    } while (count--);
+}
+
+void R_DrawPixelSpanLow (void)
+{
+    unsigned int	position, step;
+    unsigned int	xtemp, ytemp;
+    pixel_t*		dest;
+    uint32_t*		pixelmap;
+    int			count;
+    int			spot;
+
+#ifdef RANGECHECK
+    if (ds_x2 < ds_x1
+	|| ds_x1<0
+	|| ds_x2>=SCREENWIDTH
+	|| (unsigned)ds_y>SCREENHEIGHT)
+	I_Error ("R_DrawPixelSpan: %i to %i at %i", ds_x1, ds_x2, ds_y);
+#endif
+
+    position = ((ds_xfrac << 10) & 0xffff0000)
+             | ((ds_yfrac >> 6)  & 0x0000ffff);
+    step = ((ds_xstep << 10) & 0xffff0000)
+         | ((ds_ystep >> 6)  & 0x0000ffff);
+
+    count = ds_x2 - ds_x1;
+
+    // Blocky mode, need to multiply by 2.
+    ds_x1 <<= 1;
+    ds_x2 <<= 1;
+
+    dest = pixelrows[ds_y] + columnofs[ds_x1];
+    pixelmap = PIXELMAP (ds_colormap);
+
+    do
+    {
+        ytemp = (position >> 4) & 0x0fc0;
+        xtemp = (position >> 26);
+        spot = xtemp | ytemp;
+
+	dest[0] = dest[1] = pixelmap[ds_source[spot]];
+	dest += 2;
+
+        position += step;
+    } while (count--);
+}
+
+#endif  // CMAP256
+
+//
+// Parallel drawing.
+// With -renderthreads, the drawers are not called while the view
+//  is rendered.  R_RenderPlayerView still walks the BSP and builds
+//  the visplanes and vissprites on its own, but every column and
+//  span goes into the draw queue instead.  R_FlushDrawQueue then
+//  splits the view into vertical strips, one per worker thread,
+//  and each worker replays the whole queue clipped to its strip.
+// Every pixel is thus written by one thread, in the same order
+//  as when drawing directly.
+//
+typedef struct
+{
+    // The drawer to call, as selected by R_ExecuteSetViewSize.
+    void		(*drawer) (void);
+    boolean		span;
+
+    // dc_x, or ds_x1 to ds_x2.
+    int			x1;
+    int			x2;
+
+    // dc_yl to dc_yh, or ds_y.
+    int			y1;
+    int			y2;
+
+    lighttable_t*	colormap;
+    byte*		source;
+    byte*		translation;
+
+    // dc_iscale and dc_texturemid, or ds_xfrac to ds_ystep.
+    fixed_t		frac[4];
+
+    // fuzzpos at the top of a fuzz column.
+    int			fuzzpos;
+} drawcmd_t;
+
+// One strip per worker, 0 when drawing directly.
+static DG_STATE int		numdrawstrips;
+
+static DG_STATE drawcmd_t*	drawqueue;
+static DG_STATE int		numdrawcmds;
+static DG_STATE int		maxdrawcmds;
+
+static DG_STATE void		(*queuedcolfunc) (void);
+static DG_STATE void		(*queuedfuzzcolfunc) (void);
+static DG_STATE void		(*queuedtranscolfunc) (void);
+static DG_STATE void		(*queuedspanfunc) (void);
+
+
+static drawcmd_t* R_NewDrawCmd (void)
+{
+    if (numdrawcmds == maxdrawcmds)
+    {
+	maxdrawcmds = maxdrawcmds ? maxdrawcmds * 2 : 4096;
+	drawqueue = realloc (drawqueue, maxdrawcmds * sizeof(*drawqueue));
+
+	if (drawqueue == NULL)
+	    I_Error ("R_NewDrawCmd: out of memory for %i commands",
+		     maxdrawcmds);
+    }
+
+    return &drawqueue[numdrawcmds++];
+}
+
+static void R_QueueColumnWith (void (*drawer) (void))
+{
+    drawcmd_t*	cmd;
+
+    cmd = R_NewDrawCmd ();
+    cmd->drawer = drawer;
+    cmd->span = false;
+    cmd->x1 = cmd->x2 = dc_x;
+    cmd->y1 = dc_yl;
+    cmd->y2 = dc_yh;
+    cmd->colormap = dc_colormap;
+    cmd->source = dc_source;
+    cmd->translation = dc_translation;
+    cmd->frac[0] = dc_iscale;
+    cmd->frac[1] = dc_texturemid;
+    cmd->fuzzpos = fuzzpos;
+}
+
+static void R_QueueColumn (void)
+{
+    if (dc_yh >= dc_yl)
+	R_QueueColumnWith (queuedcolfunc);
+}
+
+static void R_QueueTranslatedColumn (void)
+{
+    if (dc_yh >= dc_yl)
+	R_QueueColumnWith (queuedtranscolfunc);
+}
+
+static void R_QueueFuzzColumn (void)
+{
+    // Same borders as R_DrawFuzzColumn.
+    if (!dc_yl) 
+	dc_yl = 1;
+
+    if (dc_yh == viewheight-1) 
+	dc_yh = viewheight - 2; 
+
+    if (dc_yh < dc_yl)
+	return;
+
+    R_QueueColumnWith (queuedfuzzcolfunc);
+
+    // The fuzz pattern runs on from one column to the next,
+    //  so step past the pixels this one is going to use.
+    fuzzpos = (fuzzpos + dc_yh - dc_yl + 1) % FUZZTABLE;
+}
+
+static void R_QueueSpan (void)
+{
+    drawcmd_t*	cmd;
+
+    cmd = R_NewDrawCmd ();
+    cmd->drawer = queuedspanfunc;
+    cmd->span = true;
+    cmd->x1 = ds_x1;
+    cmd->x2 = ds_x2;
+    cmd->y1 = cmd->y2 = ds_y;
+    cmd->colormap = ds_colormap;
+    cmd->source = ds_source;
+    cmd->frac[0] = ds_xfrac;
+    cmd->frac[1] = ds_yfrac;
+    cmd->frac[2] = ds_xstep;
+    cmd->frac[3] = ds_ystep;
+}
+
+//
+// R_DrawStrip
+// Replays the draw queue for one vertical strip of the view.
+//
+static void R_DrawStrip (void *data, int strip)
+{
+    drawcmd_t*		cmd;
+    drawcmd_t*		end;
+    int			x1;
+    int			x2;
+    unsigned int	position;
+    unsigned int	step;
+    colbatch_t		batch;
+
+    x1 = strip * viewwidth / numdrawstrips;
+    x2 = (strip + 1) * viewwidth / numdrawstrips - 1;
+
+    end = drawqueue + numdrawcmds;
+    batch.count = 0;
+
+    for (cmd = drawqueue ; cmd < end ; cmd++)
+    {
+	if (cmd->x2 < x1 || cmd->x1 > x2)
+	    continue;
+
+	// Runs of plain columns are drawn as batches.  Anything else
+	//  can overlap them, so the batch is drawn first.
+	if (batch.count
+	 && (cmd->drawer != R_DrawColumn
+	     || cmd->x1 != batch.x + batch.count
+	     || batch.count == COLUMNBATCH))
+	{
+	    R_DrawColumns (&batch);
+	    batch.count = 0;
+	}
+
+	if (cmd->span)
+	{
+	    ds_y = cmd->y1;
+	    ds_x1 = cmd->x1;
+	    ds_x2 = cmd->x2;
+	    ds_colormap = cmd->colormap;
+	    ds_source = cmd->source;
+	    ds_xfrac = cmd->frac[0];
+	    ds_yfrac = cmd->frac[1];
+	    ds_xstep = cmd->frac[2];
+	    ds_ystep = cmd->frac[3];
+
+	    if (ds_x1 < x1)
+	    {
+		// Step the packed position of R_DrawSpan along to
+		//  the edge of the strip, and unpack it again, so the
+		//  carries between u and v come out the same.
+		position = ((ds_xfrac << 10) & 0xffff0000)
+			 | ((ds_yfrac >> 6)  & 0x0000ffff);
+		step = ((ds_xstep << 10) & 0xffff0000)
+		     | ((ds_ystep >> 6)  & 0x0000ffff);
+
+		position += (x1 - ds_x1) * step;
+
+		ds_xfrac = (position >> 16) << 6;
+		ds_yfrac = (position & 0xffff) << 6;
+		ds_x1 = x1;
+	    }
+
+	    if (ds_x2 > x2)
+		ds_x2 = x2;
+	}
+	else
+	{
+	    dc_x = cmd->x1;
+	    dc_yl = cmd->y1;
+	    dc_yh = cmd->y2;
+	    dc_colormap = cmd->colormap;
+	    dc_source = cmd->source;
+	    dc_translation = cmd->translation;
+	    dc_iscale = cmd->frac[0];
+	    dc_texturemid = cmd->frac[1];
+	    fuzzpos = cmd->fuzzpos;
+
+	    if (cmd->drawer == R_DrawColumn && !columnmajor)
+	    {
+		R_AddToBatch (&batch);
+		continue;
+	    }
+	}
+
+	cmd->drawer ();
+    }
+
+    if (batch.count)
+	R_DrawColumns (&batch);
+}
+
+//
+// R_FlushDrawQueue
+// Draws everything queued so far, and waits for it.
+//
+void R_FlushDrawQueue (void)
+{
+    R_FlushWallColumns ();
+
+    if (numdrawcmds == 0)
+	return;
+
+    I_RunWorkers (R_DrawStrip, NULL, numdrawstrips);
+
+    numdrawcmds = 0;
+}
+
+//
+// R_InitDrawThreads
+// Starts the worker threads for parallel drawing.
+//
+void R_InitDrawThreads (int count)
+{
+    numdrawstrips = I_StartWorkers (count);
+}
+
+//
+// R_QueueDrawers
+// Called after the drawers are selected: with worker threads,
+//  they are swapped for ones that add to the draw queue.
+//
+void R_QueueDrawers (void)
+{
+    if (!numdrawstrips)
+	return;
+
+    queuedcolfunc = basecolfunc;
+    queuedfuzzcolfunc = fuzzcolfunc;
+    queuedtranscolfunc = transcolfunc;
+    queuedspanfunc = spanfunc;
+
+    colfunc = basecolfunc = R_QueueColumn;
+    fuzzcolfunc = R_QueueFuzzColumn;
+    transcolfunc = R_QueueTranslatedColumn;
+    spanfunc = R_QueueSpan;
+}
+
+
+//
+// Wall column batches, one for each tier of wall, so that the
+//  columns of each tier stay adjacent.
+//
+static DG_STATE colbatch_t	wallbatches[NUMWALLTIERS];
+
+//
+// R_FlushWallBatch
+// With worker threads, the columns are queued in the order of
+//  the batch, for R_DrawStrip to batch up again.  The dc_*
+//  globals are left alone, as the wall tier being drawn may
+//  still need them.
+//
+static void R_FlushWallBatch (colbatch_t* batch)
+{
+    drawcmd_t*	cmd;
+    int		i;
+
+    if (colfunc == R_DrawColumn)
+    {
+	R_DrawColumns (batch);
+    }
+    else
+    {
+	for (i=0 ; i<batch->count ; i++)
+	{
+	    cmd = R_NewDrawCmd ();
+	    cmd->drawer = queuedcolfunc;
+	    cmd->span = false;
+	    cmd->x1 = cmd->x2 = batch->x + i;
+	    cmd->y1 = batch->yl[i];
+	    cmd->y2 = batch->yh[i];
+	    cmd->colormap = batch->colormap[i];
+	    cmd->source = batch->source[i];
+	    cmd->translation = NULL;
+	    cmd->frac[0] = batch->iscale[i];
+	    cmd->frac[1] = batch->texturemid[i];
+	    cmd->fuzzpos = 0;
+	}
+    }
+
+    batch->count = 0;
+}
+
+//
+// R_BatchWallColumn
+// Draws a wall column like colfunc, but possibly later: the
+//  column is added to the batch of its tier when the plain column
+//  drawer is in use.  R_FlushWallColumns must be called before
+//  anything else is drawn where it is.
+//
+void R_BatchWallColumn (walltier_t tier)
+{
+    colbatch_t*	batch;
+
+    // Columns are contiguous already when drawing column-major.
+    if (columnmajor
+     || (colfunc != R_DrawColumn
+	 && !(colfunc == R_QueueColumn && queuedcolfunc == R_DrawColumn)))
+    {
+	colfunc ();
+	return;
+    }
+
+    if (dc_yh < dc_yl)
+	return;
+
+    batch = &wallbatches[tier];
+
+    if (batch->count
+     && (dc_x != batch->x + batch->count || batch->count == COLUMNBATCH))
+    {
+	R_FlushWallBatch (batch);
+    }
+
+    R_AddToBatch (batch);
+}
+
+//
+// R_FlushWallColumns
+// Draws the batched wall columns.
+//
+void R_FlushWallColumns (void)
+{
+    int		tier;
+
+    for (tier=0 ; tier<NUMWALLTIERS ; tier++)
+    {
+	if (wallbatches[tier].count)
+	    R_FlushWallBatch (&wallbatches[tier]);
+    }
+}
+
+//
+// R_InitBuffer 
+// Creats lookup tables that avoid
+//  multiplies and other hazzles
+//  for getting the framebuffer address
+//  of a pixel to draw.
+//
+void
+R_InitBuffer
+( int		width,
+  int		height ) 
+{ 
+    int		i; 
+
+    // Handle resize,
+    //  e.g. smaller view windows
+    //  with border and/or status bar.
+    viewwindowx = (SCREENWIDTH-width) >> 1; 
+
+    // Samw with base row offset.
+    if (width == SCREENWIDTH) 
+	viewwindowy = 0; 
+    else 
+	viewwindowy = (SCREENHEIGHT-SBARHEIGHT-height) >> 1; 
+
+    if (columnmajor)
+    {
+	if (viewbuffer == NULL)
+	{
+	    viewbuffer = Z_Malloc (SCREENWIDTH*SCREENHEIGHT,
+				   PU_STATIC, NULL);
+	}
+
+	// Columns of SCREENHEIGHT pixels, from the top left
+	//  of the view.
+	viewpitch = 1;
+	viewstep = SCREENHEIGHT;
+
+	for (i=0 ; i<width ; i++) 
+	    columnofs[i] = i*SCREENHEIGHT;
+
+	for (i=0 ; i<height ; i++) 
+	    ylookup[i] = viewbuffer + i; 
+    }
+    else
+    {
+	viewpitch = SCREENWIDTH;
+	viewstep = 1;
+
+	// Column offset. For windows.
+	for (i=0 ; i<width ; i++) 
+	    columnofs[i] = viewwindowx + i;
+
+	// Preclaculate all row offsets.
+	for (i=0 ; i<height ; i++) 
+	    ylookup[i] = I_VideoBuffer + (i+viewwindowy)*SCREENWIDTH; 
+
+#ifndef CMAP256
+	for (i=0 ; i<height ; i++) 
+	    pixelrows[i] = DG_ScreenBuffer + (i+viewwindowy)*SCREENWIDTH; 
+#endif
+    }
+
+    for (i=0 ; i<FUZZTABLE ; i++)
+	fuzzoffset[i] = fuzzrows[i]*viewpitch;
+} 
+
+
+//
+// R_CopyViewBuffer
+// Copies a column-major view into its window on the screen,
+//  in tiles that fit in the cache both ways round.  With worker
+//  threads, each copies its own strip.
+//
+#define VIEWTILE	32
+
+static void R_CopyViewStrip (void *data, int strip)
+{
+    int		strips;
+    int		x1;
+    int		x2;
+    int		tx;
+    int		ty;
+    int		tx2;
+    int		ty2;
+    int		x;
+    int		y;
+    byte*	screen;
+    byte*	dest;
+    byte*	source;
+
+    strips = numdrawstrips ? numdrawstrips : 1;
+    x1 = strip * scaledviewwidth / strips;
+    x2 = (strip + 1) * scaledviewwidth / strips;
+
+    screen = I_VideoBuffer + viewwindowy*SCREENWIDTH + viewwindowx;
+
+    for (ty=0 ; ty<viewheight ; ty+=VIEWTILE)
+    {
+	ty2 = ty + VIEWTILE < viewheight ? ty + VIEWTILE : viewheight;
+
+	for (tx=x1 ; tx<x2 ; tx+=VIEWTILE)
+	{
+	    tx2 = tx + VIEWTILE < x2 ? tx + VIEWTILE : x2;
+
+	    for (y=ty ; y<ty2 ; y++)
+	    {
+		dest = screen + y*SCREENWIDTH;
+		source = viewbuffer + y;
+
+		for (x=tx ; x<tx2 ; x++)
+		    dest[x] = source[x*SCREENHEIGHT];
+	    }
+	}
+    }
+}
+
+void R_CopyViewBuffer (void)
+{
+    if (!columnmajor)
+	return;
+
+    I_RunWorkers (R_CopyViewStrip, NULL, numdrawstrips ? numdrawstrips : 1);
+}
+ 
+ 
+
+
+//
+// R_FillBackScreen
+// Fills the back screen with a pattern
+//  for variable screen sizes
+// Also draws a beveled edge.
+//
+void R_FillBackScreen (void) 
+{ 
+    byte*	src;
+    byte*	dest; 
+    int		x;
+    int		y; 
+    int		x1, y1, x2, y2;
+    patch_t*	patch;
+
+    // DOOM border patch.
+    char       *name1 = DEH_String("FLOOR7_2");
+
+    // DOOM II border patch.
+    char *name2 = DEH_String("GRNROCK");
+
+    char *name;
+
+    // If we are running full screen, there is no need to do any of this,
+    // and the background buffer can be freed if it was previously in use.
+
+    if (scaledviewwidth == SCREENWIDTH)
+    {
+        if (background_buffer != NULL)
+        {
+            Z_Free(background_buffer);
+            background_buffer = NULL;
+        }
+
+	return;
+    }
+
+    // Allocate the background buffer if necessary
+	
+    // The whole screen, as the bezel patches are drawn in the
+    //  original coordinates and may stray into the status bar rows.
+    if (background_buffer == NULL)
+    {
+        background_buffer = Z_Malloc(SCREENWIDTH * SCREENHEIGHT,
+                                     PU_STATIC, NULL);
+    }
+
+    if (gamemode == commercial)
+	name = name2;
+    else
+	name = name1;
+    
+    src = W_CacheLumpName(name, PU_CACHE); 
+    dest = background_buffer;
+	 
+    V_FillFlat (src, dest, SCREENHEIGHT-SBARHEIGHT);
      
     // Draw screen and bezel; this is done to a separate screen buffer.
+    // The view window in original coordinates, rounded inwards so
+    //  that the bezel meets the view without a gap.
+    x1 = (viewwindowx*ORIGWIDTH + SCREENWIDTH-1) / SCREENWIDTH;
+    y1 = (viewwindowy*ORIGHEIGHT + SCREENHEIGHT-1) / SCREENHEIGHT;
+    x2 = V_OrigX(viewwindowx+scaledviewwidth);
+    y2 = V_OrigY(viewwindowy+viewheight);
 
     V_UseBuffer(background_buffer);
 
     patch = W_CacheLumpName(DEH_String("brdr_t"),PU_CACHE);
 
-    for (x=0 ; x<scaledviewwidth ; x+=8)
-	V_DrawPatch(viewwindowx+x, viewwindowy-8, patch);
+    for (x=x1 ; x<x2 ; x+=8)
+	V_DrawPatch(x, y1-8, patch);
     patch = W_CacheLumpName(DEH_String("brdr_b"),PU_CACHE);
 
-    for (x=0 ; x<scaledviewwidth ; x+=8)
-	V_DrawPatch(viewwindowx+x, viewwindowy+viewheight, patch);
+    for (x=x1 ; x<x2 ; x+=8)
+	V_DrawPatch(x, y2, patch);
     patch = W_CacheLumpName(DEH_String("brdr_l"),PU_CACHE);
 
-    for (y=0 ; y<viewheight ; y+=8)
-	V_DrawPatch(viewwindowx-8, viewwindowy+y, patch);
+    for (y=y1 ; y<y2 ; y+=8)
+	V_DrawPatch(x1-8, y, patch);
     patch = W_CacheLumpName(DEH_String("brdr_r"),PU_CACHE);
 
-    for (y=0 ; y<viewheight ; y+=8)
-	V_DrawPatch(viewwindowx+scaledviewwidth, viewwindowy+y, patch);
+    for (y=y1 ; y<y2 ; y+=8)
+	V_DrawPatch(x2, y, patch);
 
     // Draw beveled edge. 
-    V_DrawPatch(viewwindowx-8,
-                viewwindowy-8,
+    V_DrawPatch(x1-8,
+                y1-8,
                 W_CacheLumpName(DEH_String("brdr_tl"),PU_CACHE));
     
-    V_DrawPatch(viewwindowx+scaledviewwidth,
-                viewwindowy-8,
+    V_DrawPatch(x2,
+                y1-8,
                 W_CacheLumpName(DEH_String("brdr_tr"),PU_CACHE));
     
-    V_DrawPatch(viewwindowx-8,
-                viewwindowy+viewheight,
+    V_DrawPatch(x1-8,
+                y2,
                 W_CacheLumpName(DEH_String("brdr_bl"),PU_CACHE));
     
-    V_DrawPatch(viewwindowx+scaledviewwidth,
-                viewwindowy+viewheight,
+    V_DrawPatch(x2,
+                y2,
                 W_CacheLumpName(DEH_String("brdr_br"),PU_CACHE));
 
     V_RestoreBuffer();
@@ -23,15 +23,15 @@
 
 
 
-extern lighttable_t*	dc_colormap;
-extern int		dc_x;
-extern int		dc_yl;
-extern int		dc_yh;
-extern fixed_t		dc_iscale;
-extern fixed_t		dc_texturemid;
+extern DG_THREAD_LOCAL lighttable_t*	dc_colormap;
+extern DG_THREAD_LOCAL int		dc_x;
+extern DG_THREAD_LOCAL int		dc_yl;
+extern DG_THREAD_LOCAL int		dc_yh;
+extern DG_THREAD_LOCAL fixed_t		dc_iscale;
+extern DG_THREAD_LOCAL fixed_t		dc_texturemid;
 
 // first pixel in a column
-extern byte*		dc_source;		
+extern DG_THREAD_LOCAL byte*		dc_source;		
 
 
 // The span blitting interface.
@@ -55,22 +55,22 @@ R_VideoErase
 ( unsigned	ofs,
   int		count );
 
-extern int		ds_y;
-extern int		ds_x1;
-extern int		ds_x2;
+extern DG_THREAD_LOCAL int		ds_y;
+extern DG_THREAD_LOCAL int		ds_x1;
+extern DG_THREAD_LOCAL int		ds_x2;
 
-extern lighttable_t*	ds_colormap;
+extern DG_THREAD_LOCAL lighttable_t*	ds_colormap;
 
-extern fixed_t		ds_xfrac;
-extern fixed_t		ds_yfrac;
-extern fixed_t		ds_xstep;
-extern fixed_t		ds_ystep;
+extern DG_THREAD_LOCAL fixed_t		ds_xfrac;
+extern DG_THREAD_LOCAL fixed_t		ds_yfrac;
+extern DG_THREAD_LOCAL fixed_t		ds_xstep;
+extern DG_THREAD_LOCAL fixed_t		ds_ystep;
 
 // start of a 64*64 tile image
-extern byte*		ds_source;		
+extern DG_THREAD_LOCAL byte*		ds_source;		
 
-extern byte*		translationtables;
-extern byte*		dc_translation;
+extern DG_STATE byte*		translationtables;
+extern DG_THREAD_LOCAL byte*		dc_translation;
 
 
 // Span blitting for rows, floor/ceiling.
@@ -80,6 +80,24 @@ void 	R_DrawSpan (void);
 // Low resolution mode, 160x200?
 void 	R_DrawSpanLow (void);
 
+// Checks the SSE2 span drawers against the scalar ones (-spantest).
+int	R_TestSpans (void);
+
+
+#ifndef CMAP256
+
+// The same, writing pixels to DG_ScreenBuffer with -truecolor.
+void	R_DrawPixelColumn (void);
+void	R_DrawPixelColumnLow (void);
+void	R_DrawPixelFuzzColumn (void);
+void	R_DrawPixelFuzzColumnLow (void);
+void	R_DrawPixelTranslatedColumn (void);
+void	R_DrawPixelTranslatedColumnLow (void);
+void	R_DrawPixelSpan (void);
+void	R_DrawPixelSpanLow (void);
+
+#endif
+
 
 void
 R_InitBuffer
@@ -87,6 +105,30 @@ R_InitBuffer
   int		height );
 
 
+// Drawing the view column-major.
+extern DG_STATE boolean		columnmajor;
+void	R_CopyViewBuffer (void);
+
+
+// Parallel drawing with worker threads.
+void	R_InitDrawThreads (int count);
+void	R_QueueDrawers (void);
+void	R_FlushDrawQueue (void);
+
+
+// Batched drawing of adjacent wall columns.
+typedef enum
+{
+    wt_top,
+    wt_mid,
+    wt_bottom,
+    NUMWALLTIERS
+} walltier_t;
+
+void	R_BatchWallColumn (walltier_t tier);
+void	R_FlushWallColumns (void);
+
+
 // Initialize color translation tables,
 //  for player rendering etc.
 void	R_InitTranslationTables (void);
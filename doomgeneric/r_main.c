@@ -23,17 +23,26 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 
 #include "doomdef.h"
 #include "d_loop.h"
+#include "i_system.h"
+#include "i_video.h"
 
+#include "m_argv.h"
 #include "m_bbox.h"
 #include "m_menu.h"
+#include "m_prof.h"
+#include "z_zone.h"
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "st_stuff.h"
+
+#include "doomstat.h"
 
 
 
@@ -44,73 +53,80 @@
 
 
 
-int			viewangleoffset;
+DG_STATE int			viewangleoffset;
 
 // increment every time a check is made
-int			validcount = 1;		
+DG_STATE int			validcount = 1;		
 
 
-lighttable_t*		fixedcolormap;
-extern lighttable_t**	walllights;
+DG_STATE lighttable_t*		fixedcolormap;
+extern DG_STATE lighttable_t**	walllights;
 
-int			centerx;
-int			centery;
+DG_STATE int			centerx;
+DG_STATE int			centery;
 
-fixed_t			centerxfrac;
-fixed_t			centeryfrac;
-fixed_t			projection;
+DG_STATE fixed_t			centerxfrac;
+DG_STATE fixed_t			centeryfrac;
+DG_STATE fixed_t			projection;
 
 // just for profiling purposes
-int			framecount;	
+DG_STATE int			framecount;	
 
-int			sscount;
-int			linecount;
-int			loopcount;
+DG_STATE int			sscount;
+DG_STATE int			linecount;
+DG_STATE int			loopcount;
 
-fixed_t			viewx;
-fixed_t			viewy;
-fixed_t			viewz;
+DG_STATE fixed_t			viewx;
+DG_STATE fixed_t			viewy;
+DG_STATE fixed_t			viewz;
 
-angle_t			viewangle;
+DG_STATE angle_t			viewangle;
 
-fixed_t			viewcos;
-fixed_t			viewsin;
+DG_STATE fixed_t			viewcos;
+DG_STATE fixed_t			viewsin;
 
-player_t*		viewplayer;
+DG_STATE player_t*		viewplayer;
 
 // 0 = high, 1 = low
-int			detailshift;	
+DG_STATE int			detailshift;	
 
 //
 // precalculated math tables
 //
-angle_t			clipangle;
+DG_STATE angle_t			clipangle;
 
 // The viewangletox[viewangle + FINEANGLES/4] lookup
 // maps the visible view angles to screen X coordinates,
 // flattening the arc to a flat projection plane.
 // There will be many angles mapped to the same X. 
-int			viewangletox[FINEANGLES/2];
+DG_STATE int			viewangletox[FINEANGLES/2];
 
 // The xtoviewangleangle[] table maps a screen pixel
 // to the lowest viewangle that maps back to x ranges
 // from clipangle to -clipangle.
-angle_t			xtoviewangle[SCREENWIDTH+1];
+DG_STATE angle_t			xtoviewangle[MAXWIDTH+1];
 
-lighttable_t*		scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
-lighttable_t*		scalelightfixed[MAXLIGHTSCALE];
-lighttable_t*		zlight[LIGHTLEVELS][MAXLIGHTZ];
+DG_STATE lighttable_t*		scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
+DG_STATE lighttable_t*		scalelightfixed[MAXLIGHTSCALE];
+DG_STATE int			numlightscales;
+DG_STATE lighttable_t*		zlight[LIGHTLEVELS][MAXLIGHTZ];
 
 // bumped light from gun blasts
-int			extralight;			
+DG_STATE int			extralight;			
+
+// scalelight and zlight rows for each sector light level, with
+//  extralight added in; see R_SetupLevelLights.
+DG_STATE lighttable_t**		levelscalelight[NUMLEVELLIGHTS];
+DG_STATE lighttable_t**		levelzlight[NUMLEVELLIGHTS];
+static DG_STATE int		levellightsextra = -1;
 
 
 
-void (*colfunc) (void);
-void (*basecolfunc) (void);
-void (*fuzzcolfunc) (void);
-void (*transcolfunc) (void);
-void (*spanfunc) (void);
+DG_STATE void (*colfunc) (void);
+DG_STATE void (*basecolfunc) (void);
+DG_STATE void (*fuzzcolfunc) (void);
+DG_STATE void (*transcolfunc) (void);
+DG_STATE void (*spanfunc) (void);
 
 
 
@@ -549,7 +565,7 @@ void R_InitTextureMapping (void)
     //  after the view angle.
     //
     // Calc focallength
-    //  so FIELDOFVIEW angles covers SCREENWIDTH.
+    //  so FIELDOFVIEW angles covers viewwidth.
     focallength = FixedDiv (centerxfrac,
 			    finetangent[FINEANGLES/4+FIELDOFVIEW/2] );
 	
@@ -622,7 +638,7 @@ void R_InitLightTables (void)
 	startmap = ((LIGHTLEVELS-1-i)*2)*NUMCOLORMAPS/LIGHTLEVELS;
 	for (j=0 ; j<MAXLIGHTZ ; j++)
 	{
-	    scale = FixedDiv ((SCREENWIDTH/2*FRACUNIT), (j+1)<<LIGHTZSHIFT);
+	    scale = FixedDiv ((ORIGWIDTH/2*FRACUNIT), (j+1)<<LIGHTZSHIFT);
 	    scale >>= LIGHTSCALESHIFT;
 	    level = startmap - scale/DISTMAP;
 	    
@@ -645,9 +661,9 @@ void R_InitLightTables (void)
 //  because it might be in the middle of a refresh.
 // The change will take effect next refresh.
 //
-boolean		setsizeneeded;
-int		setblocks;
-int		setdetail;
+DG_STATE boolean		setsizeneeded;
+DG_STATE int		setblocks;
+DG_STATE int		setdetail;
 
 
 void
@@ -661,6 +677,55 @@ R_SetViewSize
 }
 
 
+// Whether the drawers write pixels to DG_ScreenBuffer.
+static DG_STATE boolean	pixeldrawers;
+
+//
+// R_SelectDrawers
+// Picks the column and span drawers for the detail level, either
+//  the ones that write palette indices to I_VideoBuffer, or for a
+//  truecolor view the ones that write pixels to DG_ScreenBuffer.
+//
+static void R_SelectDrawers (boolean pixels)
+{
+#ifndef CMAP256
+    if (pixels && !detailshift)
+    {
+	colfunc = basecolfunc = R_DrawPixelColumn;
+	fuzzcolfunc = R_DrawPixelFuzzColumn;
+	transcolfunc = R_DrawPixelTranslatedColumn;
+	spanfunc = R_DrawPixelSpan;
+    }
+    else if (pixels)
+    {
+	colfunc = basecolfunc = R_DrawPixelColumnLow;
+	fuzzcolfunc = R_DrawPixelFuzzColumnLow;
+	transcolfunc = R_DrawPixelTranslatedColumnLow;
+	spanfunc = R_DrawPixelSpanLow;
+    }
+    else
+#endif
+    if (!detailshift)
+    {
+	colfunc = basecolfunc = R_DrawColumn;
+	fuzzcolfunc = R_DrawFuzzColumn;
+	transcolfunc = R_DrawTranslatedColumn;
+	spanfunc = R_DrawSpan;
+    }
+    else
+    {
+	colfunc = basecolfunc = R_DrawColumnLow;
+	fuzzcolfunc = R_DrawFuzzColumnLow;
+	transcolfunc = R_DrawTranslatedColumnLow;
+	spanfunc = R_DrawSpanLow;
+    }
+
+    pixeldrawers = pixels;
+
+    R_QueueDrawers ();
+}
+
+
 //
 // R_ExecuteSetViewSize
 //
@@ -682,8 +747,8 @@ void R_ExecuteSetViewSize (void)
     }
     else
     {
-	scaledviewwidth = setblocks*32;
-	viewheight = (setblocks*168/10)&~7;
+	scaledviewwidth = (setblocks*SCREENWIDTH/10)&~7;
+	viewheight = (setblocks*(SCREENHEIGHT-SBARHEIGHT)/10)&~7;
     }
     
     detailshift = setdetail;
@@ -695,28 +760,15 @@ void R_ExecuteSetViewSize (void)
     centeryfrac = centery<<FRACBITS;
     projection = centerxfrac;
 
-    if (!detailshift)
-    {
-	colfunc = basecolfunc = R_DrawColumn;
-	fuzzcolfunc = R_DrawFuzzColumn;
-	transcolfunc = R_DrawTranslatedColumn;
-	spanfunc = R_DrawSpan;
-    }
-    else
-    {
-	colfunc = basecolfunc = R_DrawColumnLow;
-	fuzzcolfunc = R_DrawFuzzColumnLow;
-	transcolfunc = R_DrawTranslatedColumnLow;
-	spanfunc = R_DrawSpanLow;
-    }
+    R_SelectDrawers (false);
 
     R_InitBuffer (scaledviewwidth, viewheight);
 	
     R_InitTextureMapping ();
     
     // psprite scales
-    pspritescale = FRACUNIT*viewwidth/SCREENWIDTH;
-    pspriteiscale = FRACUNIT*SCREENWIDTH/viewwidth;
+    pspritescale = FRACUNIT*viewwidth/ORIGWIDTH;
+    pspriteiscale = FRACUNIT*ORIGWIDTH/viewwidth;
     
     // thing clipping
     for (i=0 ; i<viewwidth ; i++)
@@ -738,12 +790,14 @@ void R_ExecuteSetViewSize (void)
     
     // Calculate the light levels to use
     //  for each level / scale combination.
+    numlightscales = 48*SCREENWIDTH/ORIGWIDTH;
+
     for (i=0 ; i< LIGHTLEVELS ; i++)
     {
 	startmap = ((LIGHTLEVELS-1-i)*2)*NUMCOLORMAPS/LIGHTLEVELS;
-	for (j=0 ; j<MAXLIGHTSCALE ; j++)
+	for (j=0 ; j<numlightscales ; j++)
 	{
-	    level = startmap - j*SCREENWIDTH/(viewwidth<<detailshift)/DISTMAP;
+	    level = startmap - j*ORIGWIDTH/(viewwidth<<detailshift)/DISTMAP;
 	    
 	    if (level < 0)
 		level = 0;
@@ -758,6 +812,91 @@ void R_ExecuteSetViewSize (void)
 
 
 
+//
+// RENDERER LIMITS
+// The arrays of visplanes, drawsegs, vissprites and openings start
+//  out at the vanilla limits and are grown whenever a frame needs
+//  more.  The most of each used in one frame is reported at exit.
+//
+static DG_STATE int		highvisplanes;
+static DG_STATE int		highdrawsegs;
+static DG_STATE int		highvissprites;
+static DG_STATE int		highopenings;
+
+
+//
+// R_GrowArray
+// Doubles an array of *max elements of the given size, or allocates
+//  initial elements if there is none yet.  The new part is zeroed.
+//
+void*
+R_GrowArray
+( void*		array,
+  int*		max,
+  size_t	size,
+  int		initial )
+{
+    int		oldmax;
+
+    oldmax = *max;
+    *max = oldmax ? oldmax * 2 : initial;
+
+    array = realloc (array, *max * size);
+
+    if (array == NULL)
+	I_Error ("R_GrowArray: failed to grow to %i elements", *max);
+
+    memset ((byte *) array + oldmax * size, 0, (*max - oldmax) * size);
+
+    return array;
+}
+
+
+static void R_UpdateLimits (void)
+{
+    if (highvisplanes < numvisplanes)
+	highvisplanes = numvisplanes;
+    if (highdrawsegs < ds_p - drawsegs)
+	highdrawsegs = ds_p - drawsegs;
+    if (highvissprites < vissprite_p - vissprites)
+	highvissprites = vissprite_p - vissprites;
+    if (highopenings < lastopening - openings)
+	highopenings = lastopening - openings;
+}
+
+
+static void R_ReportLimit (char *name, int high, int vanilla)
+{
+    printf ("  %-10s %7i%s\n", name, high,
+	    high > vanilla ? "  (over the vanilla limit)" : "");
+}
+
+
+//
+// R_ReportLimits
+// Called at exit.  Quiet unless -devparm is given
+//  or a vanilla limit was exceeded.
+//
+static void R_ReportLimits (void)
+{
+    if (!devparm
+     && highvisplanes <= MAXVISPLANES
+     && highdrawsegs <= MAXDRAWSEGS
+     && highvissprites <= MAXVISSPRITES
+     && highopenings <= MAXOPENINGS)
+    {
+	return;
+    }
+
+    printf ("R_ReportLimits: most used in one frame:\n");
+    R_ReportLimit ("visplanes", highvisplanes, MAXVISPLANES);
+    R_ReportLimit ("drawsegs", highdrawsegs, MAXDRAWSEGS);
+    R_ReportLimit ("vissprites", highvissprites, MAXVISSPRITES);
+    R_ReportLimit ("openings", highopenings, MAXOPENINGS);
+}
+
+
+
 //
 // R_Init
 //
@@ -766,6 +905,8 @@ void R_ExecuteSetViewSize (void)
 
 void R_Init (void)
 {
+    int		p;
+
     R_InitData ();
     printf (".");
     R_InitPointToAngle ();
@@ -782,6 +923,37 @@ void R_Init (void)
     R_InitSkyMap ();
     R_InitTranslationTables ();
     printf (".");
+
+    //!
+    // @arg <n>
+    // @category video
+    //
+    // Draw the view with n worker threads, each filling in its own
+    // vertical strip of the screen.  The same threads convert the
+    // map data when a level is loaded.
+    //
+
+    p = M_CheckParmWithArgs ("-renderthreads", 1);
+
+    if (p > 0)
+	R_InitDrawThreads (atoi (myargv[p+1]));
+
+    //!
+    // @category video
+    //
+    // Draw the 3D view into a buffer that is stored a column at a
+    // time, so that drawing walls and sprites writes to memory in
+    // order, and copy it to the screen when the view is done.
+    //
+
+    columnmajor = M_CheckParm ("-columnmajor") > 0;
+
+    // The draw queue and the wall column batches point into cached
+    //  textures and patches, which have to stay around until they
+    //  have been drawn.
+    Z_SetPurgeHook (R_FlushDrawQueue);
+
+    I_AtExit (R_ReportLimits, false);
 	
     framecount = 0;
 }
@@ -817,6 +989,38 @@ R_PointInSubsector
 
 
 
+//
+// R_SetupLevelLights
+// Picks the light tables for every sector light level, so that
+//  walls, planes and sprites need not shift and clamp the level
+//  themselves.  Only extralight changes them.
+//
+static void R_SetupLevelLights (void)
+{
+    int		i;
+    int		lightnum;
+
+    if (extralight == levellightsextra)
+	return;
+
+    levellightsextra = extralight;
+
+    for (i=0 ; i<NUMLEVELLIGHTS ; i++)
+    {
+	lightnum = ((i + MINLIGHTLEVEL) >> LIGHTSEGSHIFT) + extralight;
+
+	if (lightnum < 0)
+	    lightnum = 0;
+	else if (lightnum >= LIGHTLEVELS)
+	    lightnum = LIGHTLEVELS-1;
+
+	levelscalelight[i] = scalelight[lightnum];
+	levelzlight[i] = zlight[lightnum];
+    }
+}
+
+
+
 //
 // R_SetupFrame
 //
@@ -829,6 +1033,7 @@ void R_SetupFrame (player_t* player)
     viewy = player->mo->y;
     viewangle = player->mo->angle + viewangleoffset;
     extralight = player->extralight;
+    R_SetupLevelLights ();
 
     viewz = player->viewz;
     
@@ -845,7 +1050,7 @@ void R_SetupFrame (player_t* player)
 	
 	walllights = scalelightfixed;
 
-	for (i=0 ; i<MAXLIGHTSCALE ; i++)
+	for (i=0 ; i<numlightscales ; i++)
 	    scalelightfixed[i] = fixedcolormap;
     }
     else
@@ -862,6 +1067,20 @@ void R_SetupFrame (player_t* player)
 //
 void R_RenderPlayerView (player_t* player)
 {	
+    boolean	pixels;
+
+    // With -truecolor, the view is drawn straight into DG_ScreenBuffer,
+    //  except when a wipe starts from this frame and needs it in
+    //  I_VideoBuffer.
+#ifndef CMAP256
+    pixels = truecolor && !columnmajor && gamestate == wipegamestate;
+#else
+    pixels = false;
+#endif
+
+    if (pixels != pixeldrawers)
+	R_SelectDrawers (pixels);
+
     R_SetupFrame (player);
 
     // Clear buffers.
@@ -874,17 +1093,34 @@ void R_RenderPlayerView (player_t* player)
     NetUpdate ();
 
     // The head node is the last node output.
+    PROF_BEGIN (prof_bspnode);
     R_RenderBSPNode (numnodes-1);
+    PROF_END (prof_bspnode);
     
     // Check for new console commands.
     NetUpdate ();
     
+    PROF_BEGIN (prof_drawplanes);
     R_DrawPlanes ();
+    PROF_END (prof_drawplanes);
     
     // Check for new console commands.
     NetUpdate ();
     
+    PROF_BEGIN (prof_drawmasked);
     R_DrawMasked ();
+    PROF_END (prof_drawmasked);
+
+    // Wait for the worker threads, if any, to finish the view.
+    R_FlushDrawQueue ();
+    R_CopyViewBuffer ();
+
+#ifndef CMAP256
+    if (pixels)
+	I_MarkTrueColor (viewwindowx, viewwindowy, scaledviewwidth, viewheight);
+#endif
+
+    R_UpdateLimits ();
 
     // Check for new console commands.
     NetUpdate ();				
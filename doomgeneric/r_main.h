@@ -29,25 +29,25 @@
 //
 // POV related.
 //
-extern fixed_t		viewcos;
-extern fixed_t		viewsin;
+extern DG_STATE fixed_t		viewcos;
+extern DG_STATE fixed_t		viewsin;
 
-extern int		viewwindowx;
-extern int		viewwindowy;
+extern DG_STATE int		viewwindowx;
+extern DG_STATE int		viewwindowy;
 
 
 
-extern int		centerx;
-extern int		centery;
+extern DG_STATE int		centerx;
+extern DG_STATE int		centery;
 
-extern fixed_t		centerxfrac;
-extern fixed_t		centeryfrac;
-extern fixed_t		projection;
+extern DG_STATE fixed_t		centerxfrac;
+extern DG_STATE fixed_t		centeryfrac;
+extern DG_STATE fixed_t		projection;
 
-extern int		validcount;
+extern DG_STATE int		validcount;
 
-extern int		linecount;
-extern int		loopcount;
+extern DG_STATE int		linecount;
+extern DG_STATE int		loopcount;
 
 
 //
@@ -61,17 +61,49 @@ extern int		loopcount;
 #define LIGHTLEVELS	        16
 #define LIGHTSEGSHIFT	         4
 
-#define MAXLIGHTSCALE		48
+// Wall and sprite scales grow with the screen width, so there are
+//  48 light levels per 320 columns, up to MAXLIGHTSCALE.
+#define MAXLIGHTSCALE		(48*MAXWIDTH/ORIGWIDTH)
 #define LIGHTSCALESHIFT		12
 #define MAXLIGHTZ	       128
 #define LIGHTZSHIFT		20
 
-extern lighttable_t*	scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
-extern lighttable_t*	scalelightfixed[MAXLIGHTSCALE];
-extern lighttable_t*	zlight[LIGHTLEVELS][MAXLIGHTZ];
+extern DG_STATE lighttable_t*	scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
+extern DG_STATE lighttable_t*	scalelightfixed[MAXLIGHTSCALE];
+extern DG_STATE lighttable_t*	zlight[LIGHTLEVELS][MAXLIGHTZ];
+extern DG_STATE int		numlightscales;
 
-extern int		extralight;
-extern lighttable_t*	fixedcolormap;
+extern DG_STATE int		extralight;
+extern DG_STATE lighttable_t*	fixedcolormap;
+
+// Sector light levels with their own entry in levelscalelight and
+//  levelzlight; the levels outside light the same as the nearest
+//  one inside.
+#define MINLIGHTLEVEL		(-256)
+#define MAXLIGHTLEVEL		511
+#define NUMLEVELLIGHTS		(MAXLIGHTLEVEL-MINLIGHTLEVEL+1)
+
+// Fake contrast: walls along the map axes are lit one step darker
+//  or lighter than their sector.
+#define LIGHTCONTRAST		(1<<LIGHTSEGSHIFT)
+
+extern DG_STATE lighttable_t**	levelscalelight[NUMLEVELLIGHTS];
+extern DG_STATE lighttable_t**	levelzlight[NUMLEVELLIGHTS];
+
+static inline int R_LightLevelIndex (int lightlevel)
+{
+    if (lightlevel < MINLIGHTLEVEL)
+	return 0;
+    if (lightlevel > MAXLIGHTLEVEL)
+	return NUMLEVELLIGHTS-1;
+    return lightlevel - MINLIGHTLEVEL;
+}
+
+// The scalelight and zlight rows for a sector light level.
+#define R_LevelScaleLight(lightlevel) \
+    (levelscalelight[R_LightLevelIndex (lightlevel)])
+#define R_LevelZLight(lightlevel) \
+    (levelzlight[R_LightLevelIndex (lightlevel)])
 
 
 // Number of diminishing brightness levels.
@@ -82,19 +114,19 @@ extern lighttable_t*	fixedcolormap;
 // Blocky/low detail mode.
 //B remove this?
 //  0 = high, 1 = low
-extern	int		detailshift;	
+extern DG_STATE	int		detailshift;	
 
 
 //
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
 //
-extern void		(*colfunc) (void);
-extern void		(*transcolfunc) (void);
-extern void		(*basecolfunc) (void);
-extern void		(*fuzzcolfunc) (void);
+extern DG_STATE void		(*colfunc) (void);
+extern DG_STATE void		(*transcolfunc) (void);
+extern DG_STATE void		(*basecolfunc) (void);
+extern DG_STATE void		(*fuzzcolfunc) (void);
 // No shadow effects on floors.
-extern void		(*spanfunc) (void);
+extern DG_STATE void		(*spanfunc) (void);
 
 
 //
@@ -144,6 +176,15 @@ R_AddPointToBox
 
 
 
+void*
+R_GrowArray
+( void*		array,
+  int*		max,
+  size_t	size,
+  int		initial );
+
+
+
 //
 // REFRESH - the actual rendering functions.
 //
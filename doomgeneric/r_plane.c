@@ -23,6 +23,7 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "m_prof.h"
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -34,24 +35,36 @@
 
 
 
-planefunction_t		floorfunc;
-planefunction_t		ceilingfunc;
+DG_STATE planefunction_t		floorfunc;
+DG_STATE planefunction_t		ceilingfunc;
 
 //
 // opening
 //
 
 // Here comes the obnoxious "visplane".
-#define MAXVISPLANES	128
-visplane_t		visplanes[MAXVISPLANES];
-visplane_t*		lastvisplane;
-visplane_t*		floorplane;
-visplane_t*		ceilingplane;
+// Each one is allocated the first time it is needed and then kept,
+//  so that pointers to them stay valid when the array grows.
+DG_STATE visplane_t**		visplanes;
+DG_STATE int			numvisplanes;
+static DG_STATE int		maxvisplanes;
+DG_STATE visplane_t*		floorplane;
+DG_STATE visplane_t*		ceilingplane;
+
+// R_FindPlane looks planes up by height, picnum and lightlevel
+//  in a hash table, which is cleared every frame.
+#define VISPLANEHASHSIZE	512
+#define VISPLANEHASH(height,picnum,lightlevel)			\
+    (((unsigned) ((height)>>FRACBITS) * 7			\
+      + (unsigned) (picnum) * 3 + (unsigned) (lightlevel))	\
+     & (VISPLANEHASHSIZE-1))
+
+static DG_STATE visplane_t*	visplanehash[VISPLANEHASHSIZE];
 
 // ?
-#define MAXOPENINGS	SCREENWIDTH*64
-short			openings[MAXOPENINGS];
-short*			lastopening;
+DG_STATE short*			openings;
+DG_STATE short*			lastopening;
+static DG_STATE int		maxopenings;
 
 
 //
@@ -59,31 +72,32 @@ short*			lastopening;
 //  floorclip starts out SCREENHEIGHT
 //  ceilingclip starts out -1
 //
-short			floorclip[SCREENWIDTH];
-short			ceilingclip[SCREENWIDTH];
+DG_STATE short			floorclip[MAXWIDTH];
+DG_STATE short			ceilingclip[MAXWIDTH];
 
 //
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-int			spanstart[SCREENHEIGHT];
-int			spanstop[SCREENHEIGHT];
+DG_STATE int			spanstart[MAXHEIGHT];
+DG_STATE int			spanstop[MAXHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t**		planezlight;
-fixed_t			planeheight;
+DG_STATE lighttable_t**		planezlight;
+DG_STATE fixed_t			planeheight;
 
-fixed_t			yslope[SCREENHEIGHT];
-fixed_t			distscale[SCREENWIDTH];
-fixed_t			basexscale;
-fixed_t			baseyscale;
+DG_STATE fixed_t			yslope[MAXHEIGHT];
+DG_STATE fixed_t			distscale[MAXWIDTH];
+DG_STATE fixed_t			basexscale;
+DG_STATE fixed_t			baseyscale;
 
-fixed_t			cachedheight[SCREENHEIGHT];
-fixed_t			cacheddistance[SCREENHEIGHT];
-fixed_t			cachedxstep[SCREENHEIGHT];
-fixed_t			cachedystep[SCREENHEIGHT];
+DG_STATE fixed_t			cachedheight[MAXHEIGHT];
+DG_STATE fixed_t			cacheddistance[MAXHEIGHT];
+DG_STATE fixed_t			cachedxstep[MAXHEIGHT];
+DG_STATE fixed_t			cachedystep[MAXHEIGHT];
+DG_STATE int			cachedzlight[MAXHEIGHT];
 
 
 
@@ -137,6 +151,13 @@ R_MapPlane
 	distance = cacheddistance[y] = FixedMul (planeheight, yslope[y]);
 	ds_xstep = cachedxstep[y] = FixedMul (distance,basexscale);
 	ds_ystep = cachedystep[y] = FixedMul (distance,baseyscale);
+
+	index = distance >> LIGHTZSHIFT;
+
+	if (index >= MAXLIGHTZ )
+	    index = MAXLIGHTZ-1;
+
+	cachedzlight[y] = index;
     }
     else
     {
@@ -153,19 +174,14 @@ R_MapPlane
     if (fixedcolormap)
 	ds_colormap = fixedcolormap;
     else
-    {
-	index = distance >> LIGHTZSHIFT;
-	
-	if (index >= MAXLIGHTZ )
-	    index = MAXLIGHTZ-1;
-
-	ds_colormap = planezlight[index];
-    }
+	ds_colormap = planezlight[cachedzlight[y]];
 	
     ds_y = y;
     ds_x1 = x1;
     ds_x2 = x2;
 
+    PROF_COUNT (prof_spans, 1);
+
     // high or low detail
     spanfunc ();	
 }
@@ -187,7 +203,11 @@ void R_ClearPlanes (void)
 	ceilingclip[i] = -1;
     }
 
-    lastvisplane = visplanes;
+    if (openings == NULL)
+	R_CheckOpenings (MAXOPENINGS);
+
+    numvisplanes = 0;
+    memset (visplanehash, 0, sizeof(visplanehash));
     lastopening = openings;
     
     // texture calculation
@@ -204,6 +224,81 @@ void R_ClearPlanes (void)
 
 
 
+//
+// R_CheckOpenings
+// Makes room for count more openings.  If they have to move,
+//  the clip lists already stored in drawsegs are moved along.
+//
+void R_CheckOpenings (int count)
+{
+    short*	newopenings;
+    drawseg_t*	ds;
+    int		used;
+    int		newmax;
+
+    used = lastopening - openings;
+
+    if (used + count <= maxopenings)
+	return;
+
+    newmax = maxopenings;
+
+    while (used + count > newmax)
+	newmax = newmax ? newmax * 2 : MAXOPENINGS;
+
+    newopenings = malloc (newmax * sizeof(*openings));
+
+    if (newopenings == NULL)
+	I_Error ("R_CheckOpenings: failed to grow to %i openings", newmax);
+
+    memcpy (newopenings, openings, used * sizeof(*openings));
+
+    // The lists are adjusted so that [x1] is their first value.
+#define MOVEOPENINGS(list)						\
+    if (ds->list != NULL						\
+     && ds->list + ds->x1 >= openings					\
+     && ds->list + ds->x1 < lastopening)				\
+	ds->list = newopenings + (ds->list - openings)
+
+    for (ds = drawsegs ; ds < ds_p ; ds++)
+    {
+	MOVEOPENINGS (sprtopclip);
+	MOVEOPENINGS (sprbottomclip);
+	MOVEOPENINGS (maskedtexturecol);
+    }
+
+#undef MOVEOPENINGS
+
+    free (openings);
+
+    openings = newopenings;
+    lastopening = openings + used;
+    maxopenings = newmax;
+}
+
+
+//
+// R_NewPlane
+// Returns the next unused visplane.
+//
+static visplane_t* R_NewPlane (void)
+{
+    if (numvisplanes == maxvisplanes)
+	visplanes = R_GrowArray (visplanes, &maxvisplanes,
+				 sizeof(*visplanes), MAXVISPLANES);
+
+    if (visplanes[numvisplanes] == NULL)
+    {
+	visplanes[numvisplanes] = malloc (sizeof(visplane_t));
+
+	if (visplanes[numvisplanes] == NULL)
+	    I_Error ("R_NewPlane: out of memory");
+    }
+
+    return visplanes[numvisplanes++];
+}
+
+
 //
 // R_FindPlane
 //
@@ -214,31 +309,33 @@ R_FindPlane
   int		lightlevel )
 {
     visplane_t*	check;
+    unsigned	hash;
 	
     if (picnum == skyflatnum)
     {
 	height = 0;			// all skys map together
 	lightlevel = 0;
     }
+
+    hash = VISPLANEHASH (height, picnum, lightlevel);
 	
-    for (check=visplanes; check<lastvisplane; check++)
+    for (check=visplanehash[hash] ; check ; check=check->next)
     {
 	if (height == check->height
 	    && picnum == check->picnum
 	    && lightlevel == check->lightlevel)
 	{
-	    break;
+	    return check;
 	}
     }
     
-			
-    if (check < lastvisplane)
-	return check;
-		
-    if (lastvisplane - visplanes == MAXVISPLANES)
-	I_Error ("R_FindPlane: no more visplanes");
-		
-    lastvisplane++;
+    // Only planes made here go in the table.  The first plane
+    //  with a key is always made here, and it is the one that
+    //  is returned from then on: planes split off it by
+    //  R_CheckPlane are never looked up.
+    check = R_NewPlane ();
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check;
 
     check->height = height;
     check->picnum = picnum;
@@ -246,7 +343,7 @@ R_FindPlane
     check->minx = SCREENWIDTH;
     check->maxx = -1;
     
-    memset (check->top,0xff,sizeof(check->top));
+    memset (check->top,0xff,SCREENWIDTH*sizeof(*check->top));
 		
     return check;
 }
@@ -266,6 +363,7 @@ R_CheckPlane
     int		unionl;
     int		unionh;
     int		x;
+    visplane_t*	check;
 	
     if (start < pl->minx)
     {
@@ -290,7 +388,7 @@ R_CheckPlane
     }
 
     for (x=intrl ; x<= intrh ; x++)
-	if (pl->top[x] != 0xff)
+	if (pl->top[x] != 0xffff)
 	    break;
 
     if (x > intrh)
@@ -303,15 +401,16 @@ R_CheckPlane
     }
 	
     // make a new visplane
-    lastvisplane->height = pl->height;
-    lastvisplane->picnum = pl->picnum;
-    lastvisplane->lightlevel = pl->lightlevel;
+    check = R_NewPlane ();
+    check->height = pl->height;
+    check->picnum = pl->picnum;
+    check->lightlevel = pl->lightlevel;
     
-    pl = lastvisplane++;
+    pl = check;
     pl->minx = start;
     pl->maxx = stop;
 
-    memset (pl->top,0xff,sizeof(pl->top));
+    memset (pl->top,0xff,SCREENWIDTH*sizeof(*pl->top));
 		
     return pl;
 }
@@ -360,31 +459,20 @@ R_MakeSpans
 void R_DrawPlanes (void)
 {
     visplane_t*		pl;
-    int			light;
+    int			i;
     int			x;
     int			stop;
     int			angle;
     int                 lumpnum;
 				
-#ifdef RANGECHECK
-    if (ds_p - drawsegs > MAXDRAWSEGS)
-	I_Error ("R_DrawPlanes: drawsegs overflow (%i)",
-		 ds_p - drawsegs);
-    
-    if (lastvisplane - visplanes > MAXVISPLANES)
-	I_Error ("R_DrawPlanes: visplane overflow (%i)",
-		 lastvisplane - visplanes);
-    
-    if (lastopening - openings > MAXOPENINGS)
-	I_Error ("R_DrawPlanes: opening overflow (%i)",
-		 lastopening - openings);
-#endif
-
-    for (pl = visplanes ; pl < lastvisplane ; pl++)
+    for (i = 0 ; i < numvisplanes ; i++)
     {
+	pl = visplanes[i];
+
 	if (pl->minx > pl->maxx)
 	    continue;
 
+	PROF_COUNT (prof_visplanes, 1);
 	
 	// sky flat
 	if (pl->picnum == skyflatnum)
@@ -418,18 +506,10 @@ void R_DrawPlanes (void)
 	ds_source = W_CacheLumpNum(lumpnum, PU_STATIC);
 	
 	planeheight = abs(pl->height-viewz);
-	light = (pl->lightlevel >> LIGHTSEGSHIFT)+extralight;
-
-	if (light >= LIGHTLEVELS)
-	    light = LIGHTLEVELS-1;
-
-	if (light < 0)
-	    light = 0;
-
-	planezlight = zlight[light];
+	planezlight = R_LevelZLight (pl->lightlevel);
 
-	pl->top[pl->maxx+1] = 0xff;
-	pl->top[pl->minx-1] = 0xff;
+	pl->top[pl->maxx+1] = 0xffff;
+	pl->top[pl->minx-1] = 0xffff;
 		
 	stop = pl->maxx + 1;
 
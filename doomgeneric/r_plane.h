@@ -26,19 +26,23 @@
 
 
 // Visplane related.
-extern  short*		lastopening;
+extern DG_STATE  visplane_t**	visplanes;
+extern DG_STATE  int		numvisplanes;
+
+extern DG_STATE  short*		openings;
+extern DG_STATE  short*		lastopening;
 
 
 typedef void (*planefunction_t) (int top, int bottom);
 
-extern planefunction_t	floorfunc;
+extern DG_STATE planefunction_t	floorfunc;
 extern planefunction_t	ceilingfunc_t;
 
-extern short		floorclip[SCREENWIDTH];
-extern short		ceilingclip[SCREENWIDTH];
+extern DG_STATE short		floorclip[MAXWIDTH];
+extern DG_STATE short		ceilingclip[MAXWIDTH];
 
-extern fixed_t		yslope[SCREENHEIGHT];
-extern fixed_t		distscale[SCREENWIDTH];
+extern DG_STATE fixed_t		yslope[MAXHEIGHT];
+extern DG_STATE fixed_t		distscale[MAXWIDTH];
 
 void R_InitPlanes (void);
 void R_ClearPlanes (void);
@@ -59,6 +63,8 @@ R_MakeSpans
 
 void R_DrawPlanes (void);
 
+void R_CheckOpenings (int count);
+
 visplane_t*
 R_FindPlane
 ( fixed_t	height,
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "m_prof.h"
 
 #include "doomdef.h"
 #include "doomstat.h"
@@ -36,56 +37,56 @@
 // OPTIMIZE: closed two sided lines as single sided
 
 // True if any of the segs textures might be visible.
-boolean		segtextured;	
+DG_STATE boolean		segtextured;	
 
 // False if the back side is the same plane.
-boolean		markfloor;	
-boolean		markceiling;
+DG_STATE boolean		markfloor;	
+DG_STATE boolean		markceiling;
 
-boolean		maskedtexture;
-int		toptexture;
-int		bottomtexture;
-int		midtexture;
+DG_STATE boolean		maskedtexture;
+DG_STATE int		toptexture;
+DG_STATE int		bottomtexture;
+DG_STATE int		midtexture;
 
 
-angle_t		rw_normalangle;
+DG_STATE angle_t		rw_normalangle;
 // angle to line origin
-int		rw_angle1;	
+DG_STATE int		rw_angle1;	
 
 //
 // regular wall
 //
-int		rw_x;
-int		rw_stopx;
-angle_t		rw_centerangle;
-fixed_t		rw_offset;
-fixed_t		rw_distance;
-fixed_t		rw_scale;
-fixed_t		rw_scalestep;
-fixed_t		rw_midtexturemid;
-fixed_t		rw_toptexturemid;
-fixed_t		rw_bottomtexturemid;
+DG_STATE int		rw_x;
+DG_STATE int		rw_stopx;
+DG_STATE angle_t		rw_centerangle;
+DG_STATE fixed_t		rw_offset;
+DG_STATE fixed_t		rw_distance;
+DG_STATE fixed_t		rw_scale;
+DG_STATE fixed_t		rw_scalestep;
+DG_STATE fixed_t		rw_midtexturemid;
+DG_STATE fixed_t		rw_toptexturemid;
+DG_STATE fixed_t		rw_bottomtexturemid;
 
-int		worldtop;
-int		worldbottom;
-int		worldhigh;
-int		worldlow;
+DG_STATE int		worldtop;
+DG_STATE int		worldbottom;
+DG_STATE int		worldhigh;
+DG_STATE int		worldlow;
 
-fixed_t		pixhigh;
-fixed_t		pixlow;
-fixed_t		pixhighstep;
-fixed_t		pixlowstep;
+DG_STATE fixed_t		pixhigh;
+DG_STATE fixed_t		pixlow;
+DG_STATE fixed_t		pixhighstep;
+DG_STATE fixed_t		pixlowstep;
 
-fixed_t		topfrac;
-fixed_t		topstep;
+DG_STATE fixed_t		topfrac;
+DG_STATE fixed_t		topstep;
 
-fixed_t		bottomfrac;
-fixed_t		bottomstep;
+DG_STATE fixed_t		bottomfrac;
+DG_STATE fixed_t		bottomstep;
 
 
-lighttable_t**	walllights;
+DG_STATE lighttable_t**	walllights;
 
-short*		maskedtexturecol;
+DG_STATE short*		maskedtexturecol;
 
 
 
@@ -100,7 +101,7 @@ R_RenderMaskedSegRange
 {
     unsigned	index;
     column_t*	col;
-    int		lightnum;
+    int		lightlevel;
     int		texnum;
     
     // Calculate light table.
@@ -112,19 +113,14 @@ R_RenderMaskedSegRange
     backsector = curline->backsector;
     texnum = texturetranslation[curline->sidedef->midtexture];
 	
-    lightnum = (frontsector->lightlevel >> LIGHTSEGSHIFT)+extralight;
+    lightlevel = frontsector->lightlevel;
 
     if (curline->v1->y == curline->v2->y)
-	lightnum--;
+	lightlevel -= LIGHTCONTRAST;
     else if (curline->v1->x == curline->v2->x)
-	lightnum++;
+	lightlevel += LIGHTCONTRAST;
 
-    if (lightnum < 0)		
-	walllights = scalelight[0];
-    else if (lightnum >= LIGHTLEVELS)
-	walllights = scalelight[LIGHTLEVELS-1];
-    else
-	walllights = scalelight[lightnum];
+    walllights = R_LevelScaleLight (lightlevel);
 
     maskedtexturecol = ds->maskedtexturecol;
 
@@ -161,8 +157,8 @@ R_RenderMaskedSegRange
 	    {
 		index = spryscale>>LIGHTSCALESHIFT;
 
-		if (index >=  MAXLIGHTSCALE )
-		    index = MAXLIGHTSCALE-1;
+		if (index >=  numlightscales )
+		    index = numlightscales-1;
 
 		dc_colormap = walllights[index];
 	    }
@@ -259,8 +255,8 @@ void R_RenderSegLoop (void)
 	    // calculate lighting
 	    index = rw_scale>>LIGHTSCALESHIFT;
 
-	    if (index >=  MAXLIGHTSCALE )
-		index = MAXLIGHTSCALE-1;
+	    if (index >=  numlightscales )
+		index = numlightscales-1;
 
 	    dc_colormap = walllights[index];
 	    dc_x = rw_x;
@@ -281,7 +277,7 @@ void R_RenderSegLoop (void)
 	    dc_yh = yh;
 	    dc_texturemid = rw_midtexturemid;
 	    dc_source = R_GetColumn(midtexture,texturecolumn);
-	    colfunc ();
+	    R_BatchWallColumn (wt_mid);
 	    ceilingclip[rw_x] = viewheight;
 	    floorclip[rw_x] = -1;
 	}
@@ -303,7 +299,7 @@ void R_RenderSegLoop (void)
 		    dc_yh = mid;
 		    dc_texturemid = rw_toptexturemid;
 		    dc_source = R_GetColumn(toptexture,texturecolumn);
-		    colfunc ();
+		    R_BatchWallColumn (wt_top);
 		    ceilingclip[rw_x] = mid;
 		}
 		else
@@ -333,7 +329,7 @@ void R_RenderSegLoop (void)
 		    dc_texturemid = rw_bottomtexturemid;
 		    dc_source = R_GetColumn(bottomtexture,
 					    texturecolumn);
-		    colfunc ();
+		    R_BatchWallColumn (wt_bottom);
 		    floorclip[rw_x] = mid;
 		}
 		else
@@ -358,6 +354,7 @@ void R_RenderSegLoop (void)
 	topfrac += topstep;
 	bottomfrac += bottomstep;
     }
+    R_FlushWallColumns ();
 }
 
 
@@ -377,16 +374,27 @@ R_StoreWallRange
     fixed_t		sineval;
     angle_t		distangle, offsetangle;
     fixed_t		vtop;
-    int			lightnum;
+    int			lightlevel;
 
-    // don't overflow and crash
-    if (ds_p == &drawsegs[MAXDRAWSEGS])
-	return;		
+    PROF_COUNT (prof_segs, 1);
 		
 #ifdef RANGECHECK
     if (start >=viewwidth || start > stop)
 	I_Error ("Bad R_RenderWallRange: %i to %i", start , stop);
 #endif
+
+    // make room for another drawseg
+    if (ds_p == drawsegs + maxdrawsegs)
+    {
+	int	used = ds_p - drawsegs;
+
+	drawsegs = R_GrowArray (drawsegs, &maxdrawsegs,
+				sizeof(*drawsegs), MAXDRAWSEGS);
+	ds_p = drawsegs + used;
+    }
+
+    // and for its masked texture columns and sprite clip lists
+    R_CheckOpenings (3 * (stop - start + 1));
     
     sidedef = curline->sidedef;
     linedef = curline->linedef;
@@ -638,19 +646,14 @@ R_StoreWallRange
 	// OPTIMIZE: get rid of LIGHTSEGSHIFT globally
 	if (!fixedcolormap)
 	{
-	    lightnum = (frontsector->lightlevel >> LIGHTSEGSHIFT)+extralight;
+	    lightlevel = frontsector->lightlevel;
 
 	    if (curline->v1->y == curline->v2->y)
-		lightnum--;
+		lightlevel -= LIGHTCONTRAST;
 	    else if (curline->v1->x == curline->v2->x)
-		lightnum++;
+		lightlevel += LIGHTCONTRAST;
 
-	    if (lightnum < 0)		
-		walllights = scalelight[0];
-	    else if (lightnum >= LIGHTLEVELS)
-		walllights = scalelight[LIGHTLEVELS-1];
-	    else
-		walllights = scalelight[lightnum];
+	    walllights = R_LevelScaleLight (lightlevel);
 	}
     }
     
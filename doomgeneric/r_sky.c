@@ -34,9 +34,9 @@
 //
 // sky mapping
 //
-int			skyflatnum;
-int			skytexture;
-int			skytexturemid;
+DG_STATE int			skyflatnum;
+DG_STATE int			skytexture;
+DG_STATE int			skytexturemid;
 
 
 
@@ -28,8 +28,8 @@
 // The sky map is 256*128*4 maps.
 #define ANGLETOSKYSHIFT		22
 
-extern  int		skytexture;
-extern int		skytexturemid;
+extern DG_STATE  int		skytexture;
+extern DG_STATE int		skytexturemid;
 
 // Called whenever the view size changes.
 void R_InitSkyMap (void);
@@ -35,93 +35,93 @@
 //
 
 // needed for texture pegging
-extern fixed_t*		textureheight;
+extern DG_STATE fixed_t*		textureheight;
 
 // needed for pre rendering (fracs)
-extern fixed_t*		spritewidth;
+extern DG_STATE fixed_t*		spritewidth;
 
-extern fixed_t*		spriteoffset;
-extern fixed_t*		spritetopoffset;
+extern DG_STATE fixed_t*		spriteoffset;
+extern DG_STATE fixed_t*		spritetopoffset;
 
-extern lighttable_t*	colormaps;
+extern DG_STATE lighttable_t*	colormaps;
 
-extern int		viewwidth;
-extern int		scaledviewwidth;
-extern int		viewheight;
+extern DG_STATE int		viewwidth;
+extern DG_STATE int		scaledviewwidth;
+extern DG_STATE int		viewheight;
 
-extern int		firstflat;
+extern DG_STATE int		firstflat;
 
 // for global animation
-extern int*		flattranslation;	
-extern int*		texturetranslation;	
+extern DG_STATE int*		flattranslation;	
+extern DG_STATE int*		texturetranslation;	
 
 
 // Sprite....
-extern int		firstspritelump;
-extern int		lastspritelump;
-extern int		numspritelumps;
+extern DG_STATE int		firstspritelump;
+extern DG_STATE int		lastspritelump;
+extern DG_STATE int		numspritelumps;
 
 
 
 //
 // Lookup tables for map data.
 //
-extern int		numsprites;
-extern spritedef_t*	sprites;
+extern DG_STATE int		numsprites;
+extern DG_STATE spritedef_t*	sprites;
 
-extern int		numvertexes;
-extern vertex_t*	vertexes;
+extern DG_STATE int		numvertexes;
+extern DG_STATE vertex_t*	vertexes;
 
-extern int		numsegs;
-extern seg_t*		segs;
+extern DG_STATE int		numsegs;
+extern DG_STATE seg_t*		segs;
 
-extern int		numsectors;
-extern sector_t*	sectors;
+extern DG_STATE int		numsectors;
+extern DG_STATE sector_t*	sectors;
 
-extern int		numsubsectors;
-extern subsector_t*	subsectors;
+extern DG_STATE int		numsubsectors;
+extern DG_STATE subsector_t*	subsectors;
 
-extern int		numnodes;
-extern node_t*		nodes;
+extern DG_STATE int		numnodes;
+extern DG_STATE node_t*		nodes;
 
-extern int		numlines;
-extern line_t*		lines;
+extern DG_STATE int		numlines;
+extern DG_STATE line_t*		lines;
 
-extern int		numsides;
-extern side_t*		sides;
+extern DG_STATE int		numsides;
+extern DG_STATE side_t*		sides;
 
 
 //
 // POV data.
 //
-extern fixed_t		viewx;
-extern fixed_t		viewy;
-extern fixed_t		viewz;
+extern DG_STATE fixed_t		viewx;
+extern DG_STATE fixed_t		viewy;
+extern DG_STATE fixed_t		viewz;
 
-extern angle_t		viewangle;
-extern player_t*	viewplayer;
+extern DG_STATE angle_t		viewangle;
+extern DG_STATE player_t*	viewplayer;
 
 
 // ?
-extern angle_t		clipangle;
+extern DG_STATE angle_t		clipangle;
 
-extern int		viewangletox[FINEANGLES/2];
-extern angle_t		xtoviewangle[SCREENWIDTH+1];
+extern DG_STATE int		viewangletox[FINEANGLES/2];
+extern DG_STATE angle_t		xtoviewangle[MAXWIDTH+1];
 //extern fixed_t		finetangent[FINEANGLES/2];
 
-extern fixed_t		rw_distance;
-extern angle_t		rw_normalangle;
+extern DG_STATE fixed_t		rw_distance;
+extern DG_STATE angle_t		rw_normalangle;
 
 
 
 // angle to line origin
-extern int		rw_angle1;
+extern DG_STATE int		rw_angle1;
 
 // Segs count?
-extern int		sscount;
+extern DG_STATE int		sscount;
 
-extern visplane_t*	floorplane;
-extern visplane_t*	ceilingplane;
+extern DG_STATE visplane_t*	floorplane;
+extern DG_STATE visplane_t*	ceilingplane;
 
 
 #endif
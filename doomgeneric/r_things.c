@@ -28,6 +28,7 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "m_prof.h"
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -65,15 +66,15 @@ typedef struct
 //  which increases counter clockwise (protractor).
 // There was a lot of stuff grabbed wrong, so I changed it...
 //
-fixed_t		pspritescale;
-fixed_t		pspriteiscale;
+DG_STATE fixed_t		pspritescale;
+DG_STATE fixed_t		pspriteiscale;
 
-lighttable_t**	spritelights;
+DG_STATE lighttable_t**	spritelights;
 
 // constant arrays
 //  used for psprite clipping and initializing clipping
-short		negonearray[SCREENWIDTH];
-short		screenheightarray[SCREENWIDTH];
+DG_STATE short		negonearray[MAXWIDTH];
+DG_STATE short		screenheightarray[MAXWIDTH];
 
 
 //
@@ -82,12 +83,12 @@ short		screenheightarray[SCREENWIDTH];
 
 // variables used to look up
 //  and range check thing_t sprites patches
-spritedef_t*	sprites;
-int		numsprites;
+DG_STATE spritedef_t*	sprites;
+DG_STATE int		numsprites;
 
-spriteframe_t	sprtemp[29];
-int		maxframe;
-char*		spritename;
+DG_STATE spriteframe_t	sprtemp[29];
+DG_STATE int		maxframe;
+DG_STATE char*		spritename;
 
 
 
@@ -178,6 +179,11 @@ void R_InitSpriteDefs (char** namelist)
     int		start;
     int		end;
     int		patched;
+    nameindex_t	spriteindex;
+    int*	firstlump;
+    int*	lastlump;
+    int*	nextlump;
+    char	prefix[5];
 		
     // count the number of sprite names
     check = namelist;
@@ -193,10 +199,46 @@ void R_InitSpriteDefs (char** namelist)
 	
     start = firstspritelump-1;
     end = lastspritelump+1;
-	
-    // scan all the lump names for each of the names,
+
+    // Sort the lumps out by their first 4 characters in one
+    //  pass, rather than scanning all of them for every name.
+    //  Each sprite gets a list of its lumps, in lump order;
+    //  sprites with the same name share the first one's list.
+    firstlump = Z_Malloc (numsprites * sizeof(*firstlump), PU_STATIC, NULL);
+    lastlump = Z_Malloc (numsprites * sizeof(*lastlump), PU_STATIC, NULL);
+    nextlump = Z_Malloc ((end - start) * sizeof(*nextlump), PU_STATIC, NULL);
+
+    W_InitNameIndex (&spriteindex, numsprites);
+
+    prefix[4] = '\0';
+
+    for (i=numsprites-1 ; i>=0 ; i--)
+    {
+	firstlump[i] = lastlump[i] = -1;
+	strncpy (prefix, DEH_String(namelist[i]), 4);
+	W_AddToNameIndex (&spriteindex, prefix, i);
+    }
+
+    for (l=start+1 ; l<end ; l++)
+    {
+	strncpy (prefix, lumpinfo[l].name, 4);
+	i = W_FindInNameIndex (&spriteindex, prefix);
+
+	if (i == -1)
+	    continue;
+
+	nextlump[l - start] = -1;
+
+	if (lastlump[i] == -1)
+	    firstlump[i] = l;
+	else
+	    nextlump[lastlump[i] - start] = l;
+
+	lastlump[i] = l;
+    }
+
+    // scan the lumps for each of the names,
     //  noting the highest frame letter.
-    // Just compare 4 characters as ints
     for (i=0 ; i<numsprites ; i++)
     {
 	spritename = DEH_String(namelist[i]);
@@ -206,26 +248,27 @@ void R_InitSpriteDefs (char** namelist)
 	
 	// scan the lumps,
 	//  filling in the frames for whatever is found
-	for (l=start+1 ; l<end ; l++)
+	strncpy (prefix, spritename, 4);
+
+	for (l = firstlump[W_FindInNameIndex (&spriteindex, prefix)] ;
+	     l != -1 ;
+	     l = nextlump[l - start])
 	{
-	    if (!strncasecmp(lumpinfo[l].name, spritename, 4))
-	    {
-		frame = lumpinfo[l].name[4] - 'A';
-		rotation = lumpinfo[l].name[5] - '0';
+	    frame = lumpinfo[l].name[4] - 'A';
+	    rotation = lumpinfo[l].name[5] - '0';
 
-		if (modifiedgame)
-		    patched = W_GetNumForName (lumpinfo[l].name);
-		else
-		    patched = l;
+	    if (modifiedgame)
+		patched = W_GetNumForName (lumpinfo[l].name);
+	    else
+		patched = l;
 
-		R_InstallSpriteLump (patched, frame, rotation, false);
+	    R_InstallSpriteLump (patched, frame, rotation, false);
 
-		if (lumpinfo[l].name[6])
-		{
-		    frame = lumpinfo[l].name[6] - 'A';
-		    rotation = lumpinfo[l].name[7] - '0';
-		    R_InstallSpriteLump (l, frame, rotation, true);
-		}
+	    if (lumpinfo[l].name[6])
+	    {
+		frame = lumpinfo[l].name[6] - 'A';
+		rotation = lumpinfo[l].name[7] - '0';
+		R_InstallSpriteLump (l, frame, rotation, true);
 	    }
 	}
 	
@@ -270,6 +313,11 @@ void R_InitSpriteDefs (char** namelist)
 	memcpy (sprites[i].spriteframes, sprtemp, maxframe*sizeof(spriteframe_t));
     }
 
+    W_FreeNameIndex (&spriteindex);
+    Z_Free (nextlump);
+    Z_Free (lastlump);
+    Z_Free (firstlump);
+
 }
 
 
@@ -278,9 +326,10 @@ void R_InitSpriteDefs (char** namelist)
 //
 // GAME FUNCTIONS
 //
-vissprite_t	vissprites[MAXVISSPRITES];
-vissprite_t*	vissprite_p;
-int		newvissprite;
+DG_STATE vissprite_t*	vissprites;
+DG_STATE vissprite_t*	vissprite_p;
+static DG_STATE int	maxvissprites;
+DG_STATE int		newvissprite;
 
 
 
@@ -308,6 +357,10 @@ void R_InitSprites (char** namelist)
 //
 void R_ClearSprites (void)
 {
+    if (vissprites == NULL)
+	vissprites = R_GrowArray (vissprites, &maxvissprites,
+				  sizeof(*vissprites), MAXVISSPRITES);
+
     vissprite_p = vissprites;
 }
 
@@ -315,12 +368,16 @@ void R_ClearSprites (void)
 //
 // R_NewVisSprite
 //
-vissprite_t	overflowsprite;
-
 vissprite_t* R_NewVisSprite (void)
 {
-    if (vissprite_p == &vissprites[MAXVISSPRITES])
-	return &overflowsprite;
+    if (vissprite_p == vissprites + maxvissprites)
+    {
+	int	used = vissprite_p - vissprites;
+
+	vissprites = R_GrowArray (vissprites, &maxvissprites,
+				  sizeof(*vissprites), MAXVISSPRITES);
+	vissprite_p = vissprites + used;
+    }
     
     vissprite_p++;
     return vissprite_p-1;
@@ -334,11 +391,11 @@ vissprite_t* R_NewVisSprite (void)
 // Masked means: partly transparent, i.e. stored
 //  in posts/runs of opaque pixels.
 //
-short*		mfloorclip;
-short*		mceilingclip;
+DG_STATE short*		mfloorclip;
+DG_STATE short*		mceilingclip;
 
-fixed_t		spryscale;
-fixed_t		sprtopscreen;
+DG_STATE fixed_t		spryscale;
+DG_STATE fixed_t		sprtopscreen;
 
 void R_DrawMaskedColumn (column_t* column)
 {
@@ -588,8 +645,8 @@ void R_ProjectSprite (mobj_t* thing)
 	// diminished light
 	index = xscale>>(LIGHTSCALESHIFT-detailshift);
 
-	if (index >= MAXLIGHTSCALE) 
-	    index = MAXLIGHTSCALE-1;
+	if (index >= numlightscales) 
+	    index = numlightscales-1;
 
 	vis->colormap = spritelights[index];
     }	
@@ -605,7 +662,6 @@ void R_ProjectSprite (mobj_t* thing)
 void R_AddSprites (sector_t* sec)
 {
     mobj_t*		thing;
-    int			lightnum;
 
     // BSP is traversed by subsector.
     // A sector might have been split into several
@@ -617,14 +673,7 @@ void R_AddSprites (sector_t* sec)
     // Well, now it will be done.
     sec->validcount = validcount;
 	
-    lightnum = (sec->lightlevel >> LIGHTSEGSHIFT)+extralight;
-
-    if (lightnum < 0)		
-	spritelights = scalelight[0];
-    else if (lightnum >= LIGHTLEVELS)
-	spritelights = scalelight[LIGHTLEVELS-1];
-    else
-	spritelights = scalelight[lightnum];
+    spritelights = R_LevelScaleLight (sec->lightlevel);
 
     // Handle all things in sector.
     for (thing = sec->thinglist ; thing ; thing = thing->snext)
@@ -724,7 +773,7 @@ void R_DrawPSprite (pspdef_t* psp)
     else
     {
 	// local light
-	vis->colormap = spritelights[MAXLIGHTSCALE-1];
+	vis->colormap = spritelights[numlightscales-1];
     }
 	
     R_DrawVisSprite (vis, vis->x1, vis->x2);
@@ -738,20 +787,11 @@ void R_DrawPSprite (pspdef_t* psp)
 void R_DrawPlayerSprites (void)
 {
     int		i;
-    int		lightnum;
     pspdef_t*	psp;
     
     // get light level
-    lightnum =
-	(viewplayer->mo->subsector->sector->lightlevel >> LIGHTSEGSHIFT) 
-	+extralight;
-
-    if (lightnum < 0)		
-	spritelights = scalelight[0];
-    else if (lightnum >= LIGHTLEVELS)
-	spritelights = scalelight[LIGHTLEVELS-1];
-    else
-	spritelights = scalelight[lightnum];
+    spritelights =
+	R_LevelScaleLight (viewplayer->mo->subsector->sector->lightlevel);
     
     // clip to screen bounds
     mfloorclip = screenheightarray;
@@ -772,59 +812,86 @@ void R_DrawPlayerSprites (void)
 
 //
 // R_SortVisSprites
+// Sorts the vissprites back to front, by increasing scale, into
+//  vsprsorted.  The merge sort is stable, so sprites at the same
+//  scale are drawn in the order they were found.
 //
-vissprite_t	vsprsortedhead;
+DG_STATE vissprite_t**		vsprsorted;
+
+// Each element holds two pointers: vsprsorted is the first half,
+//  vsprmerge the second.
+static DG_STATE vissprite_t**	vsprmerge;
+static DG_STATE int		maxvsprsorted;
 
 
 void R_SortVisSprites (void)
 {
     int			i;
+    int			j;
+    int			k;
     int			count;
-    vissprite_t*	ds;
-    vissprite_t*	best;
-    vissprite_t		unsorted;
-    fixed_t		bestscale;
+    int			width;
+    int			lo;
+    int			mid;
+    int			hi;
+    vissprite_t**	src;
+    vissprite_t**	dest;
+    vissprite_t**	swap;
 
     count = vissprite_p - vissprites;
-	
-    unsorted.next = unsorted.prev = &unsorted;
 
     if (!count)
 	return;
-		
-    for (ds=vissprites ; ds<vissprite_p ; ds++)
+
+    if (count > maxvsprsorted)
     {
-	ds->next = ds+1;
-	ds->prev = ds-1;
+	while (count > maxvsprsorted)
+	    vsprsorted = R_GrowArray (vsprsorted, &maxvsprsorted,
+				      2 * sizeof(*vsprsorted), MAXVISSPRITES);
+
+	vsprmerge = vsprsorted + maxvsprsorted;
     }
-    
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p-1)->next = &unsorted;
-    unsorted.prev = vissprite_p-1;
-    
-    // pull the vissprites out by scale
 
-    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
     for (i=0 ; i<count ; i++)
+	vsprsorted[i] = &vissprites[i];
+
+    // merge runs of width, doubling until there is only one
+    src = vsprsorted;
+    dest = vsprmerge;
+
+    for (width=1 ; width<count ; width*=2)
     {
-	bestscale = INT_MAX;
-        best = unsorted.next;
-	for (ds=unsorted.next ; ds!= &unsorted ; ds=ds->next)
+	for (lo=0 ; lo<count ; lo+=2*width)
 	{
-	    if (ds->scale < bestscale)
+	    mid = lo+width < count ? lo+width : count;
+	    hi = lo+2*width < count ? lo+2*width : count;
+
+	    i = lo;
+	    j = mid;
+	    k = lo;
+
+	    // take from the left run unless the right one is farther
+	    while (i < mid && j < hi)
 	    {
-		bestscale = ds->scale;
-		best = ds;
+		if (src[j]->scale < src[i]->scale)
+		    dest[k++] = src[j++];
+		else
+		    dest[k++] = src[i++];
 	    }
+
+	    while (i < mid)
+		dest[k++] = src[i++];
+	    while (j < hi)
+		dest[k++] = src[j++];
 	}
-	best->next->prev = best->prev;
-	best->prev->next = best->next;
-	best->next = &vsprsortedhead;
-	best->prev = vsprsortedhead.prev;
-	vsprsortedhead.prev->next = best;
-	vsprsortedhead.prev = best;
+
+	swap = src;
+	src = dest;
+	dest = swap;
     }
+
+    if (src != vsprsorted)
+	memcpy (vsprsorted, src, count * sizeof(*vsprsorted));
 }
 
 
@@ -832,8 +899,8 @@ void R_SortVisSprites (void)
 //
 // R_DrawSprite
 //
-static short		clipbot[SCREENWIDTH];
-static short		cliptop[SCREENWIDTH];
+static DG_STATE short		clipbot[MAXWIDTH];
+static DG_STATE short		cliptop[MAXWIDTH];
 void R_DrawSprite (vissprite_t* spr)
 {
     drawseg_t*		ds;
@@ -850,6 +917,8 @@ void R_DrawSprite (vissprite_t* spr)
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale
     //  is the clip seg.
+    PROF_COUNT (prof_drawsegs_scanned, ds_p - drawsegs);
+
     for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
     {
 	// determine if the drawseg obscures the sprite
@@ -950,22 +1019,16 @@ void R_DrawSprite (vissprite_t* spr)
 //
 void R_DrawMasked (void)
 {
-    vissprite_t*	spr;
+    int			i;
     drawseg_t*		ds;
 	
     R_SortVisSprites ();
 
-    if (vissprite_p > vissprites)
-    {
-	// draw all vissprites back to front
-	for (spr = vsprsortedhead.next ;
-	     spr != &vsprsortedhead ;
-	     spr=spr->next)
-	{
-	    
-	    R_DrawSprite (spr);
-	}
-    }
+    PROF_COUNT (prof_vissprites, vissprite_p - vissprites);
+
+    // draw all vissprites back to front
+    for (i=0 ; i<vissprite_p-vissprites ; i++)
+	R_DrawSprite (vsprsorted[i]);
     
     // render any remaining masked mid textures
     for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
@@ -22,25 +22,23 @@
 
 
 
-#define MAXVISSPRITES  	128
-
-extern vissprite_t	vissprites[MAXVISSPRITES];
-extern vissprite_t*	vissprite_p;
-extern vissprite_t	vsprsortedhead;
+extern DG_STATE vissprite_t*	vissprites;
+extern DG_STATE vissprite_t*	vissprite_p;
+extern DG_STATE vissprite_t**	vsprsorted;
 
 // Constant arrays used for psprite clipping
 //  and initializing clipping.
-extern short		negonearray[SCREENWIDTH];
-extern short		screenheightarray[SCREENWIDTH];
+extern DG_STATE short		negonearray[MAXWIDTH];
+extern DG_STATE short		screenheightarray[MAXWIDTH];
 
 // vars for R_DrawMaskedColumn
-extern short*		mfloorclip;
-extern short*		mceilingclip;
-extern fixed_t		spryscale;
-extern fixed_t		sprtopscreen;
+extern DG_STATE short*		mfloorclip;
+extern DG_STATE short*		mceilingclip;
+extern DG_STATE fixed_t		spryscale;
+extern DG_STATE fixed_t		sprtopscreen;
 
-extern fixed_t		pspritescale;
-extern fixed_t		pspriteiscale;
+extern DG_STATE fixed_t		pspritescale;
+extern DG_STATE fixed_t		pspriteiscale;
 
 
 void R_DrawMaskedColumn (column_t* column);
@@ -78,32 +78,32 @@ typedef struct
 
 // The set of channels available
 
-static channel_t *channels;
+static DG_STATE channel_t *channels;
 
 // Maximum volume of a sound effect.
 // Internal default is max out of 0-15.
 
-int sfxVolume = 8;
+DG_STATE int sfxVolume = 8;
 
 // Maximum volume of music. 
 
-int musicVolume = 8;
+DG_STATE int musicVolume = 8;
 
 // Internal volume level, ranging from 0-127
 
-static int snd_SfxVolume;
+static DG_STATE int snd_SfxVolume;
 
 // Whether songs are mus_paused
 
-static boolean mus_paused;        
+static DG_STATE boolean mus_paused;        
 
 // Music currently being played
 
-static musicinfo_t *mus_playing = NULL;
+static DG_STATE musicinfo_t *mus_playing = NULL;
 
 // Number of channels to use
 
-int snd_channels = 8;
+DG_STATE int snd_channels = 8;
 
 //
 // Initializes sound stuff, including volume
@@ -115,6 +115,8 @@ void S_Init(int sfxVolume, int musicVolume)
 {  
     int i;
 
+    S_InitSoundInfo();
+
     I_PrecacheSounds(S_sfx, NUMSFX);
 
     S_SetSfxVolume(sfxVolume);
@@ -19,6 +19,7 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 
 #include "doomtype.h"
@@ -27,11 +28,15 @@
 //
 // Information about all the music
 //
+// The sound code keeps lump numbers and cached data in these tables,
+//  so each instance works on its own copy, S_music and S_sfx, made by
+//  S_InitSoundInfo.
+//
 
 #define MUSIC(name) \
     { name, 0, NULL, NULL }
 
-musicinfo_t S_music[] =
+static musicinfo_t initial_music[NUMMUSIC] =
 {
     MUSIC(NULL),
     MUSIC("e1m1"),
@@ -111,9 +116,9 @@ musicinfo_t S_music[] =
 #define SOUND(name, priority) \
   { NULL, name, priority, NULL, -1, -1, 0, 0, -1, NULL }
 #define SOUND_LINK(name, priority, link_id, pitch, volume) \
-  { NULL, name, priority, &S_sfx[link_id], pitch, volume, 0, 0, -1, NULL }
+  { NULL, name, priority, &initial_sfx[link_id], pitch, volume, 0, 0, -1, NULL }
 
-sfxinfo_t S_sfx[] =
+static sfxinfo_t initial_sfx[NUMSFX] =
 {
   // S_sfx[0] needs to be a dummy for odd reasons.
   SOUND("none",   0),
@@ -227,3 +232,23 @@ sfxinfo_t S_sfx[] =
   SOUND("radio",  60),
 };
 
+DG_STATE musicinfo_t S_music[NUMMUSIC];
+DG_STATE sfxinfo_t S_sfx[NUMSFX];
+
+void S_InitSoundInfo(void)
+{
+    int i;
+
+    memcpy(S_music, initial_music, sizeof(S_music));
+    memcpy(S_sfx, initial_sfx, sizeof(S_sfx));
+
+    // Links point into initial_sfx; point them at the copy instead.
+
+    for (i=0; i<NUMSFX; ++i)
+    {
+        if (S_sfx[i].link != NULL)
+        {
+            S_sfx[i].link = &S_sfx[S_sfx[i].link - initial_sfx];
+        }
+    }
+}
@@ -23,10 +23,13 @@
 #include "i_sound.h"
 
 // the complete set of sound effects
-extern sfxinfo_t	S_sfx[];
+extern DG_STATE sfxinfo_t	S_sfx[];
 
 // the complete set of music
-extern musicinfo_t	S_music[];
+extern DG_STATE musicinfo_t	S_music[];
+
+// Fills in S_sfx and S_music for this instance.
+void S_InitSoundInfo(void);
 
 //
 // Identifiers for all music in game.
@@ -37,7 +37,7 @@
 
 
 // in AM_map.c
-extern boolean		automapactive; 
+extern DG_STATE boolean		automapactive; 
 
 
 
@@ -46,7 +46,7 @@ extern boolean		automapactive;
 // Hack display negative frags.
 //  Loads and store the stminus lump.
 //
-patch_t*		sttminus;
+DG_STATE patch_t*		sttminus;
 
 void STlib_init(void)
 {
@@ -115,7 +115,7 @@ STlib_drawNum
     if (n->y - ST_Y < 0)
 	I_Error("drawNum: n->y - ST_Y < 0");
 
-    V_CopyRect(x, n->y - ST_Y, st_backing_screen, w*numdigits, h, x, n->y);
+    V_CopyRect(x, n->y, st_backing_screen, w*numdigits, h, x, n->y);
 
     // if non-number, do not draw it
     if (num == 1994)
@@ -223,7 +223,7 @@ STlib_updateMultIcon
 	    if (y - ST_Y < 0)
 		I_Error("updateMultIcon: y - ST_Y < 0");
 
-	    V_CopyRect(x, y-ST_Y, st_backing_screen, w, h, x, y);
+	    V_CopyRect(x, y, st_backing_screen, w, h, x, y);
 	}
 	V_DrawPatch(mi->x, mi->y, mi->p[*mi->inum]);
 	mi->oldinum = *mi->inum;
@@ -275,7 +275,7 @@ STlib_updateBinIcon
 	if (*bi->val)
 	    V_DrawPatch(bi->x, bi->y, bi->p);
 	else
-	    V_CopyRect(x, y-ST_Y, st_backing_screen, w, h, x, y);
+	    V_CopyRect(x, y, st_backing_screen, w, h, x, y);
 
 	bi->oldval = *bi->val;
     }
@@ -254,28 +254,28 @@
 #define ST_OUTHEIGHT		1
 
 #define ST_MAPTITLEX \
-    (SCREENWIDTH - ST_MAPWIDTH * ST_CHATFONTWIDTH)
+    (ORIGWIDTH - ST_MAPWIDTH * ST_CHATFONTWIDTH)
 
 #define ST_MAPTITLEY		0
 #define ST_MAPHEIGHT		1
 
 // graphics are drawn to a backing screen and blitted to the real screen
-byte                   *st_backing_screen;
+DG_STATE byte                   *st_backing_screen;
 	    
 // main player in game
-static player_t*	plyr; 
+static DG_STATE player_t*	plyr; 
 
 // ST_Start() has just been called
-static boolean		st_firsttime;
+static DG_STATE boolean		st_firsttime;
 
 // lump number for PLAYPAL
-static int		lu_palette;
+static DG_STATE int		lu_palette;
 
 // used for timing
-static unsigned int	st_clock;
+static DG_STATE unsigned int	st_clock;
 
 // used for making messages go away
-static int		st_msgcounter=0;
+static DG_STATE int		st_msgcounter=0;
 
 // used when in chat 
 static st_chatstateenum_t	st_chatstate;
@@ -284,115 +284,115 @@ static st_chatstateenum_t	st_chatstate;
 static st_stateenum_t	st_gamestate;
 
 // whether left-side main status bar is active
-static boolean		st_statusbaron;
+static DG_STATE boolean		st_statusbaron;
 
 // whether status bar chat is active
 static boolean		st_chat;
 
 // value of st_chat before message popped up
-static boolean		st_oldchat;
+static DG_STATE boolean		st_oldchat;
 
 // whether chat window has the cursor on
 static boolean		st_cursoron;
 
 // !deathmatch
-static boolean		st_notdeathmatch; 
+static DG_STATE boolean		st_notdeathmatch; 
 
 // !deathmatch && st_statusbaron
-static boolean		st_armson;
+static DG_STATE boolean		st_armson;
 
 // !deathmatch
-static boolean		st_fragson; 
+static DG_STATE boolean		st_fragson; 
 
 // main bar left
-static patch_t*		sbar;
+static DG_STATE patch_t*		sbar;
 
 // 0-9, tall numbers
-static patch_t*		tallnum[10];
+static DG_STATE patch_t*		tallnum[10];
 
 // tall % sign
-static patch_t*		tallpercent;
+static DG_STATE patch_t*		tallpercent;
 
 // 0-9, short, yellow (,different!) numbers
-static patch_t*		shortnum[10];
+static DG_STATE patch_t*		shortnum[10];
 
 // 3 key-cards, 3 skulls
-static patch_t*		keys[NUMCARDS]; 
+static DG_STATE patch_t*		keys[NUMCARDS]; 
 
 // face status patches
-static patch_t*		faces[ST_NUMFACES];
+static DG_STATE patch_t*		faces[ST_NUMFACES];
 
 // face background
-static patch_t*		faceback;
+static DG_STATE patch_t*		faceback;
 
  // main bar right
-static patch_t*		armsbg;
+static DG_STATE patch_t*		armsbg;
 
 // weapon ownership patches
-static patch_t*		arms[6][2]; 
+static DG_STATE patch_t*		arms[6][2]; 
 
 // ready-weapon widget
-static st_number_t	w_ready;
+static DG_STATE st_number_t	w_ready;
 
  // in deathmatch only, summary of frags stats
-static st_number_t	w_frags;
+static DG_STATE st_number_t	w_frags;
 
 // health widget
-static st_percent_t	w_health;
+static DG_STATE st_percent_t	w_health;
 
 // arms background
-static st_binicon_t	w_armsbg; 
+static DG_STATE st_binicon_t	w_armsbg; 
 
 
 // weapon ownership widgets
-static st_multicon_t	w_arms[6];
+static DG_STATE st_multicon_t	w_arms[6];
 
 // face status widget
-static st_multicon_t	w_faces; 
+static DG_STATE st_multicon_t	w_faces; 
 
 // keycard widgets
-static st_multicon_t	w_keyboxes[3];
+static DG_STATE st_multicon_t	w_keyboxes[3];
 
 // armor widget
-static st_percent_t	w_armor;
+static DG_STATE st_percent_t	w_armor;
 
 // ammo widgets
-static st_number_t	w_ammo[4];
+static DG_STATE st_number_t	w_ammo[4];
 
 // max ammo widgets
-static st_number_t	w_maxammo[4]; 
+static DG_STATE st_number_t	w_maxammo[4]; 
 
 
 
  // number of frags so far in deathmatch
-static int	st_fragscount;
+static DG_STATE int	st_fragscount;
 
 // used to use appopriately pained face
-static int	st_oldhealth = -1;
+static DG_STATE int	st_oldhealth = -1;
 
 // used for evil grin
-static boolean	oldweaponsowned[NUMWEAPONS]; 
+static DG_STATE boolean	oldweaponsowned[NUMWEAPONS]; 
 
  // count until face changes
-static int	st_facecount = 0;
+static DG_STATE int	st_facecount = 0;
 
 // current face index, used by w_faces
-static int	st_faceindex = 0;
+static DG_STATE int	st_faceindex = 0;
 
 // holds key-type for each key box on bar
-static int	keyboxes[3]; 
+static DG_STATE int	keyboxes[3]; 
 
 // a random number per tick
-static int	st_randomnumber;  
+static DG_STATE int	st_randomnumber;  
 
-cheatseq_t cheat_mus = CHEAT("idmus", 2);
-cheatseq_t cheat_god = CHEAT("iddqd", 0);
-cheatseq_t cheat_ammo = CHEAT("idkfa", 0);
-cheatseq_t cheat_ammonokey = CHEAT("idfa", 0);
-cheatseq_t cheat_noclip = CHEAT("idspispopd", 0);
-cheatseq_t cheat_commercial_noclip = CHEAT("idclip", 0);
+DG_STATE cheatseq_t cheat_mus = CHEAT("idmus", 2);
+DG_STATE cheatseq_t cheat_god = CHEAT("iddqd", 0);
+DG_STATE cheatseq_t cheat_ammo = CHEAT("idkfa", 0);
+DG_STATE cheatseq_t cheat_ammonokey = CHEAT("idfa", 0);
+DG_STATE cheatseq_t cheat_noclip = CHEAT("idspispopd", 0);
+DG_STATE cheatseq_t cheat_commercial_noclip = CHEAT("idclip", 0);
 
-cheatseq_t	cheat_powerup[7] =
+DG_STATE cheatseq_t	cheat_powerup[7] =
 {
     CHEAT("idbeholdv", 0),
     CHEAT("idbeholds", 0),
@@ -403,9 +403,9 @@ cheatseq_t	cheat_powerup[7] =
     CHEAT("idbehold", 0),
 };
 
-cheatseq_t cheat_choppers = CHEAT("idchoppers", 0);
-cheatseq_t cheat_clev = CHEAT("idclev", 2);
-cheatseq_t cheat_mypos = CHEAT("idmypos", 0);
+DG_STATE cheatseq_t cheat_choppers = CHEAT("idchoppers", 0);
+DG_STATE cheatseq_t cheat_clev = CHEAT("idclev", 2);
+DG_STATE cheatseq_t cheat_mypos = CHEAT("idmypos", 0);
 
 
 //
@@ -420,14 +420,14 @@ void ST_refreshBackground(void)
     {
         V_UseBuffer(st_backing_screen);
 
-	V_DrawPatch(ST_X, 0, sbar);
+	V_DrawPatch(ST_X, ST_Y, sbar);
 
 	if (netgame)
-	    V_DrawPatch(ST_FX, 0, faceback);
+	    V_DrawPatch(ST_FX, ST_Y, faceback);
 
         V_RestoreBuffer();
 
-	V_CopyRect(ST_X, 0, st_backing_screen, ST_WIDTH, ST_HEIGHT, ST_X, ST_Y);
+	V_CopyRect(ST_X, ST_Y, st_backing_screen, ST_WIDTH, ST_HEIGHT, ST_X, ST_Y);
     }
 
 }
@@ -590,7 +590,7 @@ ST_Responder (event_t* ev)
       // 'mypos' for player position
       else if (cht_CheckCheat(&cheat_mypos, ev->data2))
       {
-        static char buf[ST_MSGWIDTH];
+        static DG_STATE char buf[ST_MSGWIDTH];
         M_snprintf(buf, sizeof(buf), "ang=0x%x;x,y=(0x%x,0x%x)",
                    players[consoleplayer].mo->angle,
                    players[consoleplayer].mo->x,
@@ -665,8 +665,8 @@ ST_Responder (event_t* ev)
 int ST_calcPainOffset(void)
 {
     int		health;
-    static int	lastcalc;
-    static int	oldhealth = -1;
+    static DG_STATE int	lastcalc;
+    static DG_STATE int	oldhealth = -1;
     
     health = plyr->health > 100 ? 100 : plyr->health;
 
@@ -690,8 +690,8 @@ void ST_updateFaceWidget(void)
     int		i;
     angle_t	badguyangle;
     angle_t	diffang;
-    static int	lastattackdown = -1;
-    static int	priority = 0;
+    static DG_STATE int	lastattackdown = -1;
+    static DG_STATE int	priority = 0;
     boolean	doevilgrin;
 
     if (priority < 10)
@@ -859,7 +859,7 @@ void ST_updateFaceWidget(void)
 
 void ST_updateWidgets(void)
 {
-    static int	largeammo = 1994; // means "n/a"
+    static DG_STATE int	largeammo = 1994; // means "n/a"
     int		i;
 
     // must redirect the pointer if the ready weapon has changed.
@@ -931,7 +931,7 @@ void ST_Ticker (void)
 
 }
 
-static int st_palette = 0;
+static DG_STATE int st_palette = 0;
 
 void ST_doPaletteStuff(void)
 {
@@ -1383,7 +1383,7 @@ void ST_createWidgets(void)
 
 }
 
-static boolean	st_stopped = true;
+static DG_STATE boolean	st_stopped = true;
 
 
 void ST_Start (void)
@@ -1411,6 +1411,9 @@ void ST_Stop (void)
 void ST_Init (void)
 {
     ST_loadData();
-    st_backing_screen = (byte *) Z_Malloc(ST_WIDTH * ST_HEIGHT, PU_STATIC, 0);
+    // A whole screen, which the status bar is drawn to at the same
+    // place as on the real one.
+    st_backing_screen = (byte *) Z_Malloc(SCREENWIDTH * SCREENHEIGHT,
+                                          PU_STATIC, 0);
 }
 
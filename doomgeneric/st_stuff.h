@@ -24,12 +24,16 @@
 #include "doomtype.h"
 #include "d_event.h"
 #include "m_cheat.h"
+#include "v_video.h"
 
 // Size of statusbar.
 // Now sensitive for scaling.
 #define ST_HEIGHT	32
-#define ST_WIDTH	SCREENWIDTH
-#define ST_Y		(SCREENHEIGHT - ST_HEIGHT)
+#define ST_WIDTH	ORIGWIDTH
+#define ST_Y		(ORIGHEIGHT - ST_HEIGHT)
+
+// Rows of the screen the status bar takes up.
+#define SBARHEIGHT	(SCREENHEIGHT - V_ScreenY(ST_Y))
 
 
 //
@@ -73,17 +77,17 @@ typedef enum
 
 
 
-extern byte *st_backing_screen;
-extern cheatseq_t cheat_mus;
-extern cheatseq_t cheat_god;
-extern cheatseq_t cheat_ammo;
-extern cheatseq_t cheat_ammonokey;
-extern cheatseq_t cheat_noclip;
-extern cheatseq_t cheat_commercial_noclip;
-extern cheatseq_t cheat_powerup[7];
-extern cheatseq_t cheat_choppers;
-extern cheatseq_t cheat_clev;
-extern cheatseq_t cheat_mypos;
+extern DG_STATE byte *st_backing_screen;
+extern DG_STATE cheatseq_t cheat_mus;
+extern DG_STATE cheatseq_t cheat_god;
+extern DG_STATE cheatseq_t cheat_ammo;
+extern DG_STATE cheatseq_t cheat_ammonokey;
+extern DG_STATE cheatseq_t cheat_noclip;
+extern DG_STATE cheatseq_t cheat_commercial_noclip;
+extern DG_STATE cheatseq_t cheat_powerup[7];
+extern DG_STATE cheatseq_t cheat_choppers;
+extern DG_STATE cheatseq_t cheat_clev;
+extern DG_STATE cheatseq_t cheat_mypos;
 
 
 #endif
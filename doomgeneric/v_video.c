@@ -28,6 +28,7 @@
 #include "doomtype.h"
 
 #include "deh_str.h"
+#include "doomgeneric.h"
 #include "i_swap.h"
 #include "i_video.h"
 #include "m_bbox.h"
@@ -48,20 +49,20 @@
 // Blending table used for fuzzpatch, etc.
 // Only used in Heretic/Hexen
 
-byte *tinttable = NULL;
+DG_STATE byte *tinttable = NULL;
 
 // villsa [STRIFE] Blending table used for Strife
-byte *xlatab = NULL;
+DG_STATE byte *xlatab = NULL;
 
 // The screen buffer that the v_video.c code draws to.
 
-static byte *dest_screen = NULL;
+static DG_STATE byte *dest_screen = NULL;
 
-int dirtybox[4]; 
+DG_STATE int dirtybox[4]; 
 
 // haleyjd 08/28/10: clipping callback function for patches.
 // This is needed for Chocolate Strife, which clips patches to the screen.
-static vpatchclipfunc_t patchclip_callback = NULL;
+static DG_STATE vpatchclipfunc_t patchclip_callback = NULL;
 
 //
 // V_MarkRect 
@@ -88,25 +89,31 @@ void V_CopyRect(int srcx, int srcy, byte *source,
 { 
     byte *src;
     byte *dest; 
+    int sx, sy;
  
 #ifdef RANGECHECK 
     if (srcx < 0
-     || srcx + width > SCREENWIDTH
+     || srcx + width > ORIGWIDTH
      || srcy < 0
-     || srcy + height > SCREENHEIGHT 
+     || srcy + height > ORIGHEIGHT 
      || destx < 0
-     || destx + width > SCREENWIDTH
+     || destx + width > ORIGWIDTH
      || desty < 0
-     || desty + height > SCREENHEIGHT)
+     || desty + height > ORIGHEIGHT)
     {
         I_Error ("Bad V_CopyRect");
     }
 #endif 
 
     V_MarkRect(destx, desty, width, height); 
+
+    sx = V_ScreenX(srcx);
+    sy = V_ScreenY(srcy);
+    width = V_ScreenX(srcx + width) - sx;
+    height = V_ScreenY(srcy + height) - sy;
  
-    src = source + SCREENWIDTH * srcy + srcx; 
-    dest = dest_screen + SCREENWIDTH * desty + destx; 
+    src = source + SCREENWIDTH * sy + sx; 
+    dest = dest_screen + SCREENWIDTH * V_ScreenY(desty) + V_ScreenX(destx); 
 
     for ( ; height>0 ; height--) 
     { 
@@ -131,6 +138,131 @@ void V_SetPatchClipCallback(vpatchclipfunc_t func)
     patchclip_callback = func;
 }
 
+// How the pixels of a patch are put on the screen.
+
+typedef enum
+{
+    PATCH_NORMAL,
+    PATCH_TINTED,       // translucent, through tinttable
+    PATCH_XLA,          // translucent, through xlatab
+    PATCH_SHADOW,       // just darken the screen, through tinttable
+} patchmode_t;
+
+//
+// DrawColumnScaled
+// Draw the posts of a patch column to screen column sx, for a patch
+// with its top at original row y.
+//
+
+static void DrawColumnScaled(int sx, int y, column_t *column,
+                             patchmode_t mode)
+{
+    byte *source;
+    byte *dest;
+    int pitch;
+    int top;
+    int sy, sy2;
+    int frac;
+#ifndef CMAP256
+    boolean truecolumn;
+#endif
+
+    pitch = SCREENWIDTH;
+
+#ifndef CMAP256
+    // Where the screen is drawn in truecolor this frame, the pixels
+    // have to go to DG_ScreenBuffer as well.
+
+    truecolumn = truecolor && mode == PATCH_NORMAL
+              && dest_screen == I_VideoBuffer
+              && sx >= truecolorbox[BOXLEFT]
+              && sx <= truecolorbox[BOXRIGHT];
+#endif
+
+    // step through the posts in a column
+    while (column->topdelta != 0xff)
+    {
+        source = (byte *)column + 3;
+        top = y + column->topdelta;
+        sy = V_ScreenY(top);
+        sy2 = V_ScreenY(top + column->length);
+        dest = dest_screen + sy * pitch + sx;
+
+        // frac is how far screen row sy is into the source pixel, in
+        // units of 1/SCREENHEIGHT of an original row.
+
+        frac = sy * ORIGHEIGHT - top * SCREENHEIGHT;
+
+        for ( ; sy < sy2; sy++)
+        {
+            switch (mode)
+            {
+                case PATCH_NORMAL:
+                    *dest = *source;
+#ifndef CMAP256
+                    if (truecolumn
+                     && sy >= truecolorbox[BOXBOTTOM]
+                     && sy <= truecolorbox[BOXTOP])
+                    {
+                        DG_ScreenBuffer[sy * pitch + sx] = fb_palette[*source];
+                    }
+#endif
+                    break;
+                case PATCH_TINTED:
+                    *dest = tinttable[((*dest) << 8) + *source];
+                    break;
+                case PATCH_XLA:
+                    *dest = xlatab[*dest + ((*source) << 8)];
+                    break;
+                case PATCH_SHADOW:
+                    *dest = tinttable[((*dest) << 8)];
+                    break;
+            }
+
+            dest += pitch;
+            frac += ORIGHEIGHT;
+
+            if (frac >= SCREENHEIGHT)
+            {
+                frac -= SCREENHEIGHT;
+                source++;
+            }
+        }
+
+        column = (column_t *)((byte *)column + column->length + 4);
+    }
+}
+
+//
+// DrawPatchScaled
+// Draw a patch with its top left corner at original x, y.
+//
+
+static void DrawPatchScaled(int x, int y, patch_t *patch,
+                            boolean flipped, patchmode_t mode)
+{
+    column_t *column;
+    int col;
+    int w;
+    int sx, sx2;
+
+    w = SHORT(patch->width);
+    sx2 = V_ScreenX(x + w);
+
+    for (sx = V_ScreenX(x); sx < sx2; sx++)
+    {
+        col = V_OrigX(sx) - x;
+
+        if (flipped)
+        {
+            col = w - 1 - col;
+        }
+
+        column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
+        DrawColumnScaled(sx, y, column, mode);
+    }
+}
+
 //
 // V_DrawPatch
 // Masks a column based masked pic to the screen. 
@@ -138,14 +270,6 @@ void V_SetPatchClipCallback(vpatchclipfunc_t func)
 
 void V_DrawPatch(int x, int y, patch_t *patch)
 { 
-    int count;
-    int col;
-    column_t *column;
-    byte *desttop;
-    byte *dest;
-    byte *source;
-    int w;
-
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
@@ -158,9 +282,9 @@ void V_DrawPatch(int x, int y, patch_t *patch)
 
 #ifdef RANGECHECK
     if (x < 0
-     || x + SHORT(patch->width) > SCREENWIDTH
+     || x + SHORT(patch->width) > ORIGWIDTH
      || y < 0
-     || y + SHORT(patch->height) > SCREENHEIGHT)
+     || y + SHORT(patch->height) > ORIGHEIGHT)
     {
         I_Error("Bad V_DrawPatch x=%i y=%i patch.width=%i patch.height=%i topoffset=%i leftoffset=%i", x, y, patch->width, patch->height, patch->topoffset, patch->leftoffset);
     }
@@ -168,30 +292,7 @@ void V_DrawPatch(int x, int y, patch_t *patch)
 
     V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
 
-    col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
-
-    w = SHORT(patch->width);
-
-    for ( ; col<w ; x++, col++, desttop++)
-    {
-        column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
-
-        // step through the posts in a column
-        while (column->topdelta != 0xff)
-        {
-            source = (byte *)column + 3;
-            dest = desttop + column->topdelta*SCREENWIDTH;
-            count = column->length;
-
-            while (count--)
-            {
-                *dest = *source++;
-                dest += SCREENWIDTH;
-            }
-            column = (column_t *)((byte *)column + column->length + 4);
-        }
-    }
+    DrawPatchScaled(x, y, patch, false, PATCH_NORMAL);
 }
 
 //
@@ -202,14 +303,6 @@ void V_DrawPatch(int x, int y, patch_t *patch)
 
 void V_DrawPatchFlipped(int x, int y, patch_t *patch)
 {
-    int count;
-    int col; 
-    column_t *column; 
-    byte *desttop;
-    byte *dest;
-    byte *source; 
-    int w; 
- 
     y -= SHORT(patch->topoffset); 
     x -= SHORT(patch->leftoffset); 
 
@@ -222,9 +315,9 @@ void V_DrawPatchFlipped(int x, int y, patch_t *patch)
 
 #ifdef RANGECHECK 
     if (x < 0
-     || x + SHORT(patch->width) > SCREENWIDTH
+     || x + SHORT(patch->width) > ORIGWIDTH
      || y < 0
-     || y + SHORT(patch->height) > SCREENHEIGHT)
+     || y + SHORT(patch->height) > ORIGHEIGHT)
     {
         I_Error("Bad V_DrawPatchFlipped");
     }
@@ -232,30 +325,7 @@ void V_DrawPatchFlipped(int x, int y, patch_t *patch)
 
     V_MarkRect (x, y, SHORT(patch->width), SHORT(patch->height));
 
-    col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
-
-    w = SHORT(patch->width);
-
-    for ( ; col<w ; x++, col++, desttop++)
-    {
-        column = (column_t *)((byte *)patch + LONG(patch->columnofs[w-1-col]));
-
-        // step through the posts in a column
-        while (column->topdelta != 0xff )
-        {
-            source = (byte *)column + 3;
-            dest = desttop + column->topdelta*SCREENWIDTH;
-            count = column->length;
-
-            while (count--)
-            {
-                *dest = *source++;
-                dest += SCREENWIDTH;
-            }
-            column = (column_t *)((byte *)column + column->length + 4);
-        }
-    }
+    DrawPatchScaled(x, y, patch, true, PATCH_NORMAL);
 }
 
 
@@ -271,53 +341,56 @@ void V_DrawPatchDirect(int x, int y, patch_t *patch)
 } 
 
 //
-// V_DrawTLPatch
-//
-// Masks a column based translucent masked pic to the screen.
+// V_DrawPatchColumn
+// Draws a single column of a patch, ignoring its offsets.
 //
 
-void V_DrawTLPatch(int x, int y, patch_t * patch)
+void V_DrawPatchColumn(int x, int y, patch_t *patch, int col)
 {
-    int count, col;
     column_t *column;
-    byte *desttop, *dest, *source;
-    int w;
-
-    y -= SHORT(patch->topoffset);
-    x -= SHORT(patch->leftoffset);
+    int sx, sx2;
 
+#ifdef RANGECHECK
     if (x < 0
-     || x + SHORT(patch->width) > SCREENWIDTH 
+     || x >= ORIGWIDTH
      || y < 0
-     || y + SHORT(patch->height) > SCREENHEIGHT)
+     || y + SHORT(patch->height) > ORIGHEIGHT
+     || col < 0
+     || col >= SHORT(patch->width))
     {
-        I_Error("Bad V_DrawTLPatch");
+        I_Error("Bad V_DrawPatchColumn");
     }
+#endif
 
-    col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
+    column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
+    sx2 = V_ScreenX(x + 1);
 
-    w = SHORT(patch->width);
-    for (; col < w; x++, col++, desttop++)
+    for (sx = V_ScreenX(x); sx < sx2; sx++)
     {
-        column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
+        DrawColumnScaled(sx, y, column, PATCH_NORMAL);
+    }
+}
 
-        // step through the posts in a column
+//
+// V_DrawTLPatch
+//
+// Masks a column based translucent masked pic to the screen.
+//
 
-        while (column->topdelta != 0xff)
-        {
-            source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
-            count = column->length;
+void V_DrawTLPatch(int x, int y, patch_t * patch)
+{
+    y -= SHORT(patch->topoffset);
+    x -= SHORT(patch->leftoffset);
 
-            while (count--)
-            {
-                *dest = tinttable[((*dest) << 8) + *source++];
-                dest += SCREENWIDTH;
-            }
-            column = (column_t *) ((byte *) column + column->length + 4);
-        }
+    if (x < 0
+     || x + SHORT(patch->width) > ORIGWIDTH 
+     || y < 0
+     || y + SHORT(patch->height) > ORIGHEIGHT)
+    {
+        I_Error("Bad V_DrawTLPatch");
     }
+
+    DrawPatchScaled(x, y, patch, false, PATCH_TINTED);
 }
 
 //
@@ -328,11 +401,6 @@ void V_DrawTLPatch(int x, int y, patch_t * patch)
 
 void V_DrawXlaPatch(int x, int y, patch_t * patch)
 {
-    int count, col;
-    column_t *column;
-    byte *desttop, *dest, *source;
-    int w;
-
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
@@ -342,31 +410,7 @@ void V_DrawXlaPatch(int x, int y, patch_t * patch)
             return;
     }
 
-    col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
-
-    w = SHORT(patch->width);
-    for(; col < w; x++, col++, desttop++)
-    {
-        column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
-
-        // step through the posts in a column
-
-        while(column->topdelta != 0xff)
-        {
-            source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
-            count = column->length;
-
-            while(count--)
-            {
-                *dest = xlatab[*dest + ((*source) << 8)];
-                source++;
-                dest += SCREENWIDTH;
-            }
-            column = (column_t *) ((byte *) column + column->length + 4);
-        }
-    }
+    DrawPatchScaled(x, y, patch, false, PATCH_XLA);
 }
 
 //
@@ -377,46 +421,18 @@ void V_DrawXlaPatch(int x, int y, patch_t * patch)
 
 void V_DrawAltTLPatch(int x, int y, patch_t * patch)
 {
-    int count, col;
-    column_t *column;
-    byte *desttop, *dest, *source;
-    int w;
-
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
     if (x < 0
-     || x + SHORT(patch->width) > SCREENWIDTH
+     || x + SHORT(patch->width) > ORIGWIDTH
      || y < 0
-     || y + SHORT(patch->height) > SCREENHEIGHT)
+     || y + SHORT(patch->height) > ORIGHEIGHT)
     {
         I_Error("Bad V_DrawAltTLPatch");
     }
 
-    col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
-
-    w = SHORT(patch->width);
-    for (; col < w; x++, col++, desttop++)
-    {
-        column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
-
-        // step through the posts in a column
-
-        while (column->topdelta != 0xff)
-        {
-            source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
-            count = column->length;
-
-            while (count--)
-            {
-                *dest = tinttable[((*dest) << 8) + *source++];
-                dest += SCREENWIDTH;
-            }
-            column = (column_t *) ((byte *) column + column->length + 4);
-        }
-    }
+    DrawPatchScaled(x, y, patch, false, PATCH_TINTED);
 }
 
 //
@@ -427,52 +443,22 @@ void V_DrawAltTLPatch(int x, int y, patch_t * patch)
 
 void V_DrawShadowedPatch(int x, int y, patch_t *patch)
 {
-    int count, col;
-    column_t *column;
-    byte *desttop, *dest, *source;
-    byte *desttop2, *dest2;
-    int w;
-
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
     if (x < 0
-     || x + SHORT(patch->width) > SCREENWIDTH
+     || x + SHORT(patch->width) > ORIGWIDTH
      || y < 0
-     || y + SHORT(patch->height) > SCREENHEIGHT)
+     || y + SHORT(patch->height) > ORIGHEIGHT)
     {
         I_Error("Bad V_DrawShadowedPatch");
     }
 
-    col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
-    desttop2 = dest_screen + (y + 2) * SCREENWIDTH + x + 2;
+    // The shadow is two pixels down and to the right, and the patch
+    // always covers it where they overlap.
 
-    w = SHORT(patch->width);
-    for (; col < w; x++, col++, desttop++, desttop2++)
-    {
-        column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
-
-        // step through the posts in a column
-
-        while (column->topdelta != 0xff)
-        {
-            source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
-            dest2 = desttop2 + column->topdelta * SCREENWIDTH;
-            count = column->length;
-
-            while (count--)
-            {
-                *dest2 = tinttable[((*dest2) << 8)];
-                dest2 += SCREENWIDTH;
-                *dest = *source++;
-                dest += SCREENWIDTH;
-
-            }
-            column = (column_t *) ((byte *) column + column->length + 4);
-        }
-    }
+    DrawPatchScaled(x + 2, y + 2, patch, false, PATCH_SHADOW);
+    DrawPatchScaled(x, y, patch, false, PATCH_NORMAL);
 }
 
 //
@@ -528,49 +514,38 @@ void V_DrawBlock(int x, int y, int width, int height, byte *src)
 
 void V_DrawFilledBox(int x, int y, int w, int h, int c)
 {
-    uint8_t *buf, *buf1;
-    int x1, y1;
+    uint8_t *buf;
+    int sx, sy;
 
-    buf = I_VideoBuffer + SCREENWIDTH * y + x;
+    // Fill the screen pixels that the box covers.
 
-    for (y1 = 0; y1 < h; ++y1)
+    sx = V_ScreenX(x);
+    sy = V_ScreenY(y);
+    w = V_ScreenX(x + w) - sx;
+    h = V_ScreenY(y + h) - sy;
+
+    if (w <= 0)
     {
-        buf1 = buf;
+        return;
+    }
 
-        for (x1 = 0; x1 < w; ++x1)
-        {
-            *buf1++ = c;
-        }
+    buf = I_VideoBuffer + SCREENWIDTH * sy + sx;
 
+    for ( ; h > 0; --h)
+    {
+        memset(buf, c, w);
         buf += SCREENWIDTH;
     }
 }
 
 void V_DrawHorizLine(int x, int y, int w, int c)
 {
-    uint8_t *buf;
-    int x1;
-
-    buf = I_VideoBuffer + SCREENWIDTH * y + x;
-
-    for (x1 = 0; x1 < w; ++x1)
-    {
-        *buf++ = c;
-    }
+    V_DrawFilledBox(x, y, w, 1, c);
 }
 
 void V_DrawVertLine(int x, int y, int h, int c)
 {
-    uint8_t *buf;
-    int y1;
-
-    buf = I_VideoBuffer + SCREENWIDTH * y + x;
-
-    for (y1 = 0; y1 < h; ++y1)
-    {
-        *buf = c;
-        buf += SCREENWIDTH;
-    }
+    V_DrawFilledBox(x, y, 1, h, c);
 }
 
 void V_DrawBox(int x, int y, int w, int h, int c)
@@ -588,7 +563,43 @@ void V_DrawBox(int x, int y, int w, int h, int c)
  
 void V_DrawRawScreen(byte *raw)
 {
-    memcpy(dest_screen, raw, SCREENWIDTH * SCREENHEIGHT);
+    byte *dest;
+    byte *src;
+    int sx, sy;
+
+    dest = dest_screen;
+
+    for (sy = 0; sy < SCREENHEIGHT; sy++)
+    {
+        src = raw + V_OrigY(sy) * ORIGWIDTH;
+
+        for (sx = 0; sx < SCREENWIDTH; sx++)
+        {
+            *dest++ = src[V_OrigX(sx)];
+        }
+    }
+}
+
+//
+// V_FillFlat
+// The flat is scaled up like the rest of the 2D graphics, so a 64x64
+// tile covers the same part of the screen at any size.
+//
+
+void V_FillFlat(byte *flat, byte *dest, int height)
+{
+    byte *src;
+    int sx, sy;
+
+    for (sy = 0; sy < height; sy++)
+    {
+        src = flat + ((V_OrigY(sy) & 63) << 6);
+
+        for (sx = 0; sx < SCREENWIDTH; sx++)
+        {
+            *dest++ = src[V_OrigX(sx) & 63];
+        }
+    }
 }
 
 //
@@ -845,7 +856,7 @@ void V_ScreenShot(char *format)
 
 void V_DrawMouseSpeedBox(int speed)
 {
-    extern int usemouse;
+    extern DG_STATE int usemouse;
     int bgcolor, bordercolor, red, black, white, yellow;
     int box_x, box_y;
     int original_speed;
@@ -872,7 +883,7 @@ void V_DrawMouseSpeedBox(int speed)
 
     // Calculate box position
 
-    box_x = SCREENWIDTH - MOUSE_SPEED_BOX_WIDTH - 10;
+    box_x = ORIGWIDTH - MOUSE_SPEED_BOX_WIDTH - 10;
     box_y = 15;
 
     V_DrawFilledBox(box_x, box_y,
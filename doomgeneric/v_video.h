@@ -23,6 +23,7 @@
 #define __V_VIDEO__
 
 #include "doomtype.h"
+#include "i_video.h"
 
 // Needed because we are refering to patches.
 #include "v_patch.h"
@@ -31,12 +32,22 @@
 // VIDEO
 //
 
-#define CENTERY			(SCREENHEIGHT/2)
+#define CENTERY			(ORIGHEIGHT/2)
 
+// The patch drawing functions take coordinates on the original
+// 320x200 screen.  V_ScreenX/V_ScreenY give the first screen column
+// or row that an original one covers, V_OrigX/V_OrigY the original
+// column or row that a screen one shows.
 
-extern int dirtybox[4];
+#define V_ScreenX(x)		(((x) * SCREENWIDTH + ORIGWIDTH - 1) / ORIGWIDTH)
+#define V_ScreenY(y)		(((y) * SCREENHEIGHT + ORIGHEIGHT - 1) / ORIGHEIGHT)
+#define V_OrigX(x)		((x) * ORIGWIDTH / SCREENWIDTH)
+#define V_OrigY(y)		((y) * ORIGHEIGHT / SCREENHEIGHT)
 
-extern byte *tinttable;
+
+extern DG_STATE int dirtybox[4];
+
+extern DG_STATE byte *tinttable;
 
 // haleyjd 08/28/10: implemented for Strife support
 // haleyjd 08/28/10: Patch clipping callback, implemented to support Choco
@@ -62,7 +73,12 @@ void V_DrawShadowedPatch(int x, int y, patch_t *patch);
 void V_DrawXlaPatch(int x, int y, patch_t * patch);     // villsa [STRIFE]
 void V_DrawPatchDirect(int x, int y, patch_t *patch);
 
+// Draw column col of a patch at column x, with the patch's top at y.
+
+void V_DrawPatchColumn(int x, int y, patch_t *patch, int col);
+
 // Draw a linear block of pixels into the view buffer.
+// Unlike the functions above, this takes screen coordinates.
 
 void V_DrawBlock(int x, int y, int width, int height, byte *src);
 
@@ -77,6 +93,10 @@ void V_DrawBox(int x, int y, int w, int h, int c);
 
 void V_DrawRawScreen(byte *raw);
 
+// Tile the first height rows of a screen buffer with a flat.
+
+void V_FillFlat(byte *flat, byte *dest, int height);
+
 // Temporarily switch to using a different buffer to draw graphics, etc.
 
 void V_UseBuffer(byte *buffer);
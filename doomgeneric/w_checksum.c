@@ -25,8 +25,8 @@
 #include "w_checksum.h"
 #include "w_wad.h"
 
-static wad_file_t **open_wadfiles = NULL;
-static int num_open_wadfiles = 0;
+static DG_STATE wad_file_t **open_wadfiles = NULL;
+static DG_STATE int num_open_wadfiles = 0;
 
 static int GetFileNumber(wad_file_t *handle)
 {
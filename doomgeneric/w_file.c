@@ -56,11 +56,12 @@ wad_file_t *W_OpenFile(char *path)
     int i;
 
     //!
-    // Use the OS's virtual memory subsystem to map WAD files
-    // directly into memory.
+    // Read WAD files with stdio instead of mapping them into memory.
+    // WADs are mapped by default where the OS supports it; this
+    // makes every lump be read into zone memory as it is used.
     //
 
-    if (!M_CheckParm("-mmap"))
+    if (M_CheckParm("-nommap"))
     {
         return stdc_wad_file.OpenFile(path);
     }
@@ -0,0 +1,196 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	WAD I/O functions, using POSIX mmap.
+//
+//	The whole file is mapped copy-on-write, so W_CacheLumpNum can
+//	hand out pointers straight into the mapping instead of reading
+//	every lump into the zone.  Untouched pages stay in the page
+//	cache and are shared with every other process (or instance)
+//	that has the same WAD open.
+//
+
+#include "config.h"
+
+#ifdef HAVE_MMAP
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "w_file.h"
+#include "z_zone.h"
+
+typedef struct
+{
+    wad_file_t wad;
+    int handle;
+} posix_wad_file_t;
+
+extern wad_file_class_t posix_wad_file;
+
+static void MapFile(posix_wad_file_t *wad, char *filename)
+{
+    void *result;
+
+    // PROT_WRITE with MAP_PRIVATE: nothing is meant to write into lump
+    // data, but if something does, it only dirties a private copy of
+    // that page rather than crashing or changing the file.
+
+    result = mmap(NULL, wad->wad.length,
+                  PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                  wad->handle, 0);
+
+    if (result == MAP_FAILED)
+    {
+        fprintf(stderr, "W_POSIX_OpenFile: Unable to mmap() %s - %s\n",
+                        filename, strerror(errno));
+        wad->wad.mapped = NULL;
+        return;
+    }
+
+    wad->wad.mapped = result;
+
+#ifdef MADV_RANDOM
+    // Lumps are looked up in no particular order, and a megawad may
+    // only ever have a small part of it used.  Don't read ahead past
+    // the pages that are actually touched.
+
+    madvise(result, wad->wad.length, MADV_RANDOM);
+#endif
+}
+
+static unsigned int GetFileLength(int handle)
+{
+    struct stat st;
+
+    if (fstat(handle, &st) < 0)
+    {
+        return 0;
+    }
+
+    return st.st_size;
+}
+
+static wad_file_t *W_POSIX_OpenFile(char *path)
+{
+    posix_wad_file_t *result;
+    int handle;
+
+    handle = open(path, O_RDONLY);
+
+    if (handle < 0)
+    {
+        return NULL;
+    }
+
+    // Create a new posix_wad_file_t to hold the file handle.
+
+    result = Z_Malloc(sizeof(posix_wad_file_t), PU_STATIC, 0);
+    result->wad.file_class = &posix_wad_file;
+    result->wad.length = GetFileLength(handle);
+    result->handle = handle;
+
+    // Try to map the file into memory.  If this fails, lumps are
+    // read from the file handle instead.
+
+    if (result->wad.length > 0)
+    {
+        MapFile(result, path);
+    }
+    else
+    {
+        result->wad.mapped = NULL;
+    }
+
+    return &result->wad;
+}
+
+static void W_POSIX_CloseFile(wad_file_t *wad)
+{
+    posix_wad_file_t *posix_wad;
+
+    posix_wad = (posix_wad_file_t *) wad;
+
+    // If mapped, unmap it.
+
+    if (posix_wad->wad.mapped != NULL)
+    {
+        munmap(posix_wad->wad.mapped, posix_wad->wad.length);
+    }
+
+    close(posix_wad->handle);
+    Z_Free(posix_wad);
+}
+
+// Read data from the specified position in the file into the
+// provided buffer.  Returns the number of bytes read.
+
+size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
+                    void *buffer, size_t buffer_len)
+{
+    posix_wad_file_t *posix_wad;
+    byte *byte_buffer;
+    size_t bytes_read;
+    ssize_t result;
+
+    posix_wad = (posix_wad_file_t *) wad;
+
+    // pread rather than lseek + read, so that there is no shared file
+    // position to get wrong.
+
+    byte_buffer = buffer;
+    bytes_read = 0;
+
+    while (buffer_len > 0)
+    {
+        result = pread(posix_wad->handle, byte_buffer, buffer_len,
+                       offset);
+
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (result <= 0)
+        {
+            break;
+        }
+
+        buffer_len -= result;
+        byte_buffer += result;
+        bytes_read += result;
+        offset += result;
+    }
+
+    return bytes_read;
+}
+
+
+wad_file_class_t posix_wad_file =
+{
+    W_POSIX_OpenFile,
+    W_POSIX_CloseFile,
+    W_POSIX_Read,
+};
+
+
+#endif /* #ifdef HAVE_MMAP */
+
@@ -58,31 +58,123 @@ typedef struct
 
 // Location of each lump on disk.
 
-lumpinfo_t *lumpinfo;		
-unsigned int numlumps = 0;
+DG_STATE lumpinfo_t *lumpinfo;		
+DG_STATE unsigned int numlumps = 0;
 
-// Hash table for fast lookups
+// Index for fast lookups
 
-static lumpinfo_t **lumphash;
+static DG_STATE nameindex_t lumpindex;
 
-// Hash function used for lump names.
+// Pack a lump name into a 64-bit key: up to 8 characters, upper
+// case, padded with zeroes.  Two names compare equal with
+// strncasecmp(a, b, 8) exactly when their keys are equal.
 
-unsigned int W_LumpNameHash(const char *s)
+uint64_t W_LumpNameKey(const char *name)
 {
-    // This is the djb2 string hash function, modded to work on strings
-    // that have a maximum length of 8.
-
-    unsigned int result = 5381;
+    uint64_t result = 0;
     unsigned int i;
 
-    for (i=0; i < 8 && s[i] != '\0'; ++i)
+    for (i=0; i < 8 && name[i] != '\0'; ++i)
     {
-        result = ((result << 5) ^ result ) ^ toupper((int)s[i]);
+        result |= (uint64_t) (byte) toupper((int) name[i]) << (i * 8);
     }
 
     return result;
 }
 
+// Slot to start probing from for a key.
+
+static unsigned int NameSlot(nameindex_t *index, uint64_t key)
+{
+    return (unsigned int) ((key * 0x9e3779b97f4a7c15ULL) >> 32)
+         & index->mask;
+}
+
+// Allocate an empty index for up to count names.  The table is kept
+// at most half full, so most lookups find their name, or an empty
+// slot, at the first probe.
+
+void W_InitNameIndex(nameindex_t *index, int count)
+{
+    unsigned int size;
+    unsigned int i;
+
+    size = 16;
+
+    while (size < (unsigned int) count * 2)
+    {
+        size <<= 1;
+    }
+
+    index->slots = Z_Malloc(size * sizeof(nameslot_t), PU_STATIC, NULL);
+    index->mask = size - 1;
+
+    for (i=0; i<size; ++i)
+    {
+        index->slots[i].key = 0;
+        index->slots[i].value = -1;
+    }
+}
+
+void W_FreeNameIndex(nameindex_t *index)
+{
+    if (index->slots != NULL)
+    {
+        Z_Free(index->slots);
+        index->slots = NULL;
+    }
+}
+
+// Add a name to an index.  If the name is there already, the new
+// value replaces the old one.
+
+void W_AddToNameIndex(nameindex_t *index, const char *name, int value)
+{
+    nameslot_t *slot;
+    uint64_t key;
+    unsigned int i;
+
+    key = W_LumpNameKey(name);
+
+    for (i = NameSlot(index, key); ; i = (i + 1) & index->mask)
+    {
+        slot = &index->slots[i];
+
+        if (slot->value < 0 || slot->key == key)
+        {
+            slot->key = key;
+            slot->value = value;
+            return;
+        }
+    }
+}
+
+// Returns -1 if the name is not in the index.
+
+int W_FindInNameIndex(nameindex_t *index, const char *name)
+{
+    nameslot_t *slot;
+    uint64_t key;
+    unsigned int i;
+
+    key = W_LumpNameKey(name);
+
+    for (i = NameSlot(index, key); ; i = (i + 1) & index->mask)
+    {
+        slot = &index->slots[i];
+
+        if (slot->value < 0)
+        {
+            return -1;
+        }
+
+        if (slot->key == key)
+        {
+            return slot->value;
+        }
+    }
+}
+
 // Increase the size of the lumpinfo[] array to the specified size.
 static void ExtendLumpInfo(int newnumlumps)
 {
@@ -107,14 +199,6 @@ static void ExtendLumpInfo(int newnumlumps)
         {
             Z_ChangeUser(newlumpinfo[i].cache, &newlumpinfo[i].cache);
         }
-
-        // We shouldn't be generating a hash table until after all WADs have
-        // been loaded, but just in case...
-        if (lumpinfo[i].next != NULL)
-        {
-            int nextlumpnum = lumpinfo[i].next - lumpinfo;
-            newlumpinfo[i].next = &newlumpinfo[nextlumpnum];
-        }
     }
 
     // All done.
@@ -227,11 +311,7 @@ wad_file_t *W_AddFile (char *filename)
 
     Z_Free(fileinfo);
 
-    if (lumphash != NULL)
-    {
-        Z_Free(lumphash);
-        lumphash = NULL;
-    }
+    W_FreeNameIndex(&lumpindex);
 
     return wad_file;
 }
@@ -255,26 +335,15 @@ int W_NumLumps (void)
 
 int W_CheckNumForName (char* name)
 {
-    lumpinfo_t *lump_p;
     int i;
 
-    // Do we have a hash table yet?
+    // Do we have an index yet?
 
-    if (lumphash != NULL)
+    if (lumpindex.slots != NULL)
     {
-        int hash;
-        
         // We do! Excellent.
 
-        hash = W_LumpNameHash(name) % numlumps;
-        
-        for (lump_p = lumphash[hash]; lump_p != NULL; lump_p = lump_p->next)
-        {
-            if (!strncasecmp(lump_p->name, name, 8))
-            {
-                return lump_p - lumpinfo;
-            }
-        }
+        return W_FindInNameIndex(&lumpindex, name);
     } 
     else
     {
@@ -398,7 +467,13 @@ void *W_CacheLumpNum(int lumpnum, int tag)
 
     if (lump->wad_file->mapped != NULL)
     {
-        // Memory mapped file, return from the mmapped region.
+        // Memory mapped file, return from the mmapped region.  The
+        // mapping is private and copy-on-write (see w_file_posix.c):
+        // writing to the lump only changes this mapping's copy of the
+        // page, never the file or anyone else's view of it.  Lumps
+        // that need to be byte-swapped or patched, like the blockmap,
+        // are still read into a buffer of their own with W_ReadLump,
+        // so that pages stay shared in the page cache.
 
         result = lump->wad_file->mapped + lump->position;
     }
@@ -467,102 +542,25 @@ void W_ReleaseLumpName(char *name)
     W_ReleaseLumpNum(W_GetNumForName(name));
 }
 
-#if 0
-
-//
-// W_Profile
-//
-int		info[2500][10];
-int		profilecount;
-
-void W_Profile (void)
-{
-    int		i;
-    memblock_t*	block;
-    void*	ptr;
-    char	ch;
-    FILE*	f;
-    int		j;
-    char	name[9];
-	
-	
-    for (i=0 ; i<numlumps ; i++)
-    {	
-	ptr = lumpinfo[i].cache;
-	if (!ptr)
-	{
-	    ch = ' ';
-	    continue;
-	}
-	else
-	{
-	    block = (memblock_t *) ( (byte *)ptr - sizeof(memblock_t));
-	    if (block->tag < PU_PURGELEVEL)
-		ch = 'S';
-	    else
-		ch = 'P';
-	}
-	info[i][profilecount] = ch;
-    }
-    profilecount++;
-#if ORIGCODE
-    f = fopen ("waddump.txt","w");
-    name[8] = 0;
-
-    for (i=0 ; i<numlumps ; i++)
-    {
-	memcpy (name,lumpinfo[i].name,8);
-
-	for (j=0 ; j<8 ; j++)
-	    if (!name[j])
-		break;
-
-	for ( ; j<8 ; j++)
-	    name[j] = ' ';
-
-	fprintf (f,"%s ",name);
-
-	for (j=0 ; j<profilecount ; j++)
-	    fprintf (f,"    %c",info[i][j]);
-
-	fprintf (f,"\n");
-    }
-    fclose (f);
-#endif
-}
-
-
-#endif
-
-// Generate a hash table for fast lookups
+// Generate an index for fast lookups
 
 void W_GenerateHashTable(void)
 {
     unsigned int i;
 
-    // Free the old hash table, if there is one
+    // Free the old index, if there is one
 
-    if (lumphash != NULL)
-    {
-        Z_Free(lumphash);
-    }
+    W_FreeNameIndex(&lumpindex);
 
-    // Generate hash table
+    // Generate the index.  Later lumps replace earlier ones with
+    // the same name, so that patch lump files take precedence.
     if (numlumps > 0)
     {
-        lumphash = Z_Malloc(sizeof(lumpinfo_t *) * numlumps, PU_STATIC, NULL);
-        memset(lumphash, 0, sizeof(lumpinfo_t *) * numlumps);
+        W_InitNameIndex(&lumpindex, numlumps);
 
         for (i=0; i<numlumps; ++i)
         {
-            unsigned int hash;
-
-            hash = W_LumpNameHash(lumpinfo[i].name) % numlumps;
-
-            // Hook into the hash table
-
-            lumpinfo[i].next = lumphash[hash];
-            lumphash[hash] = &lumpinfo[i];
+            W_AddToNameIndex(&lumpindex, lumpinfo[i].name, i);
         }
     }
 
@@ -45,15 +45,27 @@ struct lumpinfo_s
     int		position;
     int		size;
     void       *cache;
+};
 
-    // Used for hash table lookups
+// An index from names of up to 8 characters to numbers: lumps,
+// textures or sprites.  The names are packed into 64-bit keys, so
+// each probe is a single compare.
 
-    lumpinfo_t *next;
-};
+typedef struct
+{
+    uint64_t key;
+    int value;                  // -1 for an empty slot
+} nameslot_t;
+
+typedef struct
+{
+    nameslot_t *slots;
+    unsigned int mask;
+} nameindex_t;
 
 
-extern lumpinfo_t *lumpinfo;
-extern unsigned int numlumps;
+extern DG_STATE lumpinfo_t *lumpinfo;
+extern DG_STATE unsigned int numlumps;
 
 wad_file_t *W_AddFile (char *filename);
 
@@ -68,7 +80,11 @@ void*	W_CacheLumpName (char* name, int tag);
 
 void    W_GenerateHashTable(void);
 
-extern unsigned int W_LumpNameHash(const char *s);
+uint64_t W_LumpNameKey(const char *name);
+void W_InitNameIndex(nameindex_t *index, int count);
+void W_FreeNameIndex(nameindex_t *index);
+void W_AddToNameIndex(nameindex_t *index, const char *name, int value);
+int W_FindInNameIndex(nameindex_t *index, const char *name);
 
 void    W_ReleaseLumpNum(int lump);
 void    W_ReleaseLumpName(char *name);
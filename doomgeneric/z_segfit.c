@@ -0,0 +1,636 @@
+//
+// Copyright(C) 2026 The doomgeneric contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Zone Memory Allocation, segregated-fit version.
+//
+//	A drop-in replacement for z_zone.c: build with this file
+//	instead of z_zone.c to use it.  The zone is still one block
+//	of memory from I_ZoneBase, but free blocks are kept in lists
+//	by size class and purgable blocks in least-recently-used
+//	order, so that Z_Malloc does not have to walk the heap.
+//
+
+
+#include "z_zone.h"
+#include "i_system.h"
+#include "m_prof.h"
+#include "doomtype.h"
+
+
+//
+// ZONE MEMORY ALLOCATION
+//
+// As in z_zone.c, there is never any space between memblocks, and
+//  there will never be two contiguous free memblocks: next/prev
+//  link all blocks in address order.
+//
+// Free blocks are also on the free list for their size class,
+//  where class n holds blocks of 2^n to 2^(n+1)-1 bytes.
+//  Purgable blocks (tags >= PU_PURGELEVEL) are on the purge list
+//  instead, oldest first; a block moves to the end of it whenever
+//  its tag is set to a purgable one, which happens every time a
+//  cached lump is asked for.
+//
+// Z_Malloc takes a block from the smallest size class that is
+//  certain to fit.  If there is none, it purges blocks from the
+//  front of the purge list until one fits.
+//
+
+#define MEM_ALIGN sizeof(void *)
+#define ZONEID	0x1d4a11
+
+#define NUMSIZECLASSES	32
+
+typedef struct memblock_s
+{
+    int			size;	// including the header and possibly tiny fragments
+    void**		user;
+    int			tag;	// PU_FREE if this is free
+    int			id;	// should be ZONEID
+    struct memblock_s*	next;
+    struct memblock_s*	prev;
+
+    // free list or purge list
+    struct memblock_s*	listnext;
+    struct memblock_s*	listprev;
+} memblock_t;
+
+
+typedef struct
+{
+    // total bytes malloced, including header
+    int		size;
+
+    // start / end cap for linked list
+    memblock_t	blocklist;
+
+    // heads of the free lists, and a bit set for each one
+    //  that is not empty
+    memblock_t	freelists[NUMSIZECLASSES];
+    unsigned int freemask;
+
+    // head of the purge list
+    memblock_t	purgelist;
+
+} memzone_t;
+
+
+
+DG_STATE memzone_t*	mainzone;
+
+// Called before a purgable block is thrown out, see Z_SetPurgeHook.
+static DG_STATE void	(*purgehook) (void);
+
+
+
+//
+// List helpers.
+//
+
+static void InitList (memblock_t* head)
+{
+    head->listnext = head->listprev = head;
+}
+
+// Add a block to the end of a list.
+
+static void LinkBlock (memblock_t* head, memblock_t* block)
+{
+    block->listnext = head;
+    block->listprev = head->listprev;
+    head->listprev->listnext = block;
+    head->listprev = block;
+}
+
+static void UnlinkBlock (memblock_t* block)
+{
+    block->listprev->listnext = block->listnext;
+    block->listnext->listprev = block->listprev;
+}
+
+static int SizeClass (unsigned int size)
+{
+    int		sizeclass;
+
+    sizeclass = 0;
+
+    while (size >>= 1)
+	sizeclass++;
+
+    return sizeclass;
+}
+
+static void AddFreeBlock (memblock_t* block)
+{
+    int		sizeclass;
+
+    sizeclass = SizeClass (block->size);
+    LinkBlock (&mainzone->freelists[sizeclass], block);
+    mainzone->freemask |= 1u << sizeclass;
+}
+
+static void RemoveFreeBlock (memblock_t* block)
+{
+    memblock_t*	head;
+    int		sizeclass;
+
+    sizeclass = SizeClass (block->size);
+    head = &mainzone->freelists[sizeclass];
+
+    UnlinkBlock (block);
+
+    if (head->listnext == head)
+	mainzone->freemask &= ~(1u << sizeclass);
+}
+
+//
+// FindFreeBlock
+// Returns a free block of at least size bytes, or NULL.
+//
+static memblock_t* FindFreeBlock (int size)
+{
+    memblock_t*	head;
+    memblock_t*	block;
+    unsigned int mask;
+    int		sizeclass;
+
+    // Every block in a class above that of size-1 is big enough.
+    sizeclass = SizeClass (size - 1) + 1;
+
+    if (sizeclass < NUMSIZECLASSES)
+    {
+	mask = mainzone->freemask & ~((1u << sizeclass) - 1);
+
+	if (mask != 0)
+	{
+	    sizeclass = 0;
+
+	    while (!(mask & 1))
+	    {
+		mask >>= 1;
+		sizeclass++;
+	    }
+
+	    return mainzone->freelists[sizeclass].listnext;
+	}
+    }
+
+    // Otherwise, a block in the class of size itself might still do.
+    head = &mainzone->freelists[SizeClass (size)];
+
+    for (block = head->listnext ; block != head ; block = block->listnext)
+    {
+	PROF_COUNT (prof_rover_steps, 1);
+
+	if (block->size >= size)
+	    return block;
+    }
+
+    return NULL;
+}
+
+
+
+//
+// Z_Init
+//
+void Z_Init (void)
+{
+    memblock_t*	block;
+    int		size;
+    int		i;
+
+    mainzone = (memzone_t *)I_ZoneBase (&size);
+    mainzone->size = size;
+
+    // set the entire zone to one free block
+    mainzone->blocklist.next =
+	mainzone->blocklist.prev =
+	block = (memblock_t *)( (byte *)mainzone + sizeof(memzone_t) );
+
+    mainzone->blocklist.user = (void *)mainzone;
+    mainzone->blocklist.tag = PU_STATIC;
+
+    for (i=0 ; i<NUMSIZECLASSES ; i++)
+	InitList (&mainzone->freelists[i]);
+
+    mainzone->freemask = 0;
+    InitList (&mainzone->purgelist);
+
+    block->prev = block->next = &mainzone->blocklist;
+
+    // free block
+    block->tag = PU_FREE;
+    block->user = NULL;
+    block->id = 0;
+
+    block->size = mainzone->size - sizeof(memzone_t);
+    AddFreeBlock (block);
+}
+
+
+//
+// Z_Free
+//
+void Z_Free (void* ptr)
+{
+    memblock_t*		block;
+    memblock_t*		other;
+
+    block = (memblock_t *) ( (byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+	I_Error ("Z_Free: freed a pointer without ZONEID");
+
+    if (block->tag != PU_FREE && block->user != NULL)
+    {
+    	// clear the user's mark
+	    *block->user = 0;
+    }
+
+    if (block->tag >= PU_PURGELEVEL)
+	UnlinkBlock (block);
+
+    // mark as free
+    block->tag = PU_FREE;
+    block->user = NULL;
+    block->id = 0;
+
+    other = block->prev;
+
+    if (other->tag == PU_FREE)
+    {
+        // merge with previous free block
+        RemoveFreeBlock (other);
+        other->size += block->size;
+        other->next = block->next;
+        other->next->prev = other;
+
+        block = other;
+    }
+
+    other = block->next;
+    if (other->tag == PU_FREE)
+    {
+        // merge the next free block onto the end
+        RemoveFreeBlock (other);
+        block->size += other->size;
+        block->next = other->next;
+        block->next->prev = block;
+    }
+
+    AddFreeBlock (block);
+}
+
+
+
+//
+// Z_SetPurgeHook
+// The hook is called by Z_Malloc before it throws out a purgable
+// block, for code that holds on to cached data for a while without
+// locking it, like the draw queue of the parallel renderer.
+//
+void Z_SetPurgeHook (void (*hook) (void))
+{
+    purgehook = hook;
+}
+
+
+//
+// Z_Malloc
+// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+//
+#define MINFRAGMENT		64
+
+
+void*
+Z_Malloc
+( int		size,
+  int		tag,
+  void*		user )
+{
+    int		extra;
+    memblock_t* block;
+    memblock_t* newblock;
+    memblock_t* purge;
+    void *result;
+
+    size = (size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1);
+
+    // account for size of block header
+    size += sizeof(memblock_t);
+
+    PROF_COUNT (prof_zmallocs, 1);
+
+    block = FindFreeBlock (size);
+
+    if (block == NULL && mainzone->purgelist.listnext != &mainzone->purgelist)
+    {
+        // let anyone still reading cached data finish first
+        if (purgehook != NULL)
+            purgehook ();
+
+        // throw out the least recently used purgable blocks until
+        // enough space has come free
+        while (block == NULL)
+        {
+            purge = mainzone->purgelist.listnext;
+
+            if (purge == &mainzone->purgelist)
+                break;
+
+            PROF_COUNT (prof_rover_steps, 1);
+            Z_Free ((byte *)purge+sizeof(memblock_t));
+            block = FindFreeBlock (size);
+        }
+    }
+
+    if (block == NULL)
+    {
+        I_Error ("Z_Malloc: failed on allocation of %i bytes", size);
+    }
+
+    RemoveFreeBlock (block);
+
+    // found a block big enough
+    extra = block->size - size;
+
+    if (extra >  MINFRAGMENT)
+    {
+        // there will be a free fragment after the allocated block
+        newblock = (memblock_t *) ((byte *)block + size );
+        newblock->size = extra;
+
+        newblock->tag = PU_FREE;
+        newblock->user = NULL;
+        newblock->id = 0;
+        newblock->prev = block;
+        newblock->next = block->next;
+        newblock->next->prev = newblock;
+
+        block->next = newblock;
+        block->size = size;
+
+        AddFreeBlock (newblock);
+    }
+
+	if (user == NULL && tag >= PU_PURGELEVEL)
+	    I_Error ("Z_Malloc: an owner is required for purgable blocks");
+
+    block->user = user;
+    block->tag = tag;
+
+    if (tag >= PU_PURGELEVEL)
+        LinkBlock (&mainzone->purgelist, block);
+
+    result  = (void *) ((byte *)block + sizeof(memblock_t));
+
+    if (block->user)
+    {
+        *block->user = result;
+    }
+
+    block->id = ZONEID;
+
+    return result;
+}
+
+
+
+//
+// Z_FreeTags
+//
+void
+Z_FreeTags
+( int		lowtag,
+  int		hightag )
+{
+    memblock_t*	block;
+    memblock_t*	prev;
+
+    for (block = mainzone->blocklist.next ;
+	 block != &mainzone->blocklist ;
+	 block = block->next)
+    {
+	// free block?
+	if (block->tag == PU_FREE)
+	    continue;
+
+	if (block->tag >= lowtag && block->tag <= hightag)
+	{
+	    // Freeing can merge the block with its neighbours, so
+	    // carry on from the free block that now covers it.
+	    prev = block->prev;
+	    Z_Free ( (byte *)block+sizeof(memblock_t));
+	    block = prev->tag == PU_FREE ? prev : prev->next;
+	}
+    }
+}
+
+
+
+//
+// Z_DumpHeap
+// Note: TFileDumpHeap( stdout ) ?
+//
+void
+Z_DumpHeap
+( int		lowtag,
+  int		hightag )
+{
+    memblock_t*	block;
+
+    printf ("zone size: %i  location: %p\n",
+	    mainzone->size,mainzone);
+
+    printf ("tag range: %i to %i\n",
+	    lowtag, hightag);
+
+    for (block = mainzone->blocklist.next ; ; block = block->next)
+    {
+	if (block->tag >= lowtag && block->tag <= hightag)
+	    printf ("block:%p    size:%7i    user:%p    tag:%3i\n",
+		    block, block->size, block->user, block->tag);
+
+	if (block->next == &mainzone->blocklist)
+	{
+	    // all blocks have been hit
+	    break;
+	}
+
+	if ( (byte *)block + block->size != (byte *)block->next)
+	    printf ("ERROR: block size does not touch the next block\n");
+
+	if ( block->next->prev != block)
+	    printf ("ERROR: next block doesn't have proper back link\n");
+
+	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
+	    printf ("ERROR: two consecutive free blocks\n");
+    }
+}
+
+
+//
+// Z_FileDumpHeap
+//
+void Z_FileDumpHeap (FILE* f)
+{
+    memblock_t*	block;
+
+    fprintf (f,"zone size: %i  location: %p\n",mainzone->size,mainzone);
+
+    for (block = mainzone->blocklist.next ; ; block = block->next)
+    {
+	fprintf (f,"block:%p    size:%7i    user:%p    tag:%3i\n",
+		 block, block->size, block->user, block->tag);
+
+	if (block->next == &mainzone->blocklist)
+	{
+	    // all blocks have been hit
+	    break;
+	}
+
+	if ( (byte *)block + block->size != (byte *)block->next)
+	    fprintf (f,"ERROR: block size does not touch the next block\n");
+
+	if ( block->next->prev != block)
+	    fprintf (f,"ERROR: next block doesn't have proper back link\n");
+
+	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
+	    fprintf (f,"ERROR: two consecutive free blocks\n");
+    }
+}
+
+
+
+//
+// Z_CheckHeap
+//
+void Z_CheckHeap (void)
+{
+    memblock_t*	block;
+    memblock_t*	head;
+    int		i;
+
+    for (block = mainzone->blocklist.next ; ; block = block->next)
+    {
+	if (block->next == &mainzone->blocklist)
+	{
+	    // all blocks have been hit
+	    break;
+	}
+
+	if ( (byte *)block + block->size != (byte *)block->next)
+	    I_Error ("Z_CheckHeap: block size does not touch the next block\n");
+
+	if ( block->next->prev != block)
+	    I_Error ("Z_CheckHeap: next block doesn't have proper back link\n");
+
+	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
+	    I_Error ("Z_CheckHeap: two consecutive free blocks\n");
+    }
+
+    for (i=0 ; i<NUMSIZECLASSES ; i++)
+    {
+	head = &mainzone->freelists[i];
+
+	for (block = head->listnext ; block != head ; block = block->listnext)
+	{
+	    if (block->tag != PU_FREE || SizeClass (block->size) != i)
+		I_Error ("Z_CheckHeap: bad block on free list %i\n", i);
+	}
+    }
+
+    head = &mainzone->purgelist;
+
+    for (block = head->listnext ; block != head ; block = block->listnext)
+    {
+	if (block->tag < PU_PURGELEVEL)
+	    I_Error ("Z_CheckHeap: unpurgable block on purge list\n");
+    }
+}
+
+
+
+
+//
+// Z_ChangeTag
+//
+void Z_ChangeTag2(void *ptr, int tag, char *file, int line)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+        I_Error("%s:%i: Z_ChangeTag: block without a ZONEID!",
+                file, line);
+
+    if (tag >= PU_PURGELEVEL && block->user == NULL)
+        I_Error("%s:%i: Z_ChangeTag: an owner is required "
+                "for purgable blocks", file, line);
+
+    if (block->tag >= PU_PURGELEVEL)
+        UnlinkBlock (block);
+
+    block->tag = tag;
+
+    // most recently used goes to the end of the purge list
+    if (tag >= PU_PURGELEVEL)
+        LinkBlock (&mainzone->purgelist, block);
+}
+
+void Z_ChangeUser(void *ptr, void **user)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+    {
+        I_Error("Z_ChangeUser: Tried to change user for invalid block!");
+    }
+
+    block->user = user;
+    *user = ptr;
+}
+
+
+
+//
+// Z_FreeMemory
+//
+int Z_FreeMemory (void)
+{
+    memblock_t*		block;
+    int			free;
+
+    free = 0;
+
+    for (block = mainzone->blocklist.next ;
+         block != &mainzone->blocklist;
+         block = block->next)
+    {
+        if (block->tag == PU_FREE || block->tag >= PU_PURGELEVEL)
+            free += block->size;
+    }
+
+    return free;
+}
+
+unsigned int Z_ZoneSize(void)
+{
+    return mainzone->size;
+}
+
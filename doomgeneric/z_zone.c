@@ -19,6 +19,7 @@
 
 #include "z_zone.h"
 #include "i_system.h"
+#include "m_prof.h"
 #include "doomtype.h"
 
 
@@ -61,7 +62,10 @@ typedef struct
 
 
 
-memzone_t*	mainzone;
+DG_STATE memzone_t*	mainzone;
+
+// Called before a purgable block is thrown out, see Z_SetPurgeHook.
+static DG_STATE void	(*purgehook) (void);
 
 
 
@@ -174,6 +178,18 @@ void Z_Free (void* ptr)
 
 
 
+//
+// Z_SetPurgeHook
+// The hook is called by Z_Malloc before it throws out a purgable
+// block, for code that holds on to cached data for a while without
+// locking it, like the draw queue of the parallel renderer.
+//
+void Z_SetPurgeHook (void (*hook) (void))
+{
+    purgehook = hook;
+}
+
+
 //
 // Z_Malloc
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
@@ -213,9 +229,13 @@ Z_Malloc
 	
     rover = base;
     start = base->prev;
+
+    PROF_COUNT (prof_zmallocs, 1);
 	
     do
     {
+        PROF_COUNT (prof_rover_steps, 1);
+
         if (rover == start)
         {
             // scanned all the way around the list
@@ -232,6 +252,10 @@ Z_Malloc
             }
             else
             {
+                // let anyone still reading cached data finish first
+                if (purgehook != NULL)
+                    purgehook ();
+
                 // free the rover block (adding the size to base)
 
                 // the rover can be the base block